@@ -0,0 +1,531 @@
+#ifndef HEAP_ADAPTIVEPRIORITYQUEUE_H
+#define HEAP_ADAPTIVEPRIORITYQUEUE_H
+
+
+#include "Vector.h"
+#include "NodeStorage.h"
+#include "Heap.h"
+#include "BinomialHeap.h"
+#include "FibonacciHeap.h"
+#include <cstdlib>
+#include <cmath>
+#include <stdexcept>
+
+
+// Priority queue which keeps its elements in one of Heap, FibonacciHeap and BinomialHeap
+// and moves them to another one when the recent mix of operations makes it cheaper.
+// Every element has an Entry, which stores its key and its pointer into the current engine,
+// Pointer refers to the Entry, so it stays valid when the elements are moved.
+// Entries are created by Storage (see NodeStorage.h), the engines keep their nodes with the default one.
+template <class Key, class Storage = NewDeleteStorage>
+class AdaptivePriorityQueue {
+private:
+    class Entry;
+    typedef typename Storage::template Pool<Entry> EntryPool;
+
+public:
+    enum EngineKind {
+        HEAP,
+        FIBONACCI,
+        BINOMIAL
+    };
+
+    // with SlotMapStorage it stays checkable when its element is removed: using it then throws invalid_argument
+    class Pointer {
+        friend AdaptivePriorityQueue<Key, Storage>;
+    private:
+        typename EntryPool::Handle handle;
+        explicit Pointer(Entry *ptr_);
+        Entry *entry() const;
+    public:
+        Pointer();
+        Key getKey();
+    };
+
+    AdaptivePriorityQueue();
+    ~AdaptivePriorityQueue();
+    AdaptivePriorityQueue(const AdaptivePriorityQueue&) = delete;
+    AdaptivePriorityQueue &operator=(const AdaptivePriorityQueue&) = delete;
+
+    bool is_empty() const;
+    size_t size() const;
+    Pointer insert(Key);
+    Key get_min() const;
+    Key extract_min();
+    void decrease(Pointer, Key);
+    void change(Pointer, Key);
+    void erase(Pointer);
+
+    EngineKind engine() const;
+    size_t migrations() const;
+    // moves all elements to the given engine now, adaptation goes on after that
+    void migrate(EngineKind);
+    // the mix of operations is checked every period operations, 0 turns adaptation off
+    void set_period(size_t period);
+    // the current engine, the entries and the array of live entries
+    MemoryUsage memory_usage() const;
+
+private:
+    // element as it is stored in the engines, minus_inf moves it to the top to be erased
+    class Item {
+    public:
+        Key key;
+        Entry *entry;
+        bool minus_inf;
+
+        Item();
+        Item(Key key_, Entry *entry_);
+
+        bool operator<(const Item &other) const;
+        bool operator>(const Item &other) const;
+    };
+
+    class Entry {
+        friend AdaptivePriorityQueue<Key, Storage>;
+    private:
+        Key key;
+        // place in live
+        size_t index;
+        typename Heap<Item>::Pointer heap_ptr;
+        typename FibonacciHeap<Item>::Pointer fibonacci_ptr;
+        typename BinomialHeap<Item>::Pointer binomial_ptr;
+    };
+
+    // operations since the last check
+    enum Operation {
+        INSERT,
+        DECREASE,
+        EXTRACT,
+        ERASE,
+        OPERATIONS
+    };
+
+    EngineKind kind;
+    // exactly one of them is not null
+    Heap<Item> *heap;
+    FibonacciHeap<Item> *fibonacci;
+    BinomialHeap<Item> *binomial;
+
+    Vector<Entry*> live;
+
+    size_t counts[OPERATIONS];
+    // indexed by EngineKind
+    double regret[3];
+    size_t period, since_check, migrations_count;
+
+    Entry *new_entry(Key);
+    void release_entry(Entry*);
+    void engine_insert(Entry*);
+    void engine_erase(Entry*);
+    void count(Operation);
+    double cost(EngineKind) const;
+    double build_cost(EngineKind) const;
+    void adapt();
+};
+
+
+
+template <class Key, class Storage>
+AdaptivePriorityQueue<Key, Storage>::Pointer::Pointer() {}
+
+
+template <class Key, class Storage>
+AdaptivePriorityQueue<Key, Storage>::Pointer::Pointer(Entry *ptr_) : handle(EntryPool::handle(ptr_)) {}
+
+
+template <class Key, class Storage>
+typename AdaptivePriorityQueue<Key, Storage>::Entry *AdaptivePriorityQueue<Key, Storage>::Pointer::entry() const {
+    Entry *ptr = EntryPool::get(handle);
+    if (ptr == nullptr) {
+        throw std::invalid_argument("Pointer to a removed element");
+    }
+    return ptr;
+}
+
+
+template <class Key, class Storage>
+Key AdaptivePriorityQueue<Key, Storage>::Pointer::getKey() {
+    return entry()->key;
+}
+
+
+
+template <class Key, class Storage>
+AdaptivePriorityQueue<Key, Storage>::AdaptivePriorityQueue() {
+    kind = HEAP;
+    heap = new Heap<Item>();
+    fibonacci = nullptr;
+    binomial = nullptr;
+    for (int i = 0; i < OPERATIONS; ++i) {
+        counts[i] = 0;
+    }
+    for (int i = 0; i < 3; ++i) {
+        regret[i] = 0;
+    }
+    period = 1024;
+    since_check = 0;
+    migrations_count = 0;
+}
+
+
+template <class Key, class Storage>
+AdaptivePriorityQueue<Key, Storage>::~AdaptivePriorityQueue() {
+    delete heap;
+    delete fibonacci;
+    delete binomial;
+    for (size_t i = 0; i < live.size(); ++i) {
+        EntryPool::destroy(live[i]);
+    }
+}
+
+
+template <class Key, class Storage>
+bool AdaptivePriorityQueue<Key, Storage>::is_empty() const {
+    return live.is_empty();
+}
+
+
+template <class Key, class Storage>
+size_t AdaptivePriorityQueue<Key, Storage>::size() const {
+    return live.size();
+}
+
+
+template <class Key, class Storage>
+typename AdaptivePriorityQueue<Key, Storage>::Pointer AdaptivePriorityQueue<Key, Storage>::insert(Key key) {
+    Entry *entry = new_entry(key);
+    engine_insert(entry);
+    count(INSERT);
+    return Pointer(entry);
+}
+
+
+template <class Key, class Storage>
+Key AdaptivePriorityQueue<Key, Storage>::get_min() const {
+    if (is_empty()) {
+        throw std::logic_error("AdaptivePriorityQueue instance is empty");
+    }
+    if (kind == HEAP) {
+        return heap->get_min().key;
+    }
+    else if (kind == FIBONACCI) {
+        return fibonacci->get_min().key;
+    }
+    return binomial->get_min().key;
+}
+
+
+template <class Key, class Storage>
+Key AdaptivePriorityQueue<Key, Storage>::extract_min() {
+    if (is_empty()) {
+        throw std::logic_error("AdaptivePriorityQueue instance is empty");
+    }
+    Item item;
+    if (kind == HEAP) {
+        item = heap->extract_min();
+    }
+    else if (kind == FIBONACCI) {
+        item = fibonacci->extract_min();
+    }
+    else {
+        item = binomial->extract_min();
+    }
+    release_entry(item.entry);
+    count(EXTRACT);
+    return item.key;
+}
+
+
+template <class Key, class Storage>
+void AdaptivePriorityQueue<Key, Storage>::decrease(Pointer ptr, Key key) {
+    Entry *entry = ptr.entry();
+    if (entry->key < key) {
+        throw std::invalid_argument("Decrease new value is bigger than current value");
+    }
+    entry->key = key;
+    if (kind == HEAP) {
+        heap->change(entry->heap_ptr, Item(key, entry));
+    }
+    else if (kind == FIBONACCI) {
+        fibonacci->decrease(entry->fibonacci_ptr, Item(key, entry));
+    }
+    else {
+        binomial->change(entry->binomial_ptr, Item(key, entry));
+    }
+    count(DECREASE);
+}
+
+
+template <class Key, class Storage>
+void AdaptivePriorityQueue<Key, Storage>::change(Pointer ptr, Key key) {
+    Entry *entry = ptr.entry();
+    if (!(entry->key < key)) {
+        decrease(ptr, key);
+        return;
+    }
+    entry->key = key;
+    if (kind == HEAP) {
+        heap->change(entry->heap_ptr, Item(key, entry));
+    }
+    else if (kind == FIBONACCI) {
+        // FibonacciHeap can only decrease, increase is erase and insert of the same entry
+        engine_erase(entry);
+        engine_insert(entry);
+    }
+    else {
+        binomial->change(entry->binomial_ptr, Item(key, entry));
+    }
+    count(ERASE);
+    count(INSERT);
+}
+
+
+template <class Key, class Storage>
+void AdaptivePriorityQueue<Key, Storage>::erase(Pointer ptr) {
+    Entry *entry = ptr.entry();
+    engine_erase(entry);
+    release_entry(entry);
+    count(ERASE);
+}
+
+
+template <class Key, class Storage>
+typename AdaptivePriorityQueue<Key, Storage>::EngineKind AdaptivePriorityQueue<Key, Storage>::engine() const {
+    return kind;
+}
+
+
+template <class Key, class Storage>
+size_t AdaptivePriorityQueue<Key, Storage>::migrations() const {
+    return migrations_count;
+}
+
+
+template <class Key, class Storage>
+MemoryUsage AdaptivePriorityQueue<Key, Storage>::memory_usage() const {
+    MemoryUsage usage = live.memory_usage();
+    if (heap != nullptr) {
+        usage.add_bytes(heap->memory_usage());
+    }
+    else if (fibonacci != nullptr) {
+        usage.add_bytes(fibonacci->memory_usage());
+    }
+    else {
+        usage.add_bytes(binomial->memory_usage());
+    }
+    usage.live_bytes += live.size() * EntryPool::slot_bytes();
+    usage.table_bytes += EntryPool::table_bytes();
+    return usage;
+}
+
+
+template <class Key, class Storage>
+void AdaptivePriorityQueue<Key, Storage>::migrate(EngineKind new_kind) {
+    if (new_kind == kind) {
+        return;
+    }
+    // every engine builds in linear time: Heap heapifies bottom-up,
+    // FibonacciHeap and BinomialHeap have O(1) amortized inserts
+    delete heap;
+    delete fibonacci;
+    delete binomial;
+    heap = nullptr;
+    fibonacci = nullptr;
+    binomial = nullptr;
+    kind = new_kind;
+
+    if (kind == HEAP) {
+        heap = new Heap<Item>();
+        Vector<Item> items(live.size());
+        for (size_t i = 0; i < live.size(); ++i) {
+            items[i] = Item(live[i]->key, live[i]);
+        }
+        Vector<typename Heap<Item>::Pointer> pointers;
+        if (!items.is_empty()) {
+            heap->insert_bulk(&items[0], &items[0] + items.size(), pointers);
+        }
+        for (size_t i = 0; i < live.size(); ++i) {
+            live[i]->heap_ptr = pointers[i];
+        }
+    }
+    else {
+        if (kind == FIBONACCI) {
+            fibonacci = new FibonacciHeap<Item>();
+        }
+        else {
+            binomial = new BinomialHeap<Item>();
+        }
+        for (size_t i = 0; i < live.size(); ++i) {
+            engine_insert(live[i]);
+        }
+    }
+    for (int i = 0; i < 3; ++i) {
+        regret[i] = 0;
+    }
+    ++migrations_count;
+}
+
+
+template <class Key, class Storage>
+void AdaptivePriorityQueue<Key, Storage>::set_period(size_t period_) {
+    period = period_;
+    since_check = 0;
+}
+
+
+
+template <class Key, class Storage>
+AdaptivePriorityQueue<Key, Storage>::Item::Item() {
+    entry = nullptr;
+    minus_inf = false;
+}
+
+
+template <class Key, class Storage>
+AdaptivePriorityQueue<Key, Storage>::Item::Item(Key key_, Entry *entry_) {
+    key = key_;
+    entry = entry_;
+    minus_inf = false;
+}
+
+
+template <class Key, class Storage>
+bool AdaptivePriorityQueue<Key, Storage>::Item::operator<(const Item &other) const {
+    if (minus_inf || other.minus_inf) {
+        return minus_inf && !other.minus_inf;
+    }
+    return key < other.key;
+}
+
+
+template <class Key, class Storage>
+bool AdaptivePriorityQueue<Key, Storage>::Item::operator>(const Item &other) const {
+    return other < *this;
+}
+
+
+template <class Key, class Storage>
+typename AdaptivePriorityQueue<Key, Storage>::Entry *AdaptivePriorityQueue<Key, Storage>::new_entry(Key key) {
+    Entry *entry = EntryPool::create();
+    entry->key = key;
+    entry->index = live.size();
+    live.push_back(entry);
+    return entry;
+}
+
+
+template <class Key, class Storage>
+void AdaptivePriorityQueue<Key, Storage>::release_entry(Entry *entry) {
+    Entry *last = live[live.size() - 1];
+    live[entry->index] = last;
+    last->index = entry->index;
+    live.pop_back();
+    EntryPool::destroy(entry);
+}
+
+
+template <class Key, class Storage>
+void AdaptivePriorityQueue<Key, Storage>::engine_insert(Entry *entry) {
+    Item item(entry->key, entry);
+    if (kind == HEAP) {
+        entry->heap_ptr = heap->insert(item);
+    }
+    else if (kind == FIBONACCI) {
+        entry->fibonacci_ptr = fibonacci->insert(item);
+    }
+    else {
+        entry->binomial_ptr = binomial->insert(item);
+    }
+}
+
+
+template <class Key, class Storage>
+void AdaptivePriorityQueue<Key, Storage>::engine_erase(Entry *entry) {
+    if (kind == HEAP) {
+        heap->erase(entry->heap_ptr);
+    }
+    else if (kind == FIBONACCI) {
+        // FibonacciHeap has no erase: the item goes to the top and is extracted
+        Item item(entry->key, entry);
+        item.minus_inf = true;
+        fibonacci->decrease(entry->fibonacci_ptr, item);
+        fibonacci->extract_min();
+    }
+    else {
+        binomial->erase(entry->binomial_ptr);
+    }
+}
+
+
+template <class Key, class Storage>
+void AdaptivePriorityQueue<Key, Storage>::count(Operation operation) {
+    ++counts[operation];
+    ++since_check;
+    if (period != 0 && since_check >= period) {
+        adapt();
+    }
+}
+
+
+template <class Key, class Storage>
+double AdaptivePriorityQueue<Key, Storage>::cost(EngineKind engine_kind) const {
+    // time of the operations counted since the last check, in units of about 70ns:
+    // fitted to the engines on 10^6 long long keys (one FibonacciHeap insert is 1),
+    // Heap decreases are cheap as nodes rarely go up far, FibonacciHeap extracts
+    // chase pointers through the whole root list
+    double lg = log2((double)live.size() + 2);
+    double inserts = counts[INSERT], decreases = counts[DECREASE];
+    double extracts = counts[EXTRACT], erases = counts[ERASE];
+    if (engine_kind == HEAP) {
+        return 2 * inserts + 0.4 * lg * decreases + 1.1 * lg * (extracts + erases);
+    }
+    else if (engine_kind == FIBONACCI) {
+        return inserts + 3 * decreases + 3 * lg * extracts + (3 + 3 * lg) * erases;
+    }
+    return 5 * inserts + 0.6 * lg * decreases + 2 * lg * (extracts + erases);
+}
+
+
+template <class Key, class Storage>
+double AdaptivePriorityQueue<Key, Storage>::build_cost(EngineKind engine_kind) const {
+    // a move is one insert per element, Heap heapifies in about the same time
+    if (engine_kind == HEAP) {
+        return 2.0 * live.size();
+    }
+    else if (engine_kind == FIBONACCI) {
+        return 1.0 * live.size();
+    }
+    return 5.0 * live.size();
+}
+
+
+template <class Key, class Storage>
+void AdaptivePriorityQueue<Key, Storage>::adapt() {
+    // regret of an engine is how much more the current one has cost since the last move
+    // (never below zero, so an old advantage doesn't hide a new one), the elements
+    // are moved once it is twice the cost of the move - like buying skis after renting them
+    // for twice their price, this is never far from the best decision made knowing the future
+    EngineKind kinds[3] = {HEAP, FIBONACCI, BINOMIAL};
+    double current = cost(kind);
+    int best = -1;
+    for (int i = 0; i < 3; ++i) {
+        if (kinds[i] == kind) {
+            continue;
+        }
+        regret[i] = max(0.0, regret[i] + current - cost(kinds[i]));
+        if (regret[i] > 2 * build_cost(kinds[i]) && (best == -1 || regret[i] > regret[best])) {
+            best = i;
+        }
+    }
+    if (best != -1) {
+        migrate(kinds[best]);
+    }
+
+    for (int i = 0; i < OPERATIONS; ++i) {
+        counts[i] = 0;
+    }
+    since_check = 0;
+}
+
+
+#endif //HEAP_ADAPTIVEPRIORITYQUEUE_H
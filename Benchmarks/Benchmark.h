@@ -0,0 +1,326 @@
+#ifndef HEAP_BENCHMARK_H
+#define HEAP_BENCHMARK_H
+
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cmath>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+// Small microbenchmark harness. A case is a function which prepares its data,
+// and brackets the measured part with start() and stop(operations). One repetition
+// calls the case until min_time of measured work is collected, its result is ns per operation;
+// the mean, standard deviation and minimum are taken over repetitions.
+class BenchmarkContext {
+public:
+    BenchmarkContext(size_t size, int arity, uint64_t seed);
+
+    size_t size() const;
+    int arity() const;
+    // deterministic for every case and repetition
+    std::mt19937_64 &random();
+
+    void start();
+    void stop(size_t operations);
+    // keeps a result alive, so the work producing it isn't optimized out
+    template <class T>
+    void use(const T &value);
+
+private:
+    friend class BenchmarkSuite;
+
+    size_t size_value;
+    int arity_value;
+    std::mt19937_64 generator;
+    std::chrono::steady_clock::time_point started;
+    double elapsed_ns;
+    size_t operations_count;
+};
+
+
+struct BenchmarkResult {
+    std::string name;
+    size_t size;
+    int arity;
+    int repetitions;
+    size_t operations;
+    double mean_ns, stddev_ns, min_ns;
+};
+
+
+class BenchmarkSuite {
+public:
+    typedef std::function<void(BenchmarkContext&)> Body;
+
+    // arity is only reported, 0 for engines without it
+    void add(const std::string &name, size_t size, int arity, Body body);
+
+    // options: --filter=substring --repetitions=N --min-time=seconds --max-size=N
+    //          --json=path --csv=path --compare=old.csv
+    // returns the exit code for main
+    int run_main(int argc, char **argv);
+
+private:
+    struct Case {
+        std::string name;
+        size_t size;
+        int arity;
+        Body body;
+    };
+
+    std::vector<Case> cases;
+
+    static BenchmarkResult measure(const Case&, int repetitions, double min_time);
+    static void write_json(const std::string &path, const std::vector<BenchmarkResult>&);
+    static void write_csv(const std::string &path, const std::vector<BenchmarkResult>&);
+    static void compare(const std::string &path, const std::vector<BenchmarkResult>&);
+    static std::string key_of(const std::string &name, size_t size);
+};
+
+
+
+inline BenchmarkContext::BenchmarkContext(size_t size, int arity, uint64_t seed) : generator(seed) {
+    size_value = size;
+    arity_value = arity;
+    elapsed_ns = 0;
+    operations_count = 0;
+}
+
+
+inline size_t BenchmarkContext::size() const {
+    return size_value;
+}
+
+
+inline int BenchmarkContext::arity() const {
+    return arity_value;
+}
+
+
+inline std::mt19937_64 &BenchmarkContext::random() {
+    return generator;
+}
+
+
+inline void BenchmarkContext::start() {
+    started = std::chrono::steady_clock::now();
+}
+
+
+inline void BenchmarkContext::stop(size_t operations) {
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - started;
+    elapsed_ns += elapsed.count();
+    operations_count += operations;
+}
+
+
+template <class T>
+void BenchmarkContext::use(const T &value) {
+    // an empty asm which may read the value: the compiler has to compute it
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+
+
+inline void BenchmarkSuite::add(const std::string &name, size_t size, int arity, Body body) {
+    Case c;
+    c.name = name;
+    c.size = size;
+    c.arity = arity;
+    c.body = body;
+    cases.push_back(c);
+}
+
+
+inline int BenchmarkSuite::run_main(int argc, char **argv) {
+    std::string filter, json, csv, baseline;
+    int repetitions = 5;
+    double min_time = 0.05;
+    size_t max_size = 1000000;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        std::string value = arg.find('=') == std::string::npos ? "" : arg.substr(arg.find('=') + 1);
+        if (arg.compare(0, 9, "--filter=") == 0) {
+            filter = value;
+        }
+        else if (arg.compare(0, 14, "--repetitions=") == 0) {
+            repetitions = atoi(value.c_str());
+        }
+        else if (arg.compare(0, 11, "--min-time=") == 0) {
+            min_time = atof(value.c_str());
+        }
+        else if (arg.compare(0, 11, "--max-size=") == 0) {
+            max_size = (size_t)atof(value.c_str());
+        }
+        else if (arg.compare(0, 7, "--json=") == 0) {
+            json = value;
+        }
+        else if (arg.compare(0, 6, "--csv=") == 0) {
+            csv = value;
+        }
+        else if (arg.compare(0, 10, "--compare=") == 0) {
+            baseline = value;
+        }
+        else {
+            fprintf(stderr, "usage: %s [--filter=substring] [--repetitions=N] [--min-time=seconds] "
+                            "[--max-size=N] [--json=path] [--csv=path] [--compare=old.csv]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (repetitions < 2) {
+        fprintf(stderr, "at least 2 repetitions are needed for the deviation\n");
+        return 2;
+    }
+
+    printf("%-50s %12s %8s %12s %12s %12s\n", "benchmark", "size", "arity", "ns/op", "stddev", "min");
+    std::vector<BenchmarkResult> results;
+    for (size_t i = 0; i < cases.size(); ++i) {
+        std::string full_name = cases[i].name + "/" + std::to_string(cases[i].size);
+        if (cases[i].size > max_size || full_name.find(filter) == std::string::npos) {
+            continue;
+        }
+        BenchmarkResult result = measure(cases[i], repetitions, min_time);
+        printf("%-50s %12zu %8d %12.2f %12.2f %12.2f\n", result.name.c_str(), result.size, result.arity,
+               result.mean_ns, result.stddev_ns, result.min_ns);
+        fflush(stdout);
+        results.push_back(result);
+    }
+    if (!json.empty()) {
+        write_json(json, results);
+    }
+    if (!csv.empty()) {
+        write_csv(csv, results);
+    }
+    if (!baseline.empty()) {
+        compare(baseline, results);
+    }
+    return 0;
+}
+
+
+inline BenchmarkResult BenchmarkSuite::measure(const Case &c, int repetitions, double min_time) {
+    BenchmarkResult result;
+    result.name = c.name;
+    result.size = c.size;
+    result.arity = c.arity;
+    result.repetitions = repetitions;
+    result.operations = 0;
+    std::vector<double> per_operation;
+    // the first round warms up caches and the allocator and is not counted
+    for (int r = -1; r < repetitions; ++r) {
+        BenchmarkContext context(c.size, c.arity, 2024 + (uint64_t)(r + 1));
+        do {
+            c.body(context);
+        } while (context.elapsed_ns < min_time * 1e9 && context.operations_count > 0);
+        if (r >= 0 && context.operations_count > 0) {
+            per_operation.push_back(context.elapsed_ns / context.operations_count);
+            result.operations += context.operations_count;
+        }
+    }
+    double sum = 0, min = per_operation.empty() ? 0 : per_operation[0];
+    for (size_t i = 0; i < per_operation.size(); ++i) {
+        sum += per_operation[i];
+        min = per_operation[i] < min ? per_operation[i] : min;
+    }
+    result.mean_ns = per_operation.empty() ? 0 : sum / per_operation.size();
+    double squares = 0;
+    for (size_t i = 0; i < per_operation.size(); ++i) {
+        squares += (per_operation[i] - result.mean_ns) * (per_operation[i] - result.mean_ns);
+    }
+    // sample deviation
+    result.stddev_ns = per_operation.size() < 2 ? 0 : sqrt(squares / (per_operation.size() - 1));
+    result.min_ns = min;
+    return result;
+}
+
+
+inline void BenchmarkSuite::write_json(const std::string &path, const std::vector<BenchmarkResult> &results) {
+    std::ofstream out(path.c_str());
+    out << "{\n  \"context\": {\"compiler\": \"" << __VERSION__ << "\", \"optimized\": "
+#ifdef __OPTIMIZE__
+        << "true"
+#else
+        << "false"
+#endif
+        << "},\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchmarkResult &r = results[i];
+        out << "    {\"name\": \"" << r.name << "\", \"size\": " << r.size << ", \"arity\": " << r.arity
+            << ", \"repetitions\": " << r.repetitions << ", \"operations\": " << r.operations
+            << ", \"ns_per_op\": " << r.mean_ns << ", \"stddev_ns\": " << r.stddev_ns
+            << ", \"min_ns\": " << r.min_ns << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+    if (!out) {
+        fprintf(stderr, "can't write %s\n", path.c_str());
+    }
+}
+
+
+inline void BenchmarkSuite::write_csv(const std::string &path, const std::vector<BenchmarkResult> &results) {
+    std::ofstream out(path.c_str());
+    out << "name,size,arity,repetitions,operations,ns_per_op,stddev_ns,min_ns\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchmarkResult &r = results[i];
+        out << r.name << "," << r.size << "," << r.arity << "," << r.repetitions << "," << r.operations << ","
+            << r.mean_ns << "," << r.stddev_ns << "," << r.min_ns << "\n";
+    }
+    if (!out) {
+        fprintf(stderr, "can't write %s\n", path.c_str());
+    }
+}
+
+
+inline void BenchmarkSuite::compare(const std::string &path, const std::vector<BenchmarkResult> &results) {
+    // reads a csv written by write_csv, names never contain commas
+    std::ifstream in(path.c_str());
+    if (!in) {
+        fprintf(stderr, "can't read %s\n", path.c_str());
+        return;
+    }
+    std::map<std::string, std::pair<double, double> > old;
+    std::string line;
+    std::getline(in, line);
+    while (std::getline(in, line)) {
+        std::vector<std::string> fields;
+        std::stringstream stream(line);
+        std::string field;
+        while (std::getline(stream, field, ',')) {
+            fields.push_back(field);
+        }
+        if (fields.size() == 8) {
+            old[key_of(fields[0], (size_t)atof(fields[1].c_str()))] =
+                    std::make_pair(atof(fields[5].c_str()), atof(fields[6].c_str()));
+        }
+    }
+    printf("\n%-50s %12s %12s %12s %9s\n", "benchmark", "size", "old ns/op", "new ns/op", "change");
+    for (size_t i = 0; i < results.size(); ++i) {
+        std::map<std::string, std::pair<double, double> >::iterator it = old.find(key_of(results[i].name,
+                                                                                         results[i].size));
+        if (it == old.end() || it->second.first <= 0) {
+            continue;
+        }
+        double change = (results[i].mean_ns / it->second.first - 1) * 100;
+        // a difference within both deviations is marked as noise
+        bool noise = fabs(results[i].mean_ns - it->second.first) <= results[i].stddev_ns + it->second.second;
+        printf("%-50s %12zu %12.2f %12.2f %+8.1f%%%s\n", results[i].name.c_str(), results[i].size,
+               it->second.first, results[i].mean_ns, change, noise ? " ~" : "");
+    }
+}
+
+
+inline std::string BenchmarkSuite::key_of(const std::string &name, size_t size) {
+    return name + "/" + std::to_string(size);
+}
+
+
+#endif //HEAP_BENCHMARK_H
@@ -0,0 +1,70 @@
+#ifndef HEAP_COUNTINGALLOCATOR_H
+#define HEAP_COUNTINGALLOCATOR_H
+
+
+#include <cstdlib>
+#include <new>
+#include <malloc.h>
+
+
+// Replaces global operator new and delete, so all memory of the process goes through them
+// and the bytes in use are known at any moment, with malloc's rounding of every block.
+// Defines the operators, so only the main file of a program may include it.
+struct AllocationCounter {
+    static size_t &allocated_bytes();
+    // the most allocated_bytes since the last reset_peak
+    static size_t &peak_bytes();
+    static void reset_peak();
+};
+
+
+
+inline size_t &AllocationCounter::allocated_bytes() {
+    static size_t bytes = 0;
+    return bytes;
+}
+
+
+inline size_t &AllocationCounter::peak_bytes() {
+    static size_t bytes = 0;
+    return bytes;
+}
+
+
+inline void AllocationCounter::reset_peak() {
+    peak_bytes() = allocated_bytes();
+}
+
+
+void *operator new(size_t size) {
+    void *ptr = malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    AllocationCounter::allocated_bytes() += malloc_usable_size(ptr);
+    if (AllocationCounter::allocated_bytes() > AllocationCounter::peak_bytes()) {
+        AllocationCounter::peak_bytes() = AllocationCounter::allocated_bytes();
+    }
+    return ptr;
+}
+
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+
+void operator delete(void *ptr) noexcept {
+    if (ptr != nullptr) {
+        AllocationCounter::allocated_bytes() -= malloc_usable_size(ptr);
+        free(ptr);
+    }
+}
+
+
+void operator delete[](void *ptr) noexcept {
+    operator delete(ptr);
+}
+
+
+#endif //HEAP_COUNTINGALLOCATOR_H
@@ -0,0 +1,146 @@
+#ifndef HEAP_GRAPHALGORITHMS_H
+#define HEAP_GRAPHALGORITHMS_H
+
+
+#include "Graphs.h"
+#include "../PriorityQueue.h"
+#include <cstdlib>
+#include <cstdint>
+#include <vector>
+
+
+// queue key of the algorithms: a vertex with its distance (Dijkstra) or
+// the weight of its lightest edge to the tree (Prim), comparisons are counted
+struct VertexKey {
+    long long distance;
+    uint32_t vertex;
+
+    VertexKey();
+    VertexKey(long long distance_, uint32_t vertex_);
+    bool operator<(const VertexKey &other) const;
+
+    static unsigned long long &comparisons();
+};
+
+
+// what one run did with its queue
+struct QueueCounts {
+    unsigned long long inserts, decreases, extracts;
+    QueueCounts();
+};
+
+
+// returns the sum of distances of reachable vertices from source
+template <class Engine>
+unsigned long long dijkstra(const Graph &graph, uint32_t source, QueueCounts &counts);
+// returns the weight of a minimum spanning forest, every component is grown from its first vertex
+template <class Engine>
+unsigned long long prim(const Graph &graph, QueueCounts &counts);
+
+
+
+inline VertexKey::VertexKey() : distance(0), vertex(0) {}
+
+
+inline VertexKey::VertexKey(long long distance_, uint32_t vertex_) : distance(distance_), vertex(vertex_) {}
+
+
+inline bool VertexKey::operator<(const VertexKey &other) const {
+    ++comparisons();
+    return distance < other.distance || (distance == other.distance && vertex < other.vertex);
+}
+
+
+inline unsigned long long &VertexKey::comparisons() {
+    static unsigned long long count = 0;
+    return count;
+}
+
+
+inline QueueCounts::QueueCounts() : inserts(0), decreases(0), extracts(0) {}
+
+
+
+template <class Engine>
+unsigned long long dijkstra(const Graph &graph, uint32_t source, QueueCounts &counts) {
+    typedef PriorityQueue<VertexKey, Engine> Queue;
+    // -1 for vertices which were never reached
+    std::vector<long long> tentative(graph.n, -1);
+    std::vector<bool> done(graph.n, false);
+    std::vector<typename Queue::Handle> handles(graph.n);
+    Queue queue;
+    unsigned long long sum = 0;
+    handles[source] = queue.insert(VertexKey(0, source));
+    tentative[source] = 0;
+    ++counts.inserts;
+    while (!queue.is_empty()) {
+        VertexKey top = queue.extract_min();
+        ++counts.extracts;
+        done[top.vertex] = true;
+        sum += top.distance;
+        for (size_t e = graph.first[top.vertex]; e < graph.first[top.vertex + 1]; ++e) {
+            uint32_t u = graph.to[e];
+            long long d = top.distance + graph.weight[e];
+            if (done[u]) {
+                continue;
+            }
+            if (tentative[u] == -1) {
+                handles[u] = queue.insert(VertexKey(d, u));
+                tentative[u] = d;
+                ++counts.inserts;
+            }
+            else if (d < tentative[u]) {
+                queue.decrease(handles[u], VertexKey(d, u));
+                tentative[u] = d;
+                ++counts.decreases;
+            }
+        }
+    }
+    return sum;
+}
+
+
+template <class Engine>
+unsigned long long prim(const Graph &graph, QueueCounts &counts) {
+    typedef PriorityQueue<VertexKey, Engine> Queue;
+    std::vector<long long> lightest(graph.n, -1);
+    std::vector<bool> in_tree(graph.n, false);
+    std::vector<typename Queue::Handle> handles(graph.n);
+    unsigned long long total = 0;
+    for (uint32_t root = 0; root < graph.n; ++root) {
+        if (in_tree[root]) {
+            continue;
+        }
+        Queue queue;
+        handles[root] = queue.insert(VertexKey(0, root));
+        lightest[root] = 0;
+        ++counts.inserts;
+        while (!queue.is_empty()) {
+            VertexKey top = queue.extract_min();
+            ++counts.extracts;
+            in_tree[top.vertex] = true;
+            total += top.distance;
+            for (size_t e = graph.first[top.vertex]; e < graph.first[top.vertex + 1]; ++e) {
+                uint32_t u = graph.to[e];
+                long long w = graph.weight[e];
+                if (in_tree[u]) {
+                    continue;
+                }
+                if (lightest[u] == -1) {
+                    handles[u] = queue.insert(VertexKey(w, u));
+                    lightest[u] = w;
+                    ++counts.inserts;
+                }
+                else if (w < lightest[u]) {
+                    queue.decrease(handles[u], VertexKey(w, u));
+                    lightest[u] = w;
+                    ++counts.decreases;
+                }
+            }
+        }
+    }
+    return total;
+}
+
+
+#endif //HEAP_GRAPHALGORITHMS_H
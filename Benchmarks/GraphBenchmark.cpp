@@ -0,0 +1,144 @@
+// Shortest paths and spanning trees on synthetic graphs with every heap engine.
+// Usage: graph_benchmark [vertices = 262144] [seed = 1]
+// Every run is made in a child process, so the peak memory of one engine
+// is not hidden by memory which another engine already allocated and freed.
+
+#include "Graphs.h"
+#include "GraphAlgorithms.h"
+#include "CountingAllocator.h"
+#include "../Heap.h"
+#include "../BinomialHeap.h"
+#include "../FibonacciHeap.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <sys/wait.h>
+
+
+struct RunResult {
+    double milliseconds;
+    unsigned long long comparisons;
+    QueueCounts counts;
+    // bytes allocated by the algorithm with its queue above what the process had before
+    size_t peak_bytes;
+    unsigned long long checksum;
+};
+
+
+template <class Engine>
+RunResult run(const Graph &graph, bool shortest_paths) {
+    RunResult result;
+    VertexKey::comparisons() = 0;
+    size_t before = AllocationCounter::allocated_bytes();
+    AllocationCounter::reset_peak();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    if (shortest_paths) {
+        result.checksum = dijkstra<Engine>(graph, 0, result.counts);
+    }
+    else {
+        result.checksum = prim<Engine>(graph, result.counts);
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    result.milliseconds = elapsed.count();
+    result.comparisons = VertexKey::comparisons();
+    result.peak_bytes = AllocationCounter::peak_bytes() - before;
+    return result;
+}
+
+
+// runs in a child process and passes the result back through a pipe
+template <class Engine>
+bool run_isolated(const Graph &graph, bool shortest_paths, RunResult &result) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        perror("pipe");
+        return false;
+    }
+    pid_t child = fork();
+    if (child < 0) {
+        perror("fork");
+        return false;
+    }
+    if (child == 0) {
+        close(fds[0]);
+        RunResult own = run<Engine>(graph, shortest_paths);
+        bool written = write(fds[1], &own, sizeof(own)) == (ssize_t)sizeof(own);
+        _exit(written ? 0 : 1);
+    }
+    close(fds[1]);
+    bool received = read(fds[0], &result, sizeof(result)) == (ssize_t)sizeof(result);
+    close(fds[0]);
+    int status;
+    waitpid(child, &status, 0);
+    return received && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+
+// prints one line per engine, returns false if the engines disagree or a run failed
+bool compare_engines(const Graph &graph, bool shortest_paths) {
+    typedef std::pair<const char*, bool (*)(const Graph&, bool, RunResult&)> Engine;
+    std::vector<Engine> engines;
+    engines.push_back(Engine("Heap", &run_isolated<Heap<VertexKey> >));
+    engines.push_back(Engine("BinomialHeap", &run_isolated<BinomialHeap<VertexKey> >));
+    engines.push_back(Engine("FibonacciHeap", &run_isolated<FibonacciHeap<VertexKey> >));
+    bool ok = true;
+    unsigned long long checksum = 0;
+    for (size_t i = 0; i < engines.size(); ++i) {
+        RunResult result;
+        if (!engines[i].second(graph, shortest_paths, result)) {
+            fprintf(stderr, "%s failed on %s\n", engines[i].first, graph.name.c_str());
+            ok = false;
+            continue;
+        }
+        printf("%-10s %-9s %-14s %10.1f %14llu %10llu %10llu %10llu %10zu\n", graph.name.c_str(),
+               shortest_paths ? "dijkstra" : "prim", engines[i].first, result.milliseconds, result.comparisons,
+               result.counts.inserts, result.counts.decreases, result.counts.extracts, result.peak_bytes / 1024);
+        if (i == 0) {
+            checksum = result.checksum;
+        }
+        else if (result.checksum != checksum) {
+            fprintf(stderr, "%s gives another result on %s\n", engines[i].first, graph.name.c_str());
+            ok = false;
+        }
+    }
+    fflush(stdout);
+    return ok;
+}
+
+
+int main(int argc, char **argv) {
+    uint32_t vertices = argc > 1 ? (uint32_t)strtoul(argv[1], nullptr, 10) : 1u << 18;
+    uint64_t seed = argc > 2 ? strtoull(argv[2], nullptr, 10) : 1;
+    if (vertices < 16) {
+        fprintf(stderr, "usage: %s [vertices >= 16] [seed]\n", argv[0]);
+        return 2;
+    }
+    uint32_t side = (uint32_t)sqrt((double)vertices);
+
+    printf("%-10s %-9s %-14s %10s %14s %10s %10s %10s %10s\n", "graph", "algorithm", "engine", "time ms",
+           "comparisons", "inserts", "decreases", "extracts", "peak KiB");
+    bool ok = true;
+    for (int kind = 0; kind < 4; ++kind) {
+        // graphs are built one at a time, children share the memory of the current one
+        Graph graph;
+        if (kind == 0) {
+            grid_graph(graph, side, side, seed);
+        }
+        else if (kind == 1) {
+            geometric_graph(graph, vertices, 8, seed);
+        }
+        else if (kind == 2) {
+            power_law_graph(graph, vertices, 4, seed);
+        }
+        else {
+            road_graph(graph, side, side, seed);
+        }
+        ok = compare_engines(graph, true) && ok;
+        ok = compare_engines(graph, false) && ok;
+    }
+    return ok ? 0 : 1;
+}
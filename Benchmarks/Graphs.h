@@ -0,0 +1,220 @@
+#ifndef HEAP_GRAPHS_H
+#define HEAP_GRAPHS_H
+
+
+#include <cstdlib>
+#include <cstdint>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+
+// Undirected weighted graph in compressed form: edges of vertex v are
+// first[v] .. first[v + 1] - 1 in to and weight, every edge is stored in both directions.
+struct Graph {
+    std::string name;
+    uint32_t n;
+    std::vector<size_t> first;
+    std::vector<uint32_t> to;
+    std::vector<long long> weight;
+
+    size_t edges() const;
+};
+
+
+// collects edges and builds a Graph from them
+class GraphBuilder {
+public:
+    explicit GraphBuilder(uint32_t n);
+    void add_edge(uint32_t a, uint32_t b, long long weight);
+    void build(Graph &graph, const std::string &name);
+
+private:
+    uint32_t n;
+    std::vector<uint32_t> from_list, to_list;
+    std::vector<long long> weight_list;
+};
+
+
+// width * height lattice with 4 neighbours and uniform weights from [1, 100]
+inline void grid_graph(Graph &graph, uint32_t width, uint32_t height, uint64_t seed);
+// n random points of a square, joined when they are closer than the radius which gives
+// about degree neighbours per point, weights are the distances
+inline void geometric_graph(Graph &graph, uint32_t n, double degree, uint64_t seed);
+// preferential attachment (Barabasi, Albert): every new vertex joins edges_per_vertex
+// vertices picked with probability proportional to their degree, so degrees follow a power law
+inline void power_law_graph(Graph &graph, uint32_t n, uint32_t edges_per_vertex, uint64_t seed);
+// jittered lattice with some streets missing, a few diagonals and faster highways
+// on every 32nd row and column: low degree, large diameter, weights follow geometry
+inline void road_graph(Graph &graph, uint32_t width, uint32_t height, uint64_t seed);
+
+
+
+inline size_t Graph::edges() const {
+    return to.size() / 2;
+}
+
+
+
+inline GraphBuilder::GraphBuilder(uint32_t n_) {
+    n = n_;
+}
+
+
+inline void GraphBuilder::add_edge(uint32_t a, uint32_t b, long long weight) {
+    from_list.push_back(a);
+    to_list.push_back(b);
+    weight_list.push_back(weight);
+}
+
+
+inline void GraphBuilder::build(Graph &graph, const std::string &name) {
+    graph.name = name;
+    graph.n = n;
+    graph.first.assign(n + 1, 0);
+    for (size_t i = 0; i < from_list.size(); ++i) {
+        ++graph.first[from_list[i] + 1];
+        ++graph.first[to_list[i] + 1];
+    }
+    for (uint32_t v = 0; v < n; ++v) {
+        graph.first[v + 1] += graph.first[v];
+    }
+    graph.to.assign(2 * from_list.size(), 0);
+    graph.weight.assign(2 * from_list.size(), 0);
+    std::vector<size_t> fill(graph.first.begin(), graph.first.end() - 1);
+    for (size_t i = 0; i < from_list.size(); ++i) {
+        graph.to[fill[from_list[i]]] = to_list[i];
+        graph.weight[fill[from_list[i]]++] = weight_list[i];
+        graph.to[fill[to_list[i]]] = from_list[i];
+        graph.weight[fill[to_list[i]]++] = weight_list[i];
+    }
+}
+
+
+
+inline void grid_graph(Graph &graph, uint32_t width, uint32_t height, uint64_t seed) {
+    std::mt19937_64 random(seed);
+    std::uniform_int_distribution<long long> weights(1, 100);
+    GraphBuilder builder(width * height);
+    for (uint32_t y = 0; y < height; ++y) {
+        for (uint32_t x = 0; x < width; ++x) {
+            uint32_t v = y * width + x;
+            if (x + 1 < width) {
+                builder.add_edge(v, v + 1, weights(random));
+            }
+            if (y + 1 < height) {
+                builder.add_edge(v, v + width, weights(random));
+            }
+        }
+    }
+    builder.build(graph, "grid");
+}
+
+
+inline void geometric_graph(Graph &graph, uint32_t n, double degree, uint64_t seed) {
+    std::mt19937_64 random(seed);
+    const double side = 1e6;
+    std::uniform_real_distribution<double> coordinate(0, side);
+    std::vector<double> xs(n), ys(n);
+    for (uint32_t v = 0; v < n; ++v) {
+        xs[v] = coordinate(random);
+        ys[v] = coordinate(random);
+    }
+    // n * pi * r^2 / side^2 points fall into the circle around a point
+    double radius = sqrt(degree * side * side / (M_PI * n));
+    // points are sorted into square cells of the radius, so only neighbouring cells are checked
+    uint32_t cells = (uint32_t)(side / radius) + 1;
+    std::vector<std::vector<uint32_t> > cell_points((size_t)cells * cells);
+    for (uint32_t v = 0; v < n; ++v) {
+        cell_points[(size_t)(ys[v] / radius) * cells + (size_t)(xs[v] / radius)].push_back(v);
+    }
+    GraphBuilder builder(n);
+    for (uint32_t v = 0; v < n; ++v) {
+        long long cx = (long long)(xs[v] / radius), cy = (long long)(ys[v] / radius);
+        for (long long y = cy - 1; y <= cy + 1; ++y) {
+            for (long long x = cx - 1; x <= cx + 1; ++x) {
+                if (x < 0 || y < 0 || x >= cells || y >= cells) {
+                    continue;
+                }
+                const std::vector<uint32_t> &points = cell_points[(size_t)y * cells + (size_t)x];
+                for (size_t i = 0; i < points.size(); ++i) {
+                    uint32_t u = points[i];
+                    double distance = hypot(xs[u] - xs[v], ys[u] - ys[v]);
+                    // every pair once
+                    if (v < u && distance < radius) {
+                        builder.add_edge(v, u, (long long)distance + 1);
+                    }
+                }
+            }
+        }
+    }
+    builder.build(graph, "geometric");
+}
+
+
+inline void power_law_graph(Graph &graph, uint32_t n, uint32_t edges_per_vertex, uint64_t seed) {
+    std::mt19937_64 random(seed);
+    std::uniform_int_distribution<long long> weights(1, 1000);
+    GraphBuilder builder(n);
+    // every vertex is in ends once per edge, so a uniform pick from ends is a pick by degree
+    std::vector<uint32_t> ends;
+    uint32_t start = edges_per_vertex + 1 < n ? edges_per_vertex + 1 : n;
+    for (uint32_t v = 0; v < start; ++v) {
+        for (uint32_t u = v + 1; u < start; ++u) {
+            builder.add_edge(v, u, weights(random));
+            ends.push_back(v);
+            ends.push_back(u);
+        }
+    }
+    for (uint32_t v = start; v < n; ++v) {
+        for (uint32_t i = 0; i < edges_per_vertex; ++i) {
+            uint32_t u = ends[std::uniform_int_distribution<size_t>(0, ends.size() - 1)(random)];
+            builder.add_edge(v, u, weights(random));
+            ends.push_back(u);
+        }
+        for (uint32_t i = 0; i < edges_per_vertex; ++i) {
+            ends.push_back(v);
+        }
+    }
+    builder.build(graph, "power-law");
+}
+
+
+inline void road_graph(Graph &graph, uint32_t width, uint32_t height, uint64_t seed) {
+    std::mt19937_64 random(seed);
+    std::uniform_real_distribution<double> unit(0, 1);
+    const double step = 100;
+    std::vector<double> xs(width * height), ys(width * height);
+    for (uint32_t y = 0; y < height; ++y) {
+        for (uint32_t x = 0; x < width; ++x) {
+            xs[y * width + x] = (x + 0.8 * unit(random) - 0.4) * step;
+            ys[y * width + x] = (y + 0.8 * unit(random) - 0.4) * step;
+        }
+    }
+    GraphBuilder builder(width * height);
+    // travel time: distance over speed, highways are 4 times faster
+    auto add_road = [&](uint32_t a, uint32_t b, bool highway) {
+        double distance = hypot(xs[a] - xs[b], ys[a] - ys[b]);
+        builder.add_edge(a, b, (long long)(distance / (highway ? 4 : 1)) + 1);
+    };
+    for (uint32_t y = 0; y < height; ++y) {
+        for (uint32_t x = 0; x < width; ++x) {
+            uint32_t v = y * width + x;
+            bool highway_row = y % 32 == 0, highway_column = x % 32 == 0;
+            if (x + 1 < width && (highway_row || unit(random) < 0.8)) {
+                add_road(v, v + 1, highway_row);
+            }
+            if (y + 1 < height && (highway_column || unit(random) < 0.8)) {
+                add_road(v, v + width, highway_column);
+            }
+            if (x + 1 < width && y + 1 < height && unit(random) < 0.05) {
+                add_road(v, v + width + 1, false);
+            }
+        }
+    }
+    builder.build(graph, "road");
+}
+
+
+#endif //HEAP_GRAPHS_H
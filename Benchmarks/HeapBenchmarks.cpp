@@ -0,0 +1,190 @@
+// Time of every heap operation by engine, arity, key type and size.
+// Usage: benchmarks [--filter=substring] [--repetitions=N] [--min-time=seconds]
+//                   [--max-size=N] [--json=path] [--csv=path] [--compare=old.csv]
+// Sizes go from 10^3 to 10^8, only up to --max-size (10^6 by default) are run.
+
+#include "Benchmark.h"
+#include "../Heap.h"
+#include "../BinomialHeap.h"
+#include "../FibonacciHeap.h"
+#include "../PriorityQueue.h"
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+// 32 bytes: a key with a payload which moves together with it
+struct WideKey {
+    uint64_t value;
+    char payload[24];
+
+    bool operator<(const WideKey &other) const {
+        return value < other.value;
+    }
+};
+
+
+// keys of all types are made from integers, and keep their order
+template <class Key>
+Key make_key(uint64_t value) {
+    return (Key)value;
+}
+
+
+template <>
+WideKey make_key<WideKey>(uint64_t value) {
+    WideKey key;
+    key.value = value;
+    for (size_t i = 0; i < sizeof(key.payload); ++i) {
+        key.payload[i] = (char)i;
+    }
+    return key;
+}
+
+
+template <class Key>
+uint64_t value_of(const Key &key) {
+    return (uint64_t)key;
+}
+
+
+template <>
+uint64_t value_of<WideKey>(const WideKey &key) {
+    return key.value;
+}
+
+
+// values fit into int, so every key type gets the same sequences
+static uint64_t random_value(BenchmarkContext &context) {
+    return context.random()() % ((uint64_t)1 << 30) + ((uint64_t)1 << 30);
+}
+
+
+// Engine is constructed from the arity when it has one
+template <class Key, class Engine>
+struct Queue {
+    typedef PriorityQueue<Key, Engine> Type;
+
+    static Type *create(int arity) {
+        return create(arity, std::is_constructible<Engine, int>());
+    }
+
+    static Type *create(int arity, std::true_type) {
+        return new Type(arity);
+    }
+
+    static Type *create(int, std::false_type) {
+        return new Type();
+    }
+};
+
+
+template <class Key, class Engine>
+void insert_case(BenchmarkContext &context) {
+    std::vector<Key> keys(context.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        keys[i] = make_key<Key>(random_value(context));
+    }
+    typename Queue<Key, Engine>::Type *queue = Queue<Key, Engine>::create(context.arity());
+    context.start();
+    for (size_t i = 0; i < keys.size(); ++i) {
+        queue->insert(keys[i]);
+    }
+    context.stop(keys.size());
+    delete queue;
+}
+
+
+template <class Key, class Engine>
+void extract_min_case(BenchmarkContext &context) {
+    typename Queue<Key, Engine>::Type *queue = Queue<Key, Engine>::create(context.arity());
+    for (size_t i = 0; i < context.size(); ++i) {
+        queue->insert(make_key<Key>(random_value(context)));
+    }
+    context.start();
+    for (size_t i = 0; i < context.size(); ++i) {
+        Key key = queue->extract_min();
+        context.use(key);
+    }
+    context.stop(context.size());
+    delete queue;
+}
+
+
+template <class Key, class Engine>
+void decrease_case(BenchmarkContext &context) {
+    // every element is decreased once, in random order, by a random amount
+    typedef typename Queue<Key, Engine>::Type Type;
+    Type *queue = Queue<Key, Engine>::create(context.arity());
+    std::vector<typename Type::Handle> handles(context.size());
+    std::vector<uint64_t> values(context.size());
+    for (size_t i = 0; i < context.size(); ++i) {
+        values[i] = random_value(context);
+        handles[i] = queue->insert(make_key<Key>(values[i]));
+    }
+    std::vector<size_t> order(context.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+        std::swap(order[i], order[context.random()() % (i + 1)]);
+        values[i] -= context.random()() % values[i];
+    }
+    context.start();
+    for (size_t i = 0; i < order.size(); ++i) {
+        queue->decrease(handles[order[i]], make_key<Key>(values[order[i]]));
+    }
+    context.stop(order.size());
+    delete queue;
+}
+
+
+template <class Key, class Engine>
+void hold_case(BenchmarkContext &context) {
+    // classic hold model: the size stays the same, the minimum comes back a bit later
+    typename Queue<Key, Engine>::Type *queue = Queue<Key, Engine>::create(context.arity());
+    for (size_t i = 0; i < context.size(); ++i) {
+        queue->insert(make_key<Key>(random_value(context)));
+    }
+    std::vector<uint64_t> increments(context.size());
+    for (size_t i = 0; i < increments.size(); ++i) {
+        increments[i] = context.random()() % ((uint64_t)1 << 20);
+    }
+    context.start();
+    for (size_t i = 0; i < increments.size(); ++i) {
+        Key key = queue->extract_min();
+        queue->insert(make_key<Key>(value_of(key) + increments[i]));
+    }
+    context.stop(increments.size());
+    delete queue;
+}
+
+
+template <class Key, class Engine>
+void add_engine(BenchmarkSuite &suite, const std::string &name, int arity) {
+    for (size_t size = 1000; size <= 100000000; size *= 10) {
+        suite.add(name + "/insert", size, arity, &insert_case<Key, Engine>);
+        suite.add(name + "/extract_min", size, arity, &extract_min_case<Key, Engine>);
+        suite.add(name + "/decrease", size, arity, &decrease_case<Key, Engine>);
+        suite.add(name + "/hold", size, arity, &hold_case<Key, Engine>);
+    }
+}
+
+
+template <class Key>
+void add_key_type(BenchmarkSuite &suite, const std::string &key_name) {
+    for (int arity = 2; arity <= 8; arity *= 2) {
+        add_engine<Key, Heap<Key> >(suite, "Heap<" + key_name + ">/arity=" + std::to_string(arity), arity);
+    }
+    add_engine<Key, BinomialHeap<Key> >(suite, "BinomialHeap<" + key_name + ">", 0);
+    add_engine<Key, FibonacciHeap<Key> >(suite, "FibonacciHeap<" + key_name + ">", 0);
+}
+
+
+int main(int argc, char **argv) {
+    BenchmarkSuite suite;
+    add_key_type<int>(suite, "int");
+    add_key_type<uint64_t>(suite, "uint64");
+    add_key_type<WideKey>(suite, "wide32");
+    return suite.run_main(argc, argv);
+}
@@ -0,0 +1,169 @@
+// Bytes per element of every engine filled with random keys, as memory_usage() reports it
+// and as the allocator sees it.
+// Usage: memory_benchmark [max elements = 1000000] [seed = 1]
+// Sizes go by factors of 10 from 1000. Every engine is filled in a child process, so SlotMap
+// tables which earlier runs grew are not counted for free; the allocator's figure includes
+// them with their unused slots, and malloc's rounding of every block. The table column is the
+// whole process-wide SlotMap table of the engines with SlotMapStorage (see NodeStorage.h):
+// a process keeps it at its peak after the heaps are gone. The other engines have none.
+
+#include "CountingAllocator.h"
+#include "../Heap.h"
+#include "../BinomialHeap.h"
+#include "../FibonacciHeap.h"
+#include "../HollowHeap.h"
+#include "../WeakHeap.h"
+#include "../MinMaxHeap.h"
+#include "../BucketQueue.h"
+#include "../IndexedHeap.h"
+#include "../AdaptivePriorityQueue.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include <unistd.h>
+#include <sys/wait.h>
+
+
+typedef int64_t Key;
+
+
+struct MemoryResult {
+    MemoryUsage usage;
+    size_t allocated_bytes;
+};
+
+
+// engines with parameters get them from the size, all keys are in [0, n)
+template <class Engine>
+Engine *create(size_t) {
+    return new Engine();
+}
+
+
+template <>
+BucketQueue<Key> *create<BucketQueue<Key> >(size_t n) {
+    return new BucketQueue<Key>(n);
+}
+
+
+template <>
+CalendarQueue<Key> *create<CalendarQueue<Key> >(size_t n) {
+    return new CalendarQueue<Key>(n);
+}
+
+
+template <>
+IndexedHeap<Key> *create<IndexedHeap<Key> >(size_t n) {
+    return new IndexedHeap<Key>((uint32_t)n);
+}
+
+
+template <class Engine>
+void insert(Engine &engine, size_t, Key key) {
+    engine.insert(key);
+}
+
+
+void insert(IndexedHeap<Key> &engine, size_t i, Key key) {
+    engine.push((uint32_t)i, key);
+}
+
+
+void insert(CalendarQueue<Key> &engine, size_t i, Key key) {
+    // the window starts at the first key, so it has to be the smallest
+    engine.insert(i == 0 ? 0 : key);
+}
+
+
+template <class Engine>
+MemoryResult fill(size_t n, uint64_t seed) {
+    std::mt19937_64 random(seed);
+    std::vector<Key> keys(n);
+    for (size_t i = 0; i < n; ++i) {
+        keys[i] = (Key)(random() % n);
+    }
+    size_t before = AllocationCounter::allocated_bytes();
+    Engine *engine = create<Engine>(n);
+    for (size_t i = 0; i < n; ++i) {
+        insert(*engine, i, keys[i]);
+    }
+    MemoryResult result;
+    result.usage = engine->memory_usage();
+    result.allocated_bytes = AllocationCounter::allocated_bytes() - before;
+    // the process ends right after, the engine is not deleted
+    return result;
+}
+
+
+// runs in a child process and passes the result back through a pipe
+template <class Engine>
+bool fill_isolated(size_t n, uint64_t seed, MemoryResult &result) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        perror("pipe");
+        return false;
+    }
+    pid_t child = fork();
+    if (child < 0) {
+        perror("fork");
+        return false;
+    }
+    if (child == 0) {
+        close(fds[0]);
+        MemoryResult own = fill<Engine>(n, seed);
+        bool written = write(fds[1], &own, sizeof(own)) == (ssize_t)sizeof(own);
+        _exit(written ? 0 : 1);
+    }
+    close(fds[1]);
+    bool received = read(fds[0], &result, sizeof(result)) == (ssize_t)sizeof(result);
+    close(fds[0]);
+    int status;
+    waitpid(child, &status, 0);
+    return received && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+
+int main(int argc, char **argv) {
+    size_t max_elements = argc > 1 ? (size_t)strtoull(argv[1], nullptr, 10) : 1000000;
+    uint64_t seed = argc > 2 ? strtoull(argv[2], nullptr, 10) : 1;
+    if (max_elements < 1000 || max_elements > UINT32_MAX) {
+        fprintf(stderr, "usage: %s [max elements from 1000 to 2^32 - 1] [seed]\n", argv[0]);
+        return 2;
+    }
+
+    typedef std::pair<const char*, bool (*)(size_t, uint64_t, MemoryResult&)> Engine;
+    std::vector<Engine> engines;
+    engines.push_back(Engine("Heap", &fill_isolated<Heap<Key> >));
+    engines.push_back(Engine("Heap/SlotMap",
+                             &fill_isolated<Heap<Key, LevelOrderLayout, BranchingSift, SlotMapStorage> >));
+    engines.push_back(Engine("BinomialHeap", &fill_isolated<BinomialHeap<Key> >));
+    engines.push_back(Engine("FibonacciHeap", &fill_isolated<FibonacciHeap<Key> >));
+    engines.push_back(Engine("HollowHeap", &fill_isolated<HollowHeap<Key> >));
+    engines.push_back(Engine("WeakHeap", &fill_isolated<WeakHeap<Key> >));
+    engines.push_back(Engine("MinMaxHeap", &fill_isolated<MinMaxHeap<Key> >));
+    engines.push_back(Engine("BucketQueue", &fill_isolated<BucketQueue<Key> >));
+    engines.push_back(Engine("CalendarQueue", &fill_isolated<CalendarQueue<Key> >));
+    engines.push_back(Engine("IndexedHeap", &fill_isolated<IndexedHeap<Key> >));
+    engines.push_back(Engine("Adaptive", &fill_isolated<AdaptivePriorityQueue<Key> >));
+
+    printf("%-14s %12s %14s %10s %12s %16s\n", "engine", "elements", "bytes/element", "slack %", "table/elem",
+           "allocated/elem");
+    bool ok = true;
+    for (size_t n = 1000; n <= max_elements; n *= 10) {
+        for (size_t i = 0; i < engines.size(); ++i) {
+            MemoryResult result;
+            if (!engines[i].second(n, seed, result)) {
+                fprintf(stderr, "%s failed with %zu elements\n", engines[i].first, n);
+                ok = false;
+                continue;
+            }
+            printf("%-14s %12zu %14.1f %10.1f %12.1f %16.1f\n", engines[i].first, n,
+                   result.usage.bytes_per_element(), 100.0 * result.usage.slack_bytes / result.usage.live_bytes,
+                   (double)result.usage.table_bytes / n, (double)result.allocated_bytes / n);
+            fflush(stdout);
+        }
+    }
+    return ok ? 0 : 1;
+}
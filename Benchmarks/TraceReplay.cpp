@@ -0,0 +1,319 @@
+// Replays a trace of priority queue operations (see OperationTrace.h) with every heap engine
+// and prints latency percentiles of every operation kind.
+// Usage: trace_replay trace                                  replays a trace with 4 or 8 byte integer keys
+//        trace_replay --generate=path [operations] [seed]    writes a synthetic trace of
+//                                                            inserts, extractions and decreases
+// Every operation is timed separately, so latencies include about 20 ns of clock reading.
+// Engines which lack an operation used in the trace are skipped, and extracted keys are
+// checked against the trace: a run which differs from the recorded one makes the exit code 1.
+// Engines may break ties between equal keys differently, then later operations on the handles
+// of tied elements go astray; recorded keys should be unique, as in the generated traces.
+
+#include "../OperationTrace.h"
+#include "../Heap.h"
+#include "../BinomialHeap.h"
+#include "../FibonacciHeap.h"
+#include "../HollowHeap.h"
+#include "../WeakHeap.h"
+#include "../MinMaxHeap.h"
+#include "../AdaptivePriorityQueue.h"
+#include "../PriorityQueue.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+
+static const char *const OPERATION_NAMES[TRACE_OPERATIONS] = {
+        "insert", "extract_min", "change", "decrease", "erase", "merge"
+};
+
+
+struct ReplayResult {
+    // the engine can't do an operation of the trace
+    bool skipped;
+    // extracted keys were the recorded ones and nothing threw
+    bool matches;
+    double total_ms;
+    std::vector<uint32_t> latencies[TRACE_OPERATIONS];
+};
+
+
+// operations which have no counterpart in the engine are never called,
+// they compile to nothing
+template <class Queue>
+void erase(Queue &queue, typename Queue::Handle handle, std::true_type) {
+    queue.erase(handle);
+}
+
+
+template <class Queue>
+void erase(Queue&, typename Queue::Handle, std::false_type) {}
+
+
+template <class Queue, class Key>
+void change(Queue &queue, typename Queue::Handle handle, Key key, std::true_type) {
+    queue.change(handle, key);
+}
+
+
+template <class Queue, class Key>
+void change(Queue&, typename Queue::Handle, Key, std::false_type) {}
+
+
+template <class Queue, class Key>
+void decrease(Queue &queue, typename Queue::Handle handle, Key key, std::true_type) {
+    queue.decrease(handle, key);
+}
+
+
+template <class Queue, class Key>
+void decrease(Queue&, typename Queue::Handle, Key, std::false_type) {}
+
+
+template <class Queue>
+void merge(Queue &queue, Queue &other, std::true_type) {
+    queue.merge(other);
+}
+
+
+template <class Queue>
+void merge(Queue&, Queue&, std::false_type) {}
+
+
+template <class Key, class Engine>
+struct Replay {
+    typedef PriorityQueue<Key, Engine> Queue;
+
+    static Queue *create(int arity) {
+        return create(arity, std::is_constructible<Engine, int>());
+    }
+
+    static Queue *create(int arity, std::true_type) {
+        return new Queue(arity);
+    }
+
+    static Queue *create(int, std::false_type) {
+        return new Queue();
+    }
+
+    static bool supports(int operation) {
+        switch (operation) {
+            case TRACE_CHANGE:
+                return Queue::has_change;
+            case TRACE_DECREASE:
+                return Queue::has_decrease;
+            case TRACE_ERASE:
+                return Queue::has_erase;
+            case TRACE_MERGE:
+                return Queue::has_meld;
+            default:
+                return true;
+        }
+    }
+
+    static ReplayResult run(const TraceReader<Key> &trace, const bool used[TRACE_OPERATIONS], int arity) {
+        ReplayResult result;
+        result.skipped = false;
+        result.matches = true;
+        result.total_ms = 0;
+        for (int operation = 0; operation < TRACE_OPERATIONS; ++operation) {
+            if (used[operation] && !supports(operation)) {
+                result.skipped = true;
+                return result;
+            }
+        }
+        std::vector<Queue*> queues;
+        for (uint32_t i = 0; i < trace.queues(); ++i) {
+            queues.push_back(create(arity));
+        }
+        std::vector<typename Queue::Handle> handles(trace.handles());
+        uint64_t next_handle = 0;
+        try {
+            for (size_t i = 0; i < trace.size(); ++i) {
+                TraceRecord<Key> record = trace[i];
+                Queue &queue = *queues[record.queue];
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                Key extracted = Key();
+                switch (record.operation) {
+                    case TRACE_INSERT:
+                        handles[next_handle++] = queue.insert(record.key);
+                        break;
+                    case TRACE_EXTRACT_MIN:
+                        extracted = queue.extract_min();
+                        break;
+                    case TRACE_CHANGE:
+                        change(queue, handles[record.handle], record.key,
+                               std::integral_constant<bool, Queue::has_change>());
+                        break;
+                    case TRACE_DECREASE:
+                        decrease(queue, handles[record.handle], record.key,
+                                 std::integral_constant<bool, Queue::has_decrease>());
+                        break;
+                    case TRACE_ERASE:
+                        erase(queue, handles[record.handle], std::integral_constant<bool, Queue::has_erase>());
+                        break;
+                    case TRACE_MERGE:
+                        merge(queue, *queues[record.handle], std::integral_constant<bool, Queue::has_meld>());
+                        break;
+                }
+                std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+                result.latencies[record.operation].push_back((uint32_t)std::min(elapsed.count(), 4e9));
+                result.total_ms += elapsed.count() / 1e6;
+                if (record.operation == TRACE_EXTRACT_MIN && (extracted < record.key || record.key < extracted)) {
+                    result.matches = false;
+                    break;
+                }
+            }
+        }
+        catch (const std::exception &e) {
+            fprintf(stderr, "%s\n", e.what());
+            result.matches = false;
+        }
+        for (size_t i = 0; i < queues.size(); ++i) {
+            delete queues[i];
+        }
+        return result;
+    }
+};
+
+
+static double percentile(const std::vector<uint32_t> &sorted, double fraction) {
+    return sorted[std::min(sorted.size() - 1, (size_t)(fraction * sorted.size()))];
+}
+
+
+// prints one line per operation kind, returns false if the run differs from the trace
+static bool report(const char *engine, ReplayResult &result) {
+    if (result.skipped) {
+        printf("%-16s skipped: lacks an operation of the trace\n", engine);
+        return true;
+    }
+    if (!result.matches) {
+        fprintf(stderr, "%s doesn't reproduce the trace\n", engine);
+        return false;
+    }
+    for (int operation = 0; operation < TRACE_OPERATIONS; ++operation) {
+        std::vector<uint32_t> &latencies = result.latencies[operation];
+        if (latencies.empty()) {
+            continue;
+        }
+        std::sort(latencies.begin(), latencies.end());
+        printf("%-16s %-12s %12zu %10.0f %10.0f %10.0f %10.0f %12u %10.1f\n", engine, OPERATION_NAMES[operation],
+               latencies.size(), percentile(latencies, 0.5), percentile(latencies, 0.9),
+               percentile(latencies, 0.99), percentile(latencies, 0.999), latencies.back(), result.total_ms);
+    }
+    fflush(stdout);
+    return true;
+}
+
+
+template <class Key>
+int replay_all(const std::string &path) {
+    TraceReader<Key> trace(path);
+    bool used[TRACE_OPERATIONS] = {false};
+    for (size_t i = 0; i < trace.size(); ++i) {
+        used[trace[i].operation] = true;
+    }
+    printf("%zu operations in %u queues\n", trace.size(), trace.queues());
+    printf("%-16s %-12s %12s %10s %10s %10s %10s %12s %10s\n", "engine", "operation", "count",
+           "p50 ns", "p90 ns", "p99 ns", "p99.9 ns", "max ns", "total ms");
+    bool ok = true;
+    ReplayResult result;
+    result = Replay<Key, Heap<Key> >::run(trace, used, 2);
+    ok = report("Heap/arity=2", result) && ok;
+    result = Replay<Key, Heap<Key> >::run(trace, used, 4);
+    ok = report("Heap/arity=4", result) && ok;
+    result = Replay<Key, BinomialHeap<Key> >::run(trace, used, 0);
+    ok = report("BinomialHeap", result) && ok;
+    result = Replay<Key, FibonacciHeap<Key> >::run(trace, used, 0);
+    ok = report("FibonacciHeap", result) && ok;
+    result = Replay<Key, HollowHeap<Key> >::run(trace, used, 0);
+    ok = report("HollowHeap", result) && ok;
+    result = Replay<Key, WeakHeap<Key> >::run(trace, used, 0);
+    ok = report("WeakHeap", result) && ok;
+    result = Replay<Key, MinMaxHeap<Key> >::run(trace, used, 0);
+    ok = report("MinMaxHeap", result) && ok;
+    result = Replay<Key, AdaptivePriorityQueue<Key> >::run(trace, used, 0);
+    ok = report("Adaptive", result) && ok;
+    return ok ? 0 : 1;
+}
+
+
+// event simulation: events are taken in time order, new ones are scheduled a bit later,
+// and some scheduled ones are moved earlier; keys are times with the event number
+// in the low bits, so no two keys are equal
+static void generate(const std::string &path, size_t operations, uint64_t seed) {
+    typedef RecordingQueue<int64_t, BinomialHeap<int64_t, SlotMapStorage> > Queue;
+    const int EVENT_BITS = 24;
+    TraceWriter<int64_t> writer(path);
+    Queue queue(writer);
+    std::vector<Queue::Handle> scheduled;
+    std::mt19937_64 random(seed);
+    int64_t now = 0, events = 0;
+    for (size_t i = 0; i < operations; ++i) {
+        uint64_t choice = random() % 100;
+        if (choice < 40 || queue.is_empty()) {
+            int64_t time = now + (int64_t)(random() % 1000000);
+            int64_t event = events++ % ((int64_t)1 << EVENT_BITS);
+            scheduled.push_back(queue.insert(time << EVENT_BITS | event));
+        }
+        else if (choice < 75) {
+            now = queue.extract_min() >> EVENT_BITS;
+        }
+        else if (!scheduled.empty()) {
+            size_t j = random() % scheduled.size();
+            try {
+                int64_t key = scheduled[j].getKey();
+                int64_t time = key >> EVENT_BITS, event = key & (((int64_t)1 << EVENT_BITS) - 1);
+                queue.decrease(scheduled[j], (now + (time - now) / 2) << EVENT_BITS | event);
+            }
+            catch (const std::invalid_argument&) {
+                // the event has already happened
+                scheduled[j] = scheduled.back();
+                scheduled.pop_back();
+            }
+        }
+    }
+    writer.close();
+}
+
+
+int main(int argc, char **argv) {
+    if (argc >= 2 && std::string(argv[1]).compare(0, 11, "--generate=") == 0) {
+        size_t operations = argc > 2 ? (size_t)strtoull(argv[2], nullptr, 10) : 1000000;
+        uint64_t seed = argc > 3 ? strtoull(argv[3], nullptr, 10) : 1;
+        generate(std::string(argv[1]).substr(11), operations, seed);
+        return 0;
+    }
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s trace\n       %s --generate=path [operations] [seed]\n", argv[0], argv[0]);
+        return 2;
+    }
+    try {
+        // the key type is only known from the header
+        MappedFile file(argv[1]);
+        SnapshotHeader header;
+        if (file.size() < sizeof(header)) {
+            throw std::runtime_error("not a trace");
+        }
+        memcpy(&header, file.data(), sizeof(header));
+        if (header.key_size == 4) {
+            return replay_all<int32_t>(argv[1]);
+        }
+        if (header.key_size == 8) {
+            return replay_all<int64_t>(argv[1]);
+        }
+        throw std::runtime_error("keys of " + std::to_string(header.key_size) + " bytes are not supported");
+    }
+    catch (const std::exception &e) {
+        fprintf(stderr, "%s\n", e.what());
+        return 2;
+    }
+}
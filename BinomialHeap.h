@@ -3,60 +3,106 @@
 
 
 #include "Vector.h"
+#include "MappedFile.h"
+#include "NodeStorage.h"
+#include "HeapStats.h"
+#include <string>
+#include <type_traits>
+#include <utility>
 
 
-template <class Key>
+template <class Key, class Storage = NewDeleteStorage>
 class BinomialHeap {
 private:
     class Node;
+    typedef typename Storage::template Pool<Node> NodePool;
     class LayerNode;
 
 public:
+    // with SlotMapStorage it stays checkable when its element is removed: using it then throws invalid_argument
     class Pointer {
-        friend BinomialHeap<Key>;
+        friend BinomialHeap<Key, Storage>;
     private:
-        Node *ptr;
+        typename NodePool::Handle handle;
         explicit Pointer(Node *ptr_);
+        Node *node() const;
     public:
         Pointer();
-        Key getKey();
+        const Key &getKey();
     };
 
+    BinomialHeap();
+    ~BinomialHeap();
+    BinomialHeap(const BinomialHeap&) = delete;
+    BinomialHeap &operator=(const BinomialHeap&) = delete;
+
     bool is_empty() const;
-    Pointer insert(Key);
-    Key get_min() const;
+    Pointer insert(const Key&);
+    Pointer insert(Key&&);
+    // constructs the key in its node from the arguments
+    template <class... Args>
+    Pointer emplace(Args&&... args);
+    const Key &get_min() const;
+    // the key is moved out of its node
     Key extract_min();
     void merge(BinomialHeap &otherHeap);
     void erase(Pointer ptr);
     void change(Pointer, Key);
+    // writes nodes in preorder with indices of their parents, Key must be trivially copyable
+    void save(const std::string &path) const;
+    // replaces the content with a snapshot written by save, builds new nodes,
+    // trees keep their shape; a corrupted file throws runtime_error and changes nothing
+    void load(const std::string &path);
+    // counters of the operations since construction or reset_stats,
+    // all zeros unless compiled with HEAP_STATS, see HeapStats.h
+    HeapStats stats() const;
+    void reset_stats();
+    // nodes with their LayerNodes and the roots array
+    MemoryUsage memory_usage() const;
 
 private:
     class Node {
-        friend BinomialHeap<Key>;
+        friend BinomialHeap<Key, Storage>;
     public:
         Node *first_child, *next_brother, *prev_brother;
         LayerNode *brother_layer_node, *child_layer_node;
         size_t order;
         Key key;
 
-        explicit Node(Key);
+        template <class... Args>
+        explicit Node(Args&&... args);
+        ~Node();
     };
 
     // LayerNode instance stores parent for all nodes with the same parent
     // Each node has a LayerNode for its children (even if there is no children yet)
     class LayerNode {
-        friend BinomialHeap<Key>;
+        friend BinomialHeap<Key, Storage>;
         friend Node;
     private:
         Node *parent;
         explicit LayerNode(Node*);
     };
 
+    // relocatable form of a node in snapshots
+    struct SnapshotRecord {
+        Key key;
+        // index of the parent record, which is always earlier, or the index of the record itself for roots
+        uint64_t parent;
+    };
+
     Vector<Node*> roots;
     Node *min_node;
+#ifdef HEAP_STATS
+    HeapStats counters;
+#endif
 
     Node *get_parent(Node*);
+    void delete_tree(Node*);
+    void save_tree(SnapshotWriter&, Node*, uint64_t parent, uint64_t &next_index) const;
     void swap_with_parent(Node*);
+    void detach(Node*);
+    void insert_node(Node*);
     Node *merge_binomial_trees(Node *a, Node *b);
     void attach(Node *root, Node *child);
     void add_nodes(Vector<Node*>&, Vector<Node*>&);
@@ -65,33 +111,55 @@ private:
 
 
 
-template <class Key>
-BinomialHeap<Key>::Pointer::Pointer() {
-    ptr = nullptr;
+template <class Key, class Storage>
+BinomialHeap<Key, Storage>::Pointer::Pointer() {}
+
+
+template <class Key, class Storage>
+BinomialHeap<Key, Storage>::Pointer::Pointer(Node *ptr_) : handle(NodePool::handle(ptr_)) {}
+
+
+template <class Key, class Storage>
+typename BinomialHeap<Key, Storage>::Node *BinomialHeap<Key, Storage>::Pointer::node() const {
+    Node *ptr = NodePool::get(handle);
+    if (ptr == nullptr) {
+        throw std::invalid_argument("Pointer to a removed element");
+    }
+    return ptr;
 }
 
 
-template <class Key>
-BinomialHeap<Key>::Pointer::Pointer(Node *ptr_) {
-    ptr = ptr_;
+template <class Key, class Storage>
+const Key &BinomialHeap<Key, Storage>::Pointer::getKey() {
+    return node()->key;
 }
 
 
-template <class Key>
-Key BinomialHeap<Key>::Pointer::getKey() {
-    return ptr->key;
+
+template <class Key, class Storage>
+BinomialHeap<Key, Storage>::BinomialHeap() {
+    min_node = nullptr;
 }
 
 
+template <class Key, class Storage>
+BinomialHeap<Key, Storage>::~BinomialHeap() {
+    for (size_t i = 0; i < roots.size(); ++i) {
+        if (roots[i] != nullptr) {
+            delete_tree(roots[i]);
+        }
+    }
+}
 
-template <class Key>
-bool BinomialHeap<Key>::is_empty() const {
+
+template <class Key, class Storage>
+bool BinomialHeap<Key, Storage>::is_empty() const {
     return roots.is_empty();
 }
 
 
-template <class Key>
-Key BinomialHeap<Key>::get_min() const {
+template <class Key, class Storage>
+const Key &BinomialHeap<Key, Storage>::get_min() const {
     if (is_empty()) {
         throw std::logic_error("BinomialHeap instance is empty");
     }
@@ -99,107 +167,245 @@ Key BinomialHeap<Key>::get_min() const {
 }
 
 
-template <class Key>
-void BinomialHeap<Key>::merge(BinomialHeap &otherHeap) {
+template <class Key, class Storage>
+void BinomialHeap<Key, Storage>::merge(BinomialHeap &otherHeap) {
     add_nodes(roots, otherHeap.roots);
     otherHeap.roots.clear();
     update_min_node_and_roots();
 }
 
 
-template <class Key>
-typename BinomialHeap<Key>::Pointer BinomialHeap<Key>::insert(Key key) {
-    Node *cur_tree = new Node(key);
-    Node *ptr_to_element = cur_tree;
-    size_t i = 0;
-    while (i < roots.size() && roots[i] != nullptr) {
-        cur_tree = merge_binomial_trees(cur_tree, roots[i]);
-        roots[i] = nullptr;
-        ++i;
-    }
-    if (i == roots.size()) {
-        roots.push_back(cur_tree);
-    }
-    else {
-        roots[i] = cur_tree;
-    }
+template <class Key, class Storage>
+typename BinomialHeap<Key, Storage>::Pointer BinomialHeap<Key, Storage>::insert(const Key &key) {
+    return emplace(key);
+}
+
+
+template <class Key, class Storage>
+typename BinomialHeap<Key, Storage>::Pointer BinomialHeap<Key, Storage>::insert(Key &&key) {
+    return emplace(std::move(key));
+}
 
-    update_min_node_and_roots();
 
+template <class Key, class Storage>
+template <class... Args>
+typename BinomialHeap<Key, Storage>::Pointer BinomialHeap<Key, Storage>::emplace(Args&&... args) {
+    Node *ptr_to_element = NodePool::create(std::forward<Args>(args)...);
+    HEAP_STAT(++counters.allocations);
+    insert_node(ptr_to_element);
     return Pointer(ptr_to_element);
 }
 
 
-template <class Key>
-void BinomialHeap<Key>::erase(Pointer ptr) {
+template <class Key, class Storage>
+void BinomialHeap<Key, Storage>::erase(Pointer ptr) {
     if (is_empty()) {
         throw std::logic_error("BinomialHeap instance is empty");
     }
+    Node *node = ptr.node();
+    detach(node);
+    NodePool::destroy(node);
+}
 
-    Node *cur = ptr.ptr;
-    while (get_parent(cur) != nullptr) {
-        swap_with_parent(cur);
+
+template <class Key, class Storage>
+Key BinomialHeap<Key, Storage>::extract_min() {
+    if (is_empty()) {
+        throw std::logic_error("BinomialHeap instance is empty");
     }
+    // the node is already out of the roots when the key is moved from it
+    Node *node = min_node;
+    detach(node);
+    Key res = std::move(node->key);
+    NodePool::destroy(node);
+    return res;
+}
 
-    Vector<Node*> children;
-    Node *cur_child = cur->first_child;
-    while (cur_child != nullptr) {
-        children.push_back(cur_child);
-        cur_child = cur_child->next_brother;
+
+template <class Key, class Storage>
+void BinomialHeap<Key, Storage>::change(Pointer ptr, Key key) {
+    // the node itself is moved, so pointers to it stay valid
+    Node *node = ptr.node();
+    HEAP_STAT(++counters.comparisons);
+    if (key < node->key) {
+        node->key = std::move(key);
+        while (get_parent(node) != nullptr && (HEAP_STAT(++counters.comparisons),
+                                               node->key < get_parent(node)->key)) {
+            swap_with_parent(node);
+            HEAP_STAT(counters.sift_step());
+        }
+        HEAP_STAT(counters.sift_done());
+        if (get_parent(node) == nullptr) {
+            roots[node->order] = node;
+        }
+        update_min_node_and_roots();
     }
-    for (int i = 0; i < children.size(); ++i) {
-        children[i]->brother_layer_node = nullptr;
-        children[i]->prev_brother = nullptr;
-        children[i]->next_brother = nullptr;
+    else {
+        detach(node);
+        node->key = std::move(key);
+        insert_node(node);
     }
-    children.reverse();
+}
 
-    roots[cur->order] = nullptr;
-    delete cur;
 
-    add_nodes(roots, children);
 
-    update_min_node_and_roots();
+template <class Key, class Storage>
+void BinomialHeap<Key, Storage>::save(const std::string &path) const {
+    static_assert(std::is_trivially_copyable<Key>::value, "snapshots store raw bytes of keys");
+    uint64_t count = 0;
+    for (size_t i = 0; i < roots.size(); ++i) {
+        if (roots[i] != nullptr) {
+            count += (uint64_t)1 << roots[i]->order;
+        }
+    }
+    SnapshotWriter writer(path, "BINOSNP1", sizeof(Key), 0, count);
+    uint64_t next_index = 0;
+    for (size_t i = 0; i < roots.size(); ++i) {
+        if (roots[i] != nullptr) {
+            save_tree(writer, roots[i], next_index, next_index);
+        }
+    }
+    writer.close();
 }
 
 
-template <class Key>
-Key BinomialHeap<Key>::extract_min() {
-    if (is_empty()) {
-        throw std::logic_error("BinomialHeap instance is empty");
+template <class Key, class Storage>
+void BinomialHeap<Key, Storage>::load(const std::string &path) {
+    static_assert(std::is_trivially_copyable<Key>::value, "snapshots store raw bytes of keys");
+    MappedFile file(path);
+    SnapshotHeader header;
+    const char *records = snapshot_records(file, "BINOSNP1", sizeof(Key), sizeof(SnapshotRecord), header);
+
+    // the trees are built aside and replace the content only if they are binomial heaps;
+    // children are appended in the saved order, so the last one is kept for every node
+    Vector<Node*> nodes, last_child, new_roots;
+    bool valid = true;
+    for (uint64_t i = 0; i < header.count; ++i) {
+        SnapshotRecord record;
+        memcpy(&record, records + i * sizeof(SnapshotRecord), sizeof(SnapshotRecord));
+        if (record.parent > i || (record.parent < i && record.key < nodes[record.parent]->key)) {
+            valid = false;
+            break;
+        }
+        Node *node = NodePool::create(record.key);
+        HEAP_STAT(++counters.allocations);
+        nodes.push_back(node);
+        last_child.push_back(nullptr);
+        if (record.parent == i) {
+            continue;
+        }
+        Node *parent = nodes[record.parent];
+        if (last_child[record.parent] == nullptr) {
+            parent->first_child = node;
+        }
+        else {
+            last_child[record.parent]->next_brother = node;
+            node->prev_brother = last_child[record.parent];
+        }
+        last_child[record.parent] = node;
+        node->brother_layer_node = parent->child_layer_node;
+        ++parent->order;
     }
-    Key res = min_node->key;
-    erase(Pointer(min_node));
-    return res;
+    // children of a node of order k have orders k - 1, ..., 0 in this order, as attach makes them,
+    // and there is at most one root of every order
+    for (size_t i = 0; i < nodes.size() && valid; ++i) {
+        size_t expected = nodes[i]->order;
+        for (Node *child = nodes[i]->first_child; child != nullptr; child = child->next_brother) {
+            if (child->order + 1 != expected) {
+                valid = false;
+                break;
+            }
+            --expected;
+        }
+        if (nodes[i]->brother_layer_node == nullptr) {
+            while (new_roots.size() <= nodes[i]->order) {
+                new_roots.push_back(nullptr);
+            }
+            if (new_roots[nodes[i]->order] != nullptr) {
+                valid = false;
+            }
+            new_roots[nodes[i]->order] = nodes[i];
+        }
+    }
+    if (!valid) {
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            NodePool::destroy(nodes[i]);
+        }
+        throw std::runtime_error("snapshot is corrupted");
+    }
+
+    for (size_t i = 0; i < roots.size(); ++i) {
+        if (roots[i] != nullptr) {
+            delete_tree(roots[i]);
+        }
+    }
+    roots.clear();
+    for (size_t i = 0; i < new_roots.size(); ++i) {
+        roots.push_back(new_roots[i]);
+    }
+    update_min_node_and_roots();
+}
+
+
+template <class Key, class Storage>
+HeapStats BinomialHeap<Key, Storage>::stats() const {
+#ifdef HEAP_STATS
+    return counters;
+#else
+    return HeapStats();
+#endif
 }
 
 
-template <class Key>
-void BinomialHeap<Key>::change(Pointer ptr, Key key) {
-    erase(ptr);
-    insert(key);
+template <class Key, class Storage>
+void BinomialHeap<Key, Storage>::reset_stats() {
+#ifdef HEAP_STATS
+    counters = HeapStats();
+#endif
+}
+
+
+template <class Key, class Storage>
+MemoryUsage BinomialHeap<Key, Storage>::memory_usage() const {
+    MemoryUsage usage = roots.memory_usage();
+    usage.elements = 0;
+    for (size_t i = 0; i < roots.size(); ++i) {
+        if (roots[i] != nullptr) {
+            usage.elements += (size_t)1 << roots[i]->order;
+        }
+    }
+    usage.live_bytes += usage.elements * (NodePool::slot_bytes() + sizeof(LayerNode));
+    usage.table_bytes = NodePool::table_bytes();
+    return usage;
 }
 
 
 
-template <class Key>
-BinomialHeap<Key>::LayerNode::LayerNode(Node *node) {
+template <class Key, class Storage>
+BinomialHeap<Key, Storage>::LayerNode::LayerNode(Node *node) {
     parent = node;
 }
 
 
-template <class Key>
-BinomialHeap<Key>::Node::Node(Key key_) {
+template <class Key, class Storage>
+template <class... Args>
+BinomialHeap<Key, Storage>::Node::Node(Args&&... args) : key(std::forward<Args>(args)...) {
     order = 0;
     first_child = next_brother = prev_brother = nullptr;
-    key = key_;
     child_layer_node = new LayerNode(this);
     brother_layer_node = nullptr;
 }
 
 
-template <class Key>
-typename BinomialHeap<Key>::Node *BinomialHeap<Key>::get_parent(Node *node) {
+template <class Key, class Storage>
+BinomialHeap<Key, Storage>::Node::~Node() {
+    // every node owns one LayerNode for its children, swap_with_parent only exchanges them
+    delete child_layer_node;
+}
+
+
+template <class Key, class Storage>
+typename BinomialHeap<Key, Storage>::Node *BinomialHeap<Key, Storage>::get_parent(Node *node) {
     if (node->brother_layer_node == nullptr) {
         return nullptr;
     }
@@ -209,8 +415,36 @@ typename BinomialHeap<Key>::Node *BinomialHeap<Key>::get_parent(Node *node) {
 }
 
 
-template <class Key>
-void BinomialHeap<Key>::attach(Node *root, Node *child) {
+template <class Key, class Storage>
+void BinomialHeap<Key, Storage>::delete_tree(Node *node) {
+    // depth of a binomial tree is its order, so recursion is shallow
+    Node *child = node->first_child;
+    while (child != nullptr) {
+        Node *next = child->next_brother;
+        delete_tree(child);
+        child = next;
+    }
+    NodePool::destroy(node);
+}
+
+
+template <class Key, class Storage>
+void BinomialHeap<Key, Storage>::save_tree(SnapshotWriter &writer, Node *node, uint64_t parent, uint64_t &next_index) const {
+    SnapshotRecord record;
+    memset(&record, 0, sizeof(record));
+    record.key = node->key;
+    record.parent = parent;
+    uint64_t index = next_index++;
+    writer.write(record);
+    for (Node *child = node->first_child; child != nullptr; child = child->next_brother) {
+        save_tree(writer, child, index, next_index);
+    }
+}
+
+
+template <class Key, class Storage>
+void BinomialHeap<Key, Storage>::attach(Node *root, Node *child) {
+    HEAP_STAT(++counters.links);
     child->next_brother = root->first_child;
     if (root->first_child != nullptr) {
         root->first_child->prev_brother = child;
@@ -221,15 +455,16 @@ void BinomialHeap<Key>::attach(Node *root, Node *child) {
 }
 
 
-template <class Key>
-typename BinomialHeap<Key>::Node* BinomialHeap<Key>::merge_binomial_trees(Node *a, Node *b) {
+template <class Key, class Storage>
+typename BinomialHeap<Key, Storage>::Node* BinomialHeap<Key, Storage>::merge_binomial_trees(Node *a, Node *b) {
     if (a == nullptr) {
         return b;
     }
     else if (b == nullptr) {
         return a;
     }
-    else if (a->key < b->key) {
+    HEAP_STAT(++counters.comparisons);
+    if (a->key < b->key) {
         attach(a, b);
         return a;
     }
@@ -240,8 +475,8 @@ typename BinomialHeap<Key>::Node* BinomialHeap<Key>::merge_binomial_trees(Node *
 }
 
 
-template <class Key>
-void BinomialHeap<Key>::add_nodes(Vector<Node*> &dest, Vector<Node*> &source) {
+template <class Key, class Storage>
+void BinomialHeap<Key, Storage>::add_nodes(Vector<Node*> &dest, Vector<Node*> &source) {
     // assume that in dest and source trees are in order-increasing order
 
     while (dest.size() < source.size()) {
@@ -261,6 +496,7 @@ void BinomialHeap<Key>::add_nodes(Vector<Node*> &dest, Vector<Node*> &source) {
             else {
                 carry = sum;
                 dest[i] = nullptr;
+                HEAP_STAT(++counters.carries);
             }
         }
         else {
@@ -273,12 +509,14 @@ void BinomialHeap<Key>::add_nodes(Vector<Node*> &dest, Vector<Node*> &source) {
                 else {
                     carry = sum;
                     dest[i] = nullptr;
+                    HEAP_STAT(++counters.carries);
                 }
             }
             else {
                 Node *sum = merge_binomial_trees(dest[i], source[i]);
                 dest[i] = carry;
                 carry = sum;
+                HEAP_STAT(++counters.carries);
             }
         }
     }
@@ -288,14 +526,15 @@ void BinomialHeap<Key>::add_nodes(Vector<Node*> &dest, Vector<Node*> &source) {
 }
 
 
-template<typename Key>
-void BinomialHeap<Key>::update_min_node_and_roots() {
+template<typename Key, typename Storage>
+void BinomialHeap<Key, Storage>::update_min_node_and_roots() {
     min_node = nullptr;
     for (int i = 0; i < roots.size(); ++i) {
         if (min_node == nullptr && roots[i] != nullptr) {
             min_node = roots[i];
         }
-        else if (min_node != nullptr && roots[i] != nullptr && roots[i]->key < min_node->key) {
+        else if (min_node != nullptr && roots[i] != nullptr && (HEAP_STAT(++counters.comparisons),
+                                                                roots[i]->key < min_node->key)) {
             min_node = roots[i];
         }
     }
@@ -305,8 +544,61 @@ void BinomialHeap<Key>::update_min_node_and_roots() {
 }
 
 
-template <class Key>
-void BinomialHeap<Key>::swap_with_parent(Node *child) {
+template <class Key, class Storage>
+void BinomialHeap<Key, Storage>::detach(Node *cur) {
+    // removes the node from the heap without deleting it
+    while (get_parent(cur) != nullptr) {
+        swap_with_parent(cur);
+        HEAP_STAT(counters.sift_step());
+    }
+    HEAP_STAT(counters.sift_done());
+
+    Vector<Node*> children;
+    Node *cur_child = cur->first_child;
+    while (cur_child != nullptr) {
+        children.push_back(cur_child);
+        cur_child = cur_child->next_brother;
+    }
+    for (size_t i = 0; i < children.size(); ++i) {
+        children[i]->brother_layer_node = nullptr;
+        children[i]->prev_brother = nullptr;
+        children[i]->next_brother = nullptr;
+    }
+    children.reverse();
+
+    roots[cur->order] = nullptr;
+    cur->first_child = nullptr;
+    cur->order = 0;
+
+    add_nodes(roots, children);
+
+    update_min_node_and_roots();
+}
+
+
+template <class Key, class Storage>
+void BinomialHeap<Key, Storage>::insert_node(Node *cur_tree) {
+    size_t i = 0;
+    while (i < roots.size() && roots[i] != nullptr) {
+        cur_tree = merge_binomial_trees(cur_tree, roots[i]);
+        roots[i] = nullptr;
+        HEAP_STAT(++counters.carries);
+        ++i;
+    }
+    if (i == roots.size()) {
+        roots.push_back(cur_tree);
+    }
+    else {
+        roots[i] = cur_tree;
+    }
+
+    update_min_node_and_roots();
+}
+
+
+template <class Key, class Storage>
+void BinomialHeap<Key, Storage>::swap_with_parent(Node *child) {
+    HEAP_STAT(++counters.swaps);
     Node *par = get_parent(child);
 
     Node *par_prev = par->prev_brother, *par_next = par->next_brother;
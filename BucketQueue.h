@@ -0,0 +1,576 @@
+#ifndef HEAP_BUCKETQUEUE_H
+#define HEAP_BUCKETQUEUE_H
+
+
+#include "Vector.h"
+#include "NodeStorage.h"
+#include <cstdlib>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+
+
+// key < 0 only for signed keys, for unsigned ones compilers warn that it is always false
+template <class Key>
+bool is_negative_key(Key key, std::true_type) {
+    return key < 0;
+}
+
+
+template <class Key>
+bool is_negative_key(Key, std::false_type) {
+    return false;
+}
+
+
+template <class Key>
+bool is_negative_key(Key key) {
+    return is_negative_key(key, std::is_signed<Key>());
+}
+
+
+// a non-negative key as a bucket number: bucket counts are compared in uint64_t,
+// since a narrow Key can't hold them (256 buckets of uint8_t keys)
+template <class Key>
+uint64_t key_index(Key key) {
+    return (uint64_t)key;
+}
+
+
+// Bitmap of non-empty buckets with one summary bit per bitmap word,
+// so the next non-empty bucket is found with two count-trailing-zeros
+// instead of a scan over buckets
+class BucketBitmap {
+public:
+    explicit BucketBitmap(size_t size);
+
+    size_t size() const;
+    void set(size_t i);
+    void reset(size_t i);
+    // first set bit with index >= from, size() if there is no such bit
+    size_t find_next(size_t from) const;
+    MemoryUsage memory_usage() const;
+
+private:
+    Vector<unsigned long long> words, summary;
+    size_t len;
+};
+
+
+// Storage shared by BucketQueue and CalendarQueue:
+// buckets are doubly linked lists of nodes, indexed by BucketBitmap
+template <class Key>
+class BucketStorage {
+public:
+    class Node {
+    public:
+        Key key;
+        size_t bucket;
+        Node *prev, *next;
+        explicit Node(Key);
+    };
+
+    explicit BucketStorage(size_t bucket_count);
+
+    size_t size() const;
+    size_t bucket_count() const;
+    void add(Node*, size_t bucket);
+    void remove(Node*);
+    // first non-empty bucket with index >= from, bucket_count() if none
+    size_t find_next(size_t from) const;
+    Node *first(size_t bucket) const;
+    // buckets and the bitmap, nodes are allocated by the queues
+    MemoryUsage memory_usage() const;
+
+private:
+    Vector<Node*> buckets;
+    BucketBitmap bitmap;
+    size_t count;
+};
+
+
+// Priority queue for integer keys from [0, range).
+// insert, erase and change are O(1), extract_min is O(range / 4096) in the worst case
+template <class Key, class Storage = NewDeleteStorage>
+class BucketQueue {
+private:
+    typedef typename BucketStorage<Key>::Node Node;
+    typedef typename Storage::template Pool<Node> NodePool;
+
+public:
+    // with SlotMapStorage it stays checkable when its element is removed: using it then throws invalid_argument
+    class Pointer {
+        friend BucketQueue<Key, Storage>;
+    private:
+        typename NodePool::Handle handle;
+        explicit Pointer(Node *ptr_);
+        Node *node() const;
+    public:
+        Pointer();
+        Key getKey();
+    };
+
+    explicit BucketQueue(size_t range);
+    ~BucketQueue();
+    BucketQueue(const BucketQueue&) = delete;
+    BucketQueue &operator=(const BucketQueue&) = delete;
+
+    bool is_empty() const;
+    Pointer insert(Key);
+    void erase(Pointer);
+    Key extract_min();
+    void change(Pointer, Key);
+    Key get_min() const;
+    MemoryUsage memory_usage() const;
+
+private:
+    BucketStorage<Key> storage;
+
+    size_t bucket_of(Key) const;
+};
+
+
+// Calendar queue for timestamps from a sliding window:
+// all keys must lie in [base, base + window), where base is the last extracted key
+// (or the first key inserted into an empty queue). Bucket of a key is key % window,
+// so keys of the window map to distinct buckets and the calendar wraps around.
+template <class Key, class Storage = NewDeleteStorage>
+class CalendarQueue {
+private:
+    typedef typename BucketStorage<Key>::Node Node;
+    typedef typename Storage::template Pool<Node> NodePool;
+
+public:
+    // with SlotMapStorage it stays checkable when its element is removed: using it then throws invalid_argument
+    class Pointer {
+        friend CalendarQueue<Key, Storage>;
+    private:
+        typename NodePool::Handle handle;
+        explicit Pointer(Node *ptr_);
+        Node *node() const;
+    public:
+        Pointer();
+        Key getKey();
+    };
+
+    explicit CalendarQueue(size_t window);
+    ~CalendarQueue();
+    CalendarQueue(const CalendarQueue&) = delete;
+    CalendarQueue &operator=(const CalendarQueue&) = delete;
+
+    bool is_empty() const;
+    Pointer insert(Key);
+    void erase(Pointer);
+    Key extract_min();
+    void change(Pointer, Key);
+    Key get_min() const;
+    MemoryUsage memory_usage() const;
+
+private:
+    BucketStorage<Key> storage;
+    Key base;
+
+    void check_in_window(Key);
+    Node *min_node() const;
+};
+
+
+
+inline BucketBitmap::BucketBitmap(size_t size)
+        : words((size + 63) / 64, 0ull), summary((size + 64 * 64 - 1) / (64 * 64), 0ull) {
+    len = size;
+}
+
+
+inline size_t BucketBitmap::size() const {
+    return len;
+}
+
+
+inline MemoryUsage BucketBitmap::memory_usage() const {
+    MemoryUsage usage = words.memory_usage();
+    usage.add_bytes(summary.memory_usage());
+    usage.elements = 0;
+    return usage;
+}
+
+
+inline void BucketBitmap::set(size_t i) {
+    words[i >> 6] |= 1ull << (i & 63);
+    summary[i >> 12] |= 1ull << ((i >> 6) & 63);
+}
+
+
+inline void BucketBitmap::reset(size_t i) {
+    words[i >> 6] &= ~(1ull << (i & 63));
+    if (words[i >> 6] == 0) {
+        summary[i >> 12] &= ~(1ull << ((i >> 6) & 63));
+    }
+}
+
+
+inline size_t BucketBitmap::find_next(size_t from) const {
+    if (from >= len) {
+        return len;
+    }
+
+    size_t word = from >> 6;
+    unsigned long long bits = words[word] & (~0ull << (from & 63));
+    if (bits != 0) {
+        return (word << 6) + __builtin_ctzll(bits);
+    }
+
+    // look for the next non-empty word through the summary
+    ++word;
+    if (word >= words.size()) {
+        return len;
+    }
+    size_t summary_word = word >> 6;
+    unsigned long long summary_bits = summary[summary_word] & (~0ull << (word & 63));
+    while (summary_bits == 0) {
+        ++summary_word;
+        if (summary_word >= summary.size()) {
+            return len;
+        }
+        summary_bits = summary[summary_word];
+    }
+    word = (summary_word << 6) + __builtin_ctzll(summary_bits);
+    return (word << 6) + __builtin_ctzll(words[word]);
+}
+
+
+
+template <class Key>
+BucketStorage<Key>::Node::Node(Key key_) {
+    key = key_;
+    bucket = 0;
+    prev = next = nullptr;
+}
+
+
+template <class Key>
+BucketStorage<Key>::BucketStorage(size_t bucket_count) : buckets(bucket_count, nullptr), bitmap(bucket_count) {
+    count = 0;
+}
+
+
+template <class Key>
+size_t BucketStorage<Key>::size() const {
+    return count;
+}
+
+
+template <class Key>
+size_t BucketStorage<Key>::bucket_count() const {
+    return bitmap.size();
+}
+
+
+template <class Key>
+MemoryUsage BucketStorage<Key>::memory_usage() const {
+    MemoryUsage usage = buckets.memory_usage();
+    usage.add_bytes(bitmap.memory_usage());
+    usage.elements = count;
+    return usage;
+}
+
+
+template <class Key>
+void BucketStorage<Key>::add(Node *node, size_t bucket) {
+    node->bucket = bucket;
+    node->prev = nullptr;
+    node->next = buckets[bucket];
+    if (node->next != nullptr) {
+        node->next->prev = node;
+    }
+    else {
+        bitmap.set(bucket);
+    }
+    buckets[bucket] = node;
+    ++count;
+}
+
+
+template <class Key>
+void BucketStorage<Key>::remove(Node *node) {
+    if (node->prev != nullptr) {
+        node->prev->next = node->next;
+    }
+    else {
+        buckets[node->bucket] = node->next;
+    }
+    if (node->next != nullptr) {
+        node->next->prev = node->prev;
+    }
+    if (buckets[node->bucket] == nullptr) {
+        bitmap.reset(node->bucket);
+    }
+    node->prev = node->next = nullptr;
+    --count;
+}
+
+
+template <class Key>
+size_t BucketStorage<Key>::find_next(size_t from) const {
+    return bitmap.find_next(from);
+}
+
+
+template <class Key>
+typename BucketStorage<Key>::Node *BucketStorage<Key>::first(size_t bucket) const {
+    return buckets[bucket];
+}
+
+
+
+template <class Key, class Storage>
+BucketQueue<Key, Storage>::Pointer::Pointer() {}
+
+
+template <class Key, class Storage>
+BucketQueue<Key, Storage>::Pointer::Pointer(Node *ptr_) : handle(NodePool::handle(ptr_)) {}
+
+
+template <class Key, class Storage>
+typename BucketQueue<Key, Storage>::Node *BucketQueue<Key, Storage>::Pointer::node() const {
+    Node *ptr = NodePool::get(handle);
+    if (ptr == nullptr) {
+        throw std::invalid_argument("Pointer to a removed element");
+    }
+    return ptr;
+}
+
+
+template <class Key, class Storage>
+Key BucketQueue<Key, Storage>::Pointer::getKey() {
+    return node()->key;
+}
+
+
+template <class Key, class Storage>
+BucketQueue<Key, Storage>::BucketQueue(size_t range) : storage(range) {}
+
+
+template <class Key, class Storage>
+BucketQueue<Key, Storage>::~BucketQueue() {
+    for (size_t bucket = storage.find_next(0); bucket < storage.bucket_count(); bucket = storage.find_next(bucket)) {
+        Node *node = storage.first(bucket);
+        storage.remove(node);
+        NodePool::destroy(node);
+    }
+}
+
+
+template <class Key, class Storage>
+bool BucketQueue<Key, Storage>::is_empty() const {
+    return storage.size() == 0;
+}
+
+
+template <class Key, class Storage>
+typename BucketQueue<Key, Storage>::Pointer BucketQueue<Key, Storage>::insert(Key key) {
+    size_t bucket = bucket_of(key);
+    Node *node = NodePool::create(key);
+    storage.add(node, bucket);
+    return Pointer(node);
+}
+
+
+template <class Key, class Storage>
+void BucketQueue<Key, Storage>::erase(Pointer ptr) {
+    Node *node = ptr.node();
+    storage.remove(node);
+    NodePool::destroy(node);
+}
+
+
+template <class Key, class Storage>
+Key BucketQueue<Key, Storage>::extract_min() {
+    if (is_empty()) {
+        throw std::logic_error("BucketQueue instance is empty");
+    }
+    Node *node = storage.first(storage.find_next(0));
+    Key ret = node->key;
+    storage.remove(node);
+    NodePool::destroy(node);
+    return ret;
+}
+
+
+template <class Key, class Storage>
+void BucketQueue<Key, Storage>::change(Pointer ptr, Key key) {
+    size_t bucket = bucket_of(key);
+    Node *node = ptr.node();
+    storage.remove(node);
+    node->key = key;
+    storage.add(node, bucket);
+}
+
+
+template <class Key, class Storage>
+Key BucketQueue<Key, Storage>::get_min() const {
+    if (is_empty()) {
+        throw std::logic_error("BucketQueue instance is empty");
+    }
+    return storage.first(storage.find_next(0))->key;
+}
+
+
+template <class Key, class Storage>
+MemoryUsage BucketQueue<Key, Storage>::memory_usage() const {
+    MemoryUsage usage = storage.memory_usage();
+    usage.live_bytes += storage.size() * NodePool::slot_bytes();
+    usage.table_bytes = NodePool::table_bytes();
+    return usage;
+}
+
+
+template <class Key, class Storage>
+size_t BucketQueue<Key, Storage>::bucket_of(Key key) const {
+    if (is_negative_key(key) || key_index(key) >= storage.bucket_count()) {
+        throw std::out_of_range("BucketQueue key is out of range");
+    }
+    return (size_t)key;
+}
+
+
+
+template <class Key, class Storage>
+CalendarQueue<Key, Storage>::Pointer::Pointer() {}
+
+
+template <class Key, class Storage>
+CalendarQueue<Key, Storage>::Pointer::Pointer(Node *ptr_) : handle(NodePool::handle(ptr_)) {}
+
+
+template <class Key, class Storage>
+typename CalendarQueue<Key, Storage>::Node *CalendarQueue<Key, Storage>::Pointer::node() const {
+    Node *ptr = NodePool::get(handle);
+    if (ptr == nullptr) {
+        throw std::invalid_argument("Pointer to a removed element");
+    }
+    return ptr;
+}
+
+
+template <class Key, class Storage>
+Key CalendarQueue<Key, Storage>::Pointer::getKey() {
+    return node()->key;
+}
+
+
+template <class Key, class Storage>
+CalendarQueue<Key, Storage>::CalendarQueue(size_t window) : storage(window) {
+    base = 0;
+}
+
+
+template <class Key, class Storage>
+CalendarQueue<Key, Storage>::~CalendarQueue() {
+    for (size_t bucket = storage.find_next(0); bucket < storage.bucket_count(); bucket = storage.find_next(bucket)) {
+        Node *node = storage.first(bucket);
+        storage.remove(node);
+        NodePool::destroy(node);
+    }
+}
+
+
+template <class Key, class Storage>
+bool CalendarQueue<Key, Storage>::is_empty() const {
+    return storage.size() == 0;
+}
+
+
+template <class Key, class Storage>
+typename CalendarQueue<Key, Storage>::Pointer CalendarQueue<Key, Storage>::insert(Key key) {
+    check_in_window(key);
+    Node *node = NodePool::create(key);
+    storage.add(node, (size_t)(key_index(key) % storage.bucket_count()));
+    return Pointer(node);
+}
+
+
+template <class Key, class Storage>
+void CalendarQueue<Key, Storage>::erase(Pointer ptr) {
+    Node *node = ptr.node();
+    storage.remove(node);
+    NodePool::destroy(node);
+}
+
+
+template <class Key, class Storage>
+Key CalendarQueue<Key, Storage>::extract_min() {
+    if (is_empty()) {
+        throw std::logic_error("CalendarQueue instance is empty");
+    }
+    Node *node = min_node();
+    Key ret = node->key;
+    storage.remove(node);
+    NodePool::destroy(node);
+    // the window slides forward to the extracted key
+    base = ret;
+    return ret;
+}
+
+
+template <class Key, class Storage>
+void CalendarQueue<Key, Storage>::change(Pointer ptr, Key key) {
+    Node *node = ptr.node();
+    storage.remove(node);
+    try {
+        check_in_window(key);
+    }
+    catch (std::out_of_range&) {
+        storage.add(node, node->bucket);
+        throw;
+    }
+    node->key = key;
+    storage.add(node, (size_t)(key_index(key) % storage.bucket_count()));
+}
+
+
+template <class Key, class Storage>
+Key CalendarQueue<Key, Storage>::get_min() const {
+    if (is_empty()) {
+        throw std::logic_error("CalendarQueue instance is empty");
+    }
+    return min_node()->key;
+}
+
+
+template <class Key, class Storage>
+MemoryUsage CalendarQueue<Key, Storage>::memory_usage() const {
+    MemoryUsage usage = storage.memory_usage();
+    usage.live_bytes += storage.size() * NodePool::slot_bytes();
+    usage.table_bytes = NodePool::table_bytes();
+    return usage;
+}
+
+
+template <class Key, class Storage>
+void CalendarQueue<Key, Storage>::check_in_window(Key key) {
+    if (is_empty()) {
+        if (is_negative_key(key)) {
+            throw std::out_of_range("CalendarQueue key is out of range");
+        }
+        base = key;
+        return;
+    }
+    if (key < base || key_index(key) - key_index(base) >= storage.bucket_count()) {
+        throw std::out_of_range("CalendarQueue key is out of the current window");
+    }
+}
+
+
+template <class Key, class Storage>
+typename CalendarQueue<Key, Storage>::Node *CalendarQueue<Key, Storage>::min_node() const {
+    // keys of the window go around the calendar starting from the bucket of base
+    size_t bucket = storage.find_next((size_t)(key_index(base) % storage.bucket_count()));
+    if (bucket == storage.bucket_count()) {
+        bucket = storage.find_next(0);
+    }
+    return storage.first(bucket);
+}
+
+
+#endif //HEAP_BUCKETQUEUE_H
@@ -0,0 +1,253 @@
+#ifndef HEAP_CONCURRENTHEAP_H
+#define HEAP_CONCURRENTHEAP_H
+
+
+#include "Vector.h"
+#include <cstdlib>
+#include <mutex>
+#include <stdexcept>
+
+
+// Binary heap with a lock per slot (Hunt, Michael, Parthasarathy, Scott, 1996),
+// any number of threads may insert and extract_min at the same time.
+// Only the size counter is under the global lock, which is held for O(1).
+// Every lock is taken parent first, so inserts go up without deadlocks:
+// a node being inserted is tagged with the id of its insert, and if a concurrent
+// extract_min moves it, the insert finds it again by the tag one level higher.
+// The last slot is taken in bit-reversed order, so consecutive inserts and extracts
+// go to different subtrees and don't wait for each other near the bottom.
+template <class Key>
+class ConcurrentHeap {
+public:
+    explicit ConcurrentHeap(size_t capacity);
+
+    // both are only a snapshot when other threads are working
+    bool is_empty() const;
+    size_t size() const;
+
+    void insert(Key);
+    // returns false if the heap is empty
+    bool try_extract_min(Key &result);
+    Key extract_min();
+
+private:
+    // tags of slots, other values are ids of inserts which are still going up
+    enum {
+        EMPTY = 0,
+        AVAILABLE = 1,
+        FIRST_INSERT_ID = 2
+    };
+
+    class Slot {
+        friend ConcurrentHeap<Key>;
+    private:
+        std::mutex lock;
+        Key key;
+        size_t tag;
+    public:
+        // Vector creates slots
+        Slot();
+    };
+
+    // slots are numbered from 1, children of i are 2i and 2i + 1
+    Vector<Slot> slots;
+    size_t capacity;
+
+    mutable std::mutex heap_lock;
+    size_t count;
+    size_t next_insert_id;
+
+    static size_t bit_reversed(size_t position);
+    static size_t level_end(size_t position);
+    void swap_items(size_t i, size_t j);
+};
+
+
+
+template <class Key>
+ConcurrentHeap<Key>::ConcurrentHeap(size_t capacity_) : slots(level_end(capacity_)) {
+    capacity = capacity_;
+    count = 0;
+    next_insert_id = FIRST_INSERT_ID;
+}
+
+
+template <class Key>
+bool ConcurrentHeap<Key>::is_empty() const {
+    return size() == 0;
+}
+
+
+template <class Key>
+size_t ConcurrentHeap<Key>::size() const {
+    std::lock_guard<std::mutex> guard(heap_lock);
+    return count;
+}
+
+
+template <class Key>
+void ConcurrentHeap<Key>::insert(Key key) {
+    heap_lock.lock();
+    if (count == capacity) {
+        heap_lock.unlock();
+        throw std::logic_error("ConcurrentHeap instance is full");
+    }
+    size_t id = next_insert_id++;
+    size_t i = bit_reversed(++count);
+    slots[i].lock.lock();
+    heap_lock.unlock();
+    slots[i].key = key;
+    slots[i].tag = id;
+    slots[i].lock.unlock();
+
+    while (i > 1) {
+        size_t parent = i / 2;
+        slots[parent].lock.lock();
+        slots[i].lock.lock();
+        size_t old_i = i;
+        if (slots[parent].tag == AVAILABLE && slots[i].tag == id) {
+            if (slots[i].key < slots[parent].key) {
+                swap_items(i, parent);
+                i = parent;
+            }
+            else {
+                slots[i].tag = AVAILABLE;
+                i = 0;
+            }
+        }
+        else if (slots[parent].tag == EMPTY) {
+            // the node was taken by extract_min as the last one
+            i = 0;
+        }
+        else if (slots[i].tag != id) {
+            // extract_min swapped the node with its parent
+            i = parent;
+        }
+        // otherwise the parent is an insert still going up, wait for it
+        slots[old_i].lock.unlock();
+        slots[parent].lock.unlock();
+    }
+    if (i == 1) {
+        slots[1].lock.lock();
+        if (slots[1].tag == id) {
+            slots[1].tag = AVAILABLE;
+        }
+        slots[1].lock.unlock();
+    }
+}
+
+
+template <class Key>
+bool ConcurrentHeap<Key>::try_extract_min(Key &result) {
+    heap_lock.lock();
+    if (count == 0) {
+        heap_lock.unlock();
+        return false;
+    }
+    size_t bottom = bit_reversed(count--);
+    slots[bottom].lock.lock();
+    heap_lock.unlock();
+    Key key = slots[bottom].key;
+    slots[bottom].tag = EMPTY;
+    slots[bottom].lock.unlock();
+
+    slots[1].lock.lock();
+    if (slots[1].tag == EMPTY) {
+        // the last node was the root itself
+        slots[1].lock.unlock();
+        result = key;
+        return true;
+    }
+    result = slots[1].key;
+    slots[1].key = key;
+    slots[1].tag = AVAILABLE;
+
+    size_t i = 1;
+    // there are whole levels of slots, so the right child exists if the left one does
+    while (2 * i < slots.size()) {
+        size_t left = 2 * i, right = 2 * i + 1, child;
+        slots[left].lock.lock();
+        slots[right].lock.lock();
+        if (slots[left].tag == EMPTY) {
+            slots[right].lock.unlock();
+            slots[left].lock.unlock();
+            break;
+        }
+        else if (slots[right].tag == EMPTY || slots[left].key < slots[right].key) {
+            slots[right].lock.unlock();
+            child = left;
+        }
+        else {
+            slots[left].lock.unlock();
+            child = right;
+        }
+
+        if (slots[child].key < slots[i].key) {
+            swap_items(child, i);
+            slots[i].lock.unlock();
+            i = child;
+        }
+        else {
+            slots[child].lock.unlock();
+            break;
+        }
+    }
+    slots[i].lock.unlock();
+    return true;
+}
+
+
+template <class Key>
+Key ConcurrentHeap<Key>::extract_min() {
+    Key result;
+    if (!try_extract_min(result)) {
+        throw std::logic_error("ConcurrentHeap instance is empty");
+    }
+    return result;
+}
+
+
+
+template <class Key>
+ConcurrentHeap<Key>::Slot::Slot() {
+    tag = EMPTY;
+}
+
+
+template <class Key>
+size_t ConcurrentHeap<Key>::bit_reversed(size_t position) {
+    // reverses the bits below the highest one, which stays (it is the level)
+    size_t high = 1;
+    while (high * 2 <= position) {
+        high *= 2;
+    }
+    size_t result = high;
+    for (size_t bit = 1, reversed = high / 2; bit < high; bit *= 2, reversed /= 2) {
+        if (position & bit) {
+            result |= reversed;
+        }
+    }
+    return result;
+}
+
+
+template <class Key>
+size_t ConcurrentHeap<Key>::level_end(size_t position) {
+    // bit-reversed positions fill a level in any order,
+    // so there are slots up to the end of the level of the last position
+    size_t end = 2;
+    while (end <= position) {
+        end *= 2;
+    }
+    return end;
+}
+
+
+template <class Key>
+void ConcurrentHeap<Key>::swap_items(size_t i, size_t j) {
+    swap(slots[i].key, slots[j].key);
+    swap(slots[i].tag, slots[j].tag);
+}
+
+
+#endif //HEAP_CONCURRENTHEAP_H
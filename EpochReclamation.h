@@ -0,0 +1,147 @@
+#ifndef HEAP_EPOCHRECLAMATION_H
+#define HEAP_EPOCHRECLAMATION_H
+
+
+#include <cstdlib>
+#include <cstdint>
+#include <atomic>
+
+
+// Epoch-based reclamation (Fraser, 2004), one domain for the whole process.
+// A thread reads shared nodes of lock-free structures only inside a Guard. The global epoch
+// moves from e to e + 1 only when every thread inside a Guard has announced e, so a node
+// which was unlinked while the epoch was e can't be reached by anybody once the epoch is e + 2.
+// Structures keep their unlinked nodes with the epoch read after unlinking and free them then.
+// A thread which stays inside a Guard holds back reclamation of every structure, not their progress.
+class EpochReclamation {
+public:
+    // announces the thread for its lifetime, guards may be nested
+    class Guard {
+    public:
+        Guard();
+        ~Guard();
+        Guard(const Guard&) = delete;
+        Guard &operator=(const Guard&) = delete;
+    };
+
+    static uint64_t current();
+    // moves the epoch forward if every thread inside a guard has seen the current one,
+    // returns the epoch after the attempt
+    static uint64_t try_advance();
+    // nodes unlinked at epoch retired may be freed when the epoch is now
+    static bool is_safe(uint64_t retired, uint64_t now);
+
+private:
+    struct Record {
+        // (epoch << 1) | 1 inside a guard, 0 outside
+        std::atomic<uint64_t> state;
+        std::atomic<bool> taken;
+        Record *next;
+        Record();
+    };
+
+    struct Local {
+        Record *record;
+        int depth;
+        Local();
+        // the record is left for threads started later
+        ~Local();
+    };
+
+    static std::atomic<uint64_t> &epoch();
+    // records are never freed, there are as many as threads were alive at once
+    static std::atomic<Record*> &records();
+    static Local &local();
+};
+
+
+
+inline EpochReclamation::Guard::Guard() {
+    Local &own = local();
+    if (own.depth++ == 0) {
+        own.record->state.store(epoch().load() << 1 | 1);
+    }
+}
+
+
+inline EpochReclamation::Guard::~Guard() {
+    Local &own = local();
+    if (--own.depth == 0) {
+        own.record->state.store(0);
+    }
+}
+
+
+
+inline uint64_t EpochReclamation::current() {
+    return epoch().load();
+}
+
+
+inline uint64_t EpochReclamation::try_advance() {
+    uint64_t e = epoch().load();
+    for (Record *r = records().load(); r != nullptr; r = r->next) {
+        uint64_t state = r->state.load();
+        if ((state & 1) && (state >> 1) != e) {
+            return e;
+        }
+    }
+    // fails only if somebody else has advanced it
+    epoch().compare_exchange_strong(e, e + 1);
+    return epoch().load();
+}
+
+
+inline bool EpochReclamation::is_safe(uint64_t retired, uint64_t now) {
+    return retired + 2 <= now;
+}
+
+
+
+inline EpochReclamation::Record::Record() : state(0), taken(true) {
+    next = nullptr;
+}
+
+
+inline EpochReclamation::Local::Local() {
+    depth = 0;
+    for (Record *r = records().load(); r != nullptr; r = r->next) {
+        bool expected = false;
+        if (!r->taken.load() && r->taken.compare_exchange_strong(expected, true)) {
+            record = r;
+            return;
+        }
+    }
+    record = new Record();
+    Record *first = records().load();
+    do {
+        record->next = first;
+    } while (!records().compare_exchange_weak(first, record));
+}
+
+
+inline EpochReclamation::Local::~Local() {
+    record->state.store(0);
+    record->taken.store(false);
+}
+
+
+inline std::atomic<uint64_t> &EpochReclamation::epoch() {
+    static std::atomic<uint64_t> instance(0);
+    return instance;
+}
+
+
+inline std::atomic<EpochReclamation::Record*> &EpochReclamation::records() {
+    static std::atomic<Record*> instance(nullptr);
+    return instance;
+}
+
+
+inline EpochReclamation::Local &EpochReclamation::local() {
+    static thread_local Local instance;
+    return instance;
+}
+
+
+#endif //HEAP_EPOCHRECLAMATION_H
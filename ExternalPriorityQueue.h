@@ -0,0 +1,475 @@
+#ifndef HEAP_EXTERNALPRIORITYQUEUE_H
+#define HEAP_EXTERNALPRIORITYQUEUE_H
+
+
+#include "Vector.h"
+#include "Heap.h"
+#include <cstdlib>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <stdexcept>
+#include <type_traits>
+#include <unistd.h>
+
+
+// Priority queue for more keys than fit in memory (external sorting with a loser tree).
+// New keys go to a small in-memory Heap; when it reaches its share of the memory budget,
+// it is written to a temporary file as one sorted run. extract_min compares the minimum
+// of the Heap with the winner of a loser tree over the heads of all runs, and runs are
+// read lazily in blocks of up to 1 MiB, so both reads and writes are sequential.
+// When there are more runs than blocks fitting in the budget, the runs of the lowest
+// merge levels are merged into one run of the next level, so a key is rewritten about
+// log(n / keys in memory) / log(runs in memory) times. Key is written to files as raw bytes, so it must be trivially copyable.
+template <class Key>
+class ExternalPriorityQueue {
+    static_assert(std::is_trivially_copyable<Key>::value, "ExternalPriorityQueue stores raw bytes of keys");
+public:
+    // memory_budget is in bytes, runs are created in temp_dir
+    explicit ExternalPriorityQueue(size_t memory_budget = 64 << 20, const std::string &temp_dir = "/tmp");
+    ~ExternalPriorityQueue();
+
+    bool is_empty() const;
+    size_t size() const;
+    // number of sorted runs on disk, exhausted ones included until the next spill
+    size_t runs_count() const;
+
+    void insert(Key);
+    Key get_min() const;
+    Key extract_min();
+
+private:
+    static const size_t MAX_BLOCK_BYTES = 1 << 20;
+    static const size_t MAX_HEAP_KEYS = 1 << 16;
+
+    // sorted sequence of keys in an unlinked temporary file, read block by block
+    class Run {
+        friend ExternalPriorityQueue<Key>;
+    private:
+        int fd;
+        // keys still in the file after the current block
+        size_t unread;
+        Key *block;
+        size_t capacity, block_size, position;
+        // 0 for spilled Heaps, merged runs are one level higher than the highest of them
+        int level;
+
+        Run(int fd_, size_t count, size_t block_capacity, int level_);
+        ~Run();
+        bool is_exhausted() const;
+        const Key &head() const;
+        void advance();
+        void read_block();
+    };
+
+    Heap<Key> heap;
+    size_t heap_size, heap_capacity;
+    Vector<Run*> runs;
+    // tree[0] is the index of the run with the smallest head, tree[i] is the loser at node i,
+    // leaves are runs, padded to a power of two
+    Vector<size_t> tree;
+    size_t leaves;
+
+    size_t count;
+    size_t block_capacity, max_runs;
+    std::string temp_dir;
+
+    // writes keys into a new file through a buffer of one block
+    class Writer {
+        friend ExternalPriorityQueue<Key>;
+    private:
+        int fd;
+        Key *buffer;
+        size_t buffered, written, capacity;
+
+        Writer(const std::string &temp_dir, size_t capacity_);
+        ~Writer();
+        void write(const Key&);
+        void flush();
+    };
+
+    bool run_less(size_t i, size_t j) const;
+    size_t play(size_t node);
+    void rebuild_tree();
+    void replay(size_t run);
+    bool run_has_min() const;
+    void spill();
+    void merge_runs();
+
+    static int open_temp_file(const std::string &temp_dir);
+};
+
+
+
+template <class Key>
+ExternalPriorityQueue<Key>::ExternalPriorityQueue(size_t memory_budget, const std::string &temp_dir_) {
+    temp_dir = temp_dir_;
+    count = heap_size = 0;
+    leaves = 0;
+    // at most half of the budget is the Heap: a node with its allocation header,
+    // and the pointer in the array with spare capacity
+    heap_capacity = max(memory_budget / 2 / (sizeof(Key) + sizeof(size_t) + 4 * sizeof(void*)), (size_t)1);
+    // a larger Heap misses the cache on every level, more runs are cheaper
+    if (heap_capacity > MAX_HEAP_KEYS) {
+        heap_capacity = MAX_HEAP_KEYS;
+    }
+    // the other half is blocks of runs, at least 8 of them, and the output block of a merge
+    size_t block_bytes = memory_budget / 2 / 9;
+    if (block_bytes > MAX_BLOCK_BYTES) {
+        block_bytes = MAX_BLOCK_BYTES;
+    }
+    block_capacity = max(block_bytes / sizeof(Key), (size_t)1);
+    max_runs = max(memory_budget / 2 / (block_capacity * sizeof(Key)) - 1, (size_t)2);
+    // fails early on a wrong directory, not when the first run is written
+    close(open_temp_file(temp_dir));
+}
+
+
+template <class Key>
+ExternalPriorityQueue<Key>::~ExternalPriorityQueue() {
+    for (size_t i = 0; i < runs.size(); ++i) {
+        delete runs[i];
+    }
+}
+
+
+template <class Key>
+bool ExternalPriorityQueue<Key>::is_empty() const {
+    return count == 0;
+}
+
+
+template <class Key>
+size_t ExternalPriorityQueue<Key>::size() const {
+    return count;
+}
+
+
+template <class Key>
+size_t ExternalPriorityQueue<Key>::runs_count() const {
+    return runs.size();
+}
+
+
+template <class Key>
+void ExternalPriorityQueue<Key>::insert(Key key) {
+    if (heap_size == heap_capacity) {
+        spill();
+    }
+    heap.insert(key);
+    ++heap_size;
+    ++count;
+}
+
+
+template <class Key>
+Key ExternalPriorityQueue<Key>::get_min() const {
+    if (is_empty()) {
+        throw std::logic_error("ExternalPriorityQueue instance is empty");
+    }
+    if (run_has_min()) {
+        return runs[tree[0]]->head();
+    }
+    return heap.get_min();
+}
+
+
+template <class Key>
+Key ExternalPriorityQueue<Key>::extract_min() {
+    if (is_empty()) {
+        throw std::logic_error("ExternalPriorityQueue instance is empty");
+    }
+    --count;
+    if (run_has_min()) {
+        size_t winner = tree[0];
+        Key result = runs[winner]->head();
+        runs[winner]->advance();
+        replay(winner);
+        return result;
+    }
+    --heap_size;
+    return heap.extract_min();
+}
+
+
+
+template <class Key>
+ExternalPriorityQueue<Key>::Run::Run(int fd_, size_t count, size_t block_capacity, int level_) {
+    fd = fd_;
+    level = level_;
+    unread = count;
+    capacity = block_capacity;
+    block = new Key[capacity];
+    block_size = position = 0;
+    if (lseek(fd, 0, SEEK_SET) < 0) {
+        throw std::runtime_error(std::string("ExternalPriorityQueue can't read a run: ") + strerror(errno));
+    }
+    read_block();
+}
+
+
+template <class Key>
+ExternalPriorityQueue<Key>::Run::~Run() {
+    delete[] block;
+    close(fd);
+}
+
+
+template <class Key>
+bool ExternalPriorityQueue<Key>::Run::is_exhausted() const {
+    return position == block_size;
+}
+
+
+template <class Key>
+const Key &ExternalPriorityQueue<Key>::Run::head() const {
+    return block[position];
+}
+
+
+template <class Key>
+void ExternalPriorityQueue<Key>::Run::advance() {
+    ++position;
+    if (position == block_size && unread > 0) {
+        read_block();
+    }
+}
+
+
+template <class Key>
+void ExternalPriorityQueue<Key>::Run::read_block() {
+    size_t keys = unread < capacity ? unread : capacity;
+    size_t bytes = keys * sizeof(Key), done = 0;
+    char *data = (char*)block;
+    while (done < bytes) {
+        ssize_t got = ::read(fd, data + done, bytes - done);
+        if (got <= 0) {
+            if (got < 0 && errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error(std::string("ExternalPriorityQueue can't read a run: ")
+                                     + (got < 0 ? strerror(errno) : "unexpected end of file"));
+        }
+        done += got;
+    }
+    unread -= keys;
+    block_size = keys;
+    position = 0;
+}
+
+
+
+template <class Key>
+ExternalPriorityQueue<Key>::Writer::Writer(const std::string &temp_dir, size_t capacity_) {
+    fd = open_temp_file(temp_dir);
+    capacity = capacity_;
+    buffer = new Key[capacity];
+    buffered = written = 0;
+}
+
+
+template <class Key>
+ExternalPriorityQueue<Key>::Writer::~Writer() {
+    delete[] buffer;
+}
+
+
+template <class Key>
+void ExternalPriorityQueue<Key>::Writer::write(const Key &key) {
+    buffer[buffered++] = key;
+    if (buffered == capacity) {
+        flush();
+    }
+}
+
+
+template <class Key>
+void ExternalPriorityQueue<Key>::Writer::flush() {
+    size_t bytes = buffered * sizeof(Key), done = 0;
+    const char *data = (const char*)buffer;
+    while (done < bytes) {
+        ssize_t put = ::write(fd, data + done, bytes - done);
+        if (put < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            close(fd);
+            throw std::runtime_error(std::string("ExternalPriorityQueue can't write a run: ") + strerror(errno));
+        }
+        done += put;
+    }
+    written += buffered;
+    buffered = 0;
+}
+
+
+
+template <class Key>
+bool ExternalPriorityQueue<Key>::run_less(size_t i, size_t j) const {
+    // padding leaves and exhausted runs are larger than everything
+    if (i >= runs.size() || runs[i]->is_exhausted()) {
+        return false;
+    }
+    if (j >= runs.size() || runs[j]->is_exhausted()) {
+        return true;
+    }
+    return runs[i]->head() < runs[j]->head();
+}
+
+
+template <class Key>
+size_t ExternalPriorityQueue<Key>::play(size_t node) {
+    // returns the winner of the subtree, losers stay in its nodes
+    if (node >= leaves) {
+        return node - leaves;
+    }
+    size_t left = play(2 * node), right = play(2 * node + 1);
+    if (run_less(right, left)) {
+        tree[node] = left;
+        return right;
+    }
+    tree[node] = right;
+    return left;
+}
+
+
+template <class Key>
+void ExternalPriorityQueue<Key>::rebuild_tree() {
+    leaves = 1;
+    while (leaves < runs.size()) {
+        leaves *= 2;
+    }
+    tree.clear();
+    for (size_t i = 0; i < leaves; ++i) {
+        tree.push_back(0);
+    }
+    if (leaves == 1) {
+        tree[0] = 0;
+        return;
+    }
+    tree[0] = play(1);
+}
+
+
+template <class Key>
+void ExternalPriorityQueue<Key>::replay(size_t run) {
+    // only the head of this run changed: one comparison per level
+    size_t winner = run;
+    for (size_t node = (run + leaves) / 2; node > 0; node /= 2) {
+        if (run_less(tree[node], winner)) {
+            swap(tree[node], winner);
+        }
+    }
+    tree[0] = winner;
+}
+
+
+template <class Key>
+bool ExternalPriorityQueue<Key>::run_has_min() const {
+    if (runs.is_empty() || runs[tree[0]]->is_exhausted()) {
+        return false;
+    }
+    return heap_size == 0 || runs[tree[0]]->head() < heap.get_min();
+}
+
+
+template <class Key>
+void ExternalPriorityQueue<Key>::spill() {
+    Writer writer(temp_dir, block_capacity);
+    while (heap_size > 0) {
+        writer.write(heap.extract_min());
+        --heap_size;
+    }
+    writer.flush();
+
+    // runs which were read completely are not needed any more
+    size_t kept = 0;
+    for (size_t i = 0; i < runs.size(); ++i) {
+        if (runs[i]->is_exhausted()) {
+            delete runs[i];
+        }
+        else {
+            runs[kept++] = runs[i];
+        }
+    }
+    while (runs.size() > kept) {
+        runs.pop_back();
+    }
+    runs.push_back(new Run(writer.fd, writer.written, block_capacity, 0));
+    while (runs.size() > max_runs) {
+        merge_runs();
+    }
+    rebuild_tree();
+}
+
+
+template <class Key>
+void ExternalPriorityQueue<Key>::merge_runs() {
+    // the lowest levels are taken until there are at least two runs
+    int level = runs[0]->level;
+    for (size_t i = 1; i < runs.size(); ++i) {
+        level = runs[i]->level < level ? runs[i]->level : level;
+    }
+    size_t selected_count = 0;
+    while (selected_count < 2) {
+        selected_count = 0;
+        for (size_t i = 0; i < runs.size(); ++i) {
+            selected_count += runs[i]->level <= level;
+        }
+        ++level;
+    }
+
+    // the loser tree works over runs, so the others wait aside
+    Vector<Run*> others;
+    size_t kept = 0;
+    for (size_t i = 0; i < runs.size(); ++i) {
+        if (runs[i]->level < level) {
+            runs[kept++] = runs[i];
+        }
+        else {
+            others.push_back(runs[i]);
+        }
+    }
+    while (runs.size() > kept) {
+        runs.pop_back();
+    }
+    rebuild_tree();
+
+    Writer writer(temp_dir, block_capacity);
+    while (!runs[tree[0]]->is_exhausted()) {
+        size_t winner = tree[0];
+        writer.write(runs[winner]->head());
+        runs[winner]->advance();
+        replay(winner);
+    }
+    writer.flush();
+    for (size_t i = 0; i < runs.size(); ++i) {
+        delete runs[i];
+    }
+    runs.clear();
+    for (size_t i = 0; i < others.size(); ++i) {
+        runs.push_back(others[i]);
+    }
+    runs.push_back(new Run(writer.fd, writer.written, block_capacity, level));
+}
+
+
+template <class Key>
+int ExternalPriorityQueue<Key>::open_temp_file(const std::string &temp_dir) {
+    // the file is unlinked at once: the system removes it when it is closed, even after a crash
+    std::string name = temp_dir + "/heap_run_XXXXXX";
+    Vector<char> path;
+    for (size_t i = 0; i < name.size(); ++i) {
+        path.push_back(name[i]);
+    }
+    path.push_back('\0');
+    int fd = mkstemp(&path[0]);
+    if (fd < 0) {
+        throw std::runtime_error("ExternalPriorityQueue can't create a file in " + temp_dir + ": " + strerror(errno));
+    }
+    unlink(&path[0]);
+    return fd;
+}
+
+
+#endif //HEAP_EXTERNALPRIORITYQUEUE_H
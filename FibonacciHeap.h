@@ -3,46 +3,91 @@
 
 
 #include "Vector.h"
+#include "MappedFile.h"
+#include "NodeStorage.h"
+#include "HeapStats.h"
 #include <cstdlib>
+#include <string>
+#include <type_traits>
+#include <utility>
 
 
-template <class Key>
+template <class Key, class Storage = NewDeleteStorage>
 class FibonacciHeap {
 private:
     class Node;
+    typedef typename Storage::template Pool<Node> NodePool;
 public:
+    // with SlotMapStorage it stays checkable when its element is removed: using it then throws invalid_argument
     class Pointer {
-        friend FibonacciHeap<Key>;
+        friend FibonacciHeap<Key, Storage>;
     private:
-        Node *ptr;
+        typename NodePool::Handle handle;
         explicit Pointer(Node *ptr_);
+        Node *node() const;
     public:
         Pointer();
-        Key getKey();
+        const Key &getKey();
     };
 
     FibonacciHeap();
+    ~FibonacciHeap();
+    FibonacciHeap(const FibonacciHeap&) = delete;
+    FibonacciHeap &operator=(const FibonacciHeap&) = delete;
 
     bool is_empty() const;
-    Pointer insert(Key);
-    Key get_min() const;
+    Pointer insert(const Key&);
+    Pointer insert(Key&&);
+    // constructs the key in its node from the arguments
+    template <class... Args>
+    Pointer emplace(Args&&... args);
+    const Key &get_min() const;
+    // the key is moved out of its node
     Key extract_min();
     void merge(FibonacciHeap&);
     void decrease(Pointer, Key);
+    // writes nodes with indices of their parents and marks, Key must be trivially copyable
+    void save(const std::string &path) const;
+    // replaces the content with a snapshot written by save, builds new nodes,
+    // trees keep their shape; a corrupted file throws runtime_error and changes nothing
+    void load(const std::string &path);
+    // counters of the operations since construction or reset_stats,
+    // all zeros unless compiled with HEAP_STATS, see HeapStats.h
+    HeapStats stats() const;
+    void reset_stats();
+    MemoryUsage memory_usage() const;
 
 private:
     class Node {
-        friend FibonacciHeap<Key>;
+        friend FibonacciHeap<Key, Storage>;
+        friend NodePool;
     private:
         Key key;
         Node *parent, *child, *prev, *next;
         size_t degree;
         bool mark;
-        explicit Node(Key);
+        template <class... Args>
+        explicit Node(Args&&... args);
     };
 
-    Node *min_node;
+    // relocatable form of a node in snapshots
+    struct SnapshotRecord {
+        Key key;
+        // index of the parent record, which is always earlier, or the index of the record itself for roots
+        uint64_t parent;
+        bool mark;
+    };
 
+    Node *min_node;
+    // only for memory_usage, nothing else needs the size
+    size_t count;
+#ifdef HEAP_STATS
+    HeapStats counters;
+#endif
+
+    void delete_list(Node*);
+    template <class Visitor>
+    void for_each_node(Visitor visit) const;
     void attach(Node*, Node*);
     void add_node_to_roots(Node*);
     void consolidate(Node*);
@@ -52,47 +97,77 @@ private:
 
 
 
-template <class Key>
-FibonacciHeap<Key>::Pointer::Pointer(Node *ptr_) {
-    ptr = ptr_;
-}
+template <class Key, class Storage>
+FibonacciHeap<Key, Storage>::Pointer::Pointer() {}
+
+
+template <class Key, class Storage>
+FibonacciHeap<Key, Storage>::Pointer::Pointer(Node *ptr_) : handle(NodePool::handle(ptr_)) {}
 
 
-template <class Key>
-FibonacciHeap<Key>::Pointer::Pointer() {
-    ptr = nullptr;
+template <class Key, class Storage>
+typename FibonacciHeap<Key, Storage>::Node *FibonacciHeap<Key, Storage>::Pointer::node() const {
+    Node *ptr = NodePool::get(handle);
+    if (ptr == nullptr) {
+        throw std::invalid_argument("Pointer to a removed element");
+    }
+    return ptr;
 }
 
 
-template <class Key>
-Key FibonacciHeap<Key>::Pointer::getKey() {
-    return ptr->key;
+template <class Key, class Storage>
+const Key &FibonacciHeap<Key, Storage>::Pointer::getKey() {
+    return node()->key;
 }
 
 
 
-template <class Key>
-FibonacciHeap<Key>::FibonacciHeap() {
+template <class Key, class Storage>
+FibonacciHeap<Key, Storage>::FibonacciHeap() {
     min_node = nullptr;
+    count = 0;
 }
 
 
-template <class Key>
-bool FibonacciHeap<Key>::is_empty() const {
+template <class Key, class Storage>
+FibonacciHeap<Key, Storage>::~FibonacciHeap() {
+    if (min_node != nullptr) {
+        delete_list(min_node);
+    }
+}
+
+
+template <class Key, class Storage>
+bool FibonacciHeap<Key, Storage>::is_empty() const {
     return min_node == nullptr;
 }
 
 
-template<class Key>
-typename FibonacciHeap<Key>::Pointer FibonacciHeap<Key>::insert(Key key) {
-    Node *new_node = new Node(key);
+template <class Key, class Storage>
+typename FibonacciHeap<Key, Storage>::Pointer FibonacciHeap<Key, Storage>::insert(const Key &key) {
+    return emplace(key);
+}
+
+
+template <class Key, class Storage>
+typename FibonacciHeap<Key, Storage>::Pointer FibonacciHeap<Key, Storage>::insert(Key &&key) {
+    return emplace(std::move(key));
+}
+
+
+template <class Key, class Storage>
+template <class... Args>
+typename FibonacciHeap<Key, Storage>::Pointer FibonacciHeap<Key, Storage>::emplace(Args&&... args) {
+    Node *new_node = NodePool::create(std::forward<Args>(args)...);
+    HEAP_STAT(++counters.allocations);
+    ++count;
     add_node_to_roots(new_node);
     return Pointer(new_node);
 }
 
 
-template<class Key>
-Key FibonacciHeap<Key>::get_min() const {
+template <class Key, class Storage>
+const Key &FibonacciHeap<Key, Storage>::get_min() const {
     if (is_empty()) {
         throw std::logic_error("FibonacciHeap instance is empty");
     }
@@ -100,13 +175,11 @@ Key FibonacciHeap<Key>::get_min() const {
 }
 
 
-template <class Key>
-Key FibonacciHeap<Key>::extract_min() {
+template <class Key, class Storage>
+Key FibonacciHeap<Key, Storage>::extract_min() {
     if (is_empty()) {
         throw std::logic_error("FibonacciHeap instance is empty");
     }
-    Key ret = min_node->key;
-
     Node *cur = min_node->child;
     if (cur != nullptr) {
         Vector<Node*> children;
@@ -130,7 +203,10 @@ Key FibonacciHeap<Key>::extract_min() {
     next_node->prev = prev_node;
     bool flag = (next_node == min_node);
 
-    delete min_node;
+    // children were compared with min_node while added to roots, the key is moved out only now
+    Key ret = std::move(min_node->key);
+    NodePool::destroy(min_node);
+    --count;
 
     min_node = nullptr;
     if (!flag) {
@@ -141,8 +217,10 @@ Key FibonacciHeap<Key>::extract_min() {
 }
 
 
-template<class Key>
-void FibonacciHeap<Key>::merge(FibonacciHeap &otherHeap) {
+template <class Key, class Storage>
+void FibonacciHeap<Key, Storage>::merge(FibonacciHeap &otherHeap) {
+    count += otherHeap.count;
+    otherHeap.count = 0;
     if (min_node == nullptr) {
         min_node = otherHeap.min_node;
     }
@@ -162,7 +240,8 @@ void FibonacciHeap<Key>::merge(FibonacciHeap &otherHeap) {
         a->next = c;
         c->prev = a;
         d->next = b;
-        b->prev = a;
+        b->prev = d;
+        HEAP_STAT(++counters.comparisons);
         if (otherHeap.min_node->key < min_node->key) {
             min_node = otherHeap.min_node;
         }
@@ -171,37 +250,183 @@ void FibonacciHeap<Key>::merge(FibonacciHeap &otherHeap) {
 }
 
 
-template<class Key>
-void FibonacciHeap<Key>::decrease(Pointer ptr, Key key) {
-    Node *cur = ptr.ptr;
+template <class Key, class Storage>
+void FibonacciHeap<Key, Storage>::decrease(Pointer ptr, Key key) {
+    Node *cur = ptr.node();
+    HEAP_STAT(++counters.comparisons);
     if (cur->key < key) {
         throw std::invalid_argument("Decrease new value is bigger than current value");
     }
 
-    cur->key = key;
+    cur->key = std::move(key);
     Node *par = cur->parent;
-    if (par != nullptr && cur->key < par->key) {
+    if (par != nullptr && (HEAP_STAT(++counters.comparisons), cur->key < par->key)) {
         cut(cur);
         cascading_cut(par);
     }
-    else if (cur->key < min_node->key) {
+    else if ((HEAP_STAT(++counters.comparisons), cur->key < min_node->key)) {
         min_node = cur;
     }
 }
 
 
 
-template<class Key>
-FibonacciHeap<Key>::Node::Node(Key key_) {
-    key = key_;
+template <class Key, class Storage>
+void FibonacciHeap<Key, Storage>::save(const std::string &path) const {
+    static_assert(std::is_trivially_copyable<Key>::value, "snapshots store raw bytes of keys");
+    // the heap doesn't know its size, so nodes are counted first
+    uint64_t count = 0;
+    for_each_node([&count](Node*, uint64_t, uint64_t) {
+        ++count;
+    });
+    SnapshotWriter writer(path, "FIBOSNP1", sizeof(Key), 0, count);
+    for_each_node([&writer](Node *node, uint64_t parent, uint64_t) {
+        SnapshotRecord record;
+        memset(&record, 0, sizeof(record));
+        record.key = node->key;
+        record.parent = parent;
+        record.mark = node->mark;
+        writer.write(record);
+    });
+    writer.close();
+}
+
+
+template <class Key, class Storage>
+void FibonacciHeap<Key, Storage>::load(const std::string &path) {
+    static_assert(std::is_trivially_copyable<Key>::value, "snapshots store raw bytes of keys");
+    MappedFile file(path);
+    SnapshotHeader header;
+    const char *records = snapshot_records(file, "FIBOSNP1", sizeof(Key), sizeof(SnapshotRecord), header);
+    // parents come first and no key is less than its parent's, roots are their own parents
+    for (uint64_t i = 0; i < header.count; ++i) {
+        SnapshotRecord record, parent;
+        memcpy(&record, records + i * sizeof(SnapshotRecord), sizeof(SnapshotRecord));
+        if (record.parent > i) {
+            throw std::runtime_error("snapshot is corrupted");
+        }
+        memcpy(&parent, records + record.parent * sizeof(SnapshotRecord), sizeof(SnapshotRecord));
+        if (record.key < parent.key) {
+            throw std::runtime_error("snapshot is corrupted");
+        }
+    }
+
+    if (min_node != nullptr) {
+        delete_list(min_node);
+        min_node = nullptr;
+    }
+    count = header.count;
+    Vector<Node*> nodes;
+    for (uint64_t i = 0; i < header.count; ++i) {
+        SnapshotRecord record;
+        memcpy(&record, records + i * sizeof(SnapshotRecord), sizeof(SnapshotRecord));
+        Node *node = NodePool::create(record.key);
+        HEAP_STAT(++counters.allocations);
+        node->mark = record.mark;
+        nodes.push_back(node);
+        if (record.parent == i) {
+            add_node_to_roots(node);
+        }
+        else {
+            attach(nodes[record.parent], node);
+        }
+    }
+}
+
+
+template <class Key, class Storage>
+HeapStats FibonacciHeap<Key, Storage>::stats() const {
+#ifdef HEAP_STATS
+    return counters;
+#else
+    return HeapStats();
+#endif
+}
+
+
+template <class Key, class Storage>
+void FibonacciHeap<Key, Storage>::reset_stats() {
+#ifdef HEAP_STATS
+    counters = HeapStats();
+#endif
+}
+
+
+template <class Key, class Storage>
+MemoryUsage FibonacciHeap<Key, Storage>::memory_usage() const {
+    // nodes are all there is, consolidate's arrays live only during the call
+    MemoryUsage usage(count * NodePool::slot_bytes(), 0, count);
+    usage.table_bytes = NodePool::table_bytes();
+    return usage;
+}
+
+
+
+template <class Key, class Storage>
+template <class... Args>
+FibonacciHeap<Key, Storage>::Node::Node(Args&&... args) : key(std::forward<Args>(args)...) {
     parent = child = prev = next = nullptr;
     degree = 0;
     mark = false;
 }
 
 
-template <class Key>
-void FibonacciHeap<Key>::attach(Node *root, Node *child) {
+template <class Key, class Storage>
+void FibonacciHeap<Key, Storage>::delete_list(Node *start) {
+    // deletes all nodes of the circular list with their subtrees,
+    // trees may be deep after many cuts, so lists to delete are kept on a stack
+    Vector<Node*> lists;
+    lists.push_back(start);
+    while (!lists.is_empty()) {
+        Node *first = lists[lists.size() - 1];
+        lists.pop_back();
+        Node *cur = first;
+        do {
+            Node *next = cur->next;
+            if (cur->child != nullptr) {
+                lists.push_back(cur->child);
+            }
+            NodePool::destroy(cur);
+            cur = next;
+        } while (cur != first);
+    }
+}
+
+
+template <class Key, class Storage>
+template <class Visitor>
+void FibonacciHeap<Key, Storage>::for_each_node(Visitor visit) const {
+    // calls visit(node, index of parent or its own index for roots, own index),
+    // every parent goes before its children; lists wait on a stack as in delete_list
+    if (min_node == nullptr) {
+        return;
+    }
+    Vector<Node*> lists;
+    Vector<uint64_t> parents;
+    lists.push_back(min_node);
+    parents.push_back(0);
+    uint64_t next_index = 0;
+    while (!lists.is_empty()) {
+        Node *first = lists[lists.size() - 1];
+        uint64_t parent = parents[parents.size() - 1];
+        lists.pop_back();
+        parents.pop_back();
+        Node *cur = first;
+        do {
+            uint64_t index = next_index++;
+            visit(cur, first->parent == nullptr ? index : parent, index);
+            if (cur->child != nullptr) {
+                lists.push_back(cur->child);
+                parents.push_back(index);
+            }
+            cur = cur->next;
+        } while (cur != first);
+    }
+}
+
+
+template <class Key, class Storage>
+void FibonacciHeap<Key, Storage>::attach(Node *root, Node *child) {
     // attaches child node to root node
 
     Node *root_child = root->child;
@@ -219,8 +444,8 @@ void FibonacciHeap<Key>::attach(Node *root, Node *child) {
 }
 
 
-template <class Key>
-void FibonacciHeap<Key>::add_node_to_roots(Node *node) {
+template <class Key, class Storage>
+void FibonacciHeap<Key, Storage>::add_node_to_roots(Node *node) {
     // assume node is a root in a tree (parent == null)
     // and we add it to roots list maintaining min_node
 
@@ -232,6 +457,7 @@ void FibonacciHeap<Key>::add_node_to_roots(Node *node) {
         Node *next_node = min_node->next;
         node->next = next_node, node->prev = min_node;
         min_node->next = node, next_node->prev = node;
+        HEAP_STAT(++counters.comparisons);
         if (node->key < min_node->key) {
             min_node = node;
         }
@@ -239,9 +465,10 @@ void FibonacciHeap<Key>::add_node_to_roots(Node *node) {
 }
 
 
-template <class Key>
-void FibonacciHeap<Key>::consolidate(Node *root_node) {
+template <class Key, class Storage>
+void FibonacciHeap<Key, Storage>::consolidate(Node *root_node) {
     // param root_node - arbitrary node in roots list
+    HEAP_STAT(++counters.consolidations);
     Vector<Node*> arr;
     Node *cur = root_node;
     Node *start = cur;
@@ -266,11 +493,13 @@ void FibonacciHeap<Key>::consolidate(Node *root_node) {
         }
         while (con[cur->degree] != nullptr) {
             Node *cur2 = con[cur->degree];
-            if (cur->key > cur2->key) {
+            HEAP_STAT(++counters.comparisons);
+            if (cur2->key < cur->key) {
                 swap(cur, cur2);
             }
             con[cur->degree] = nullptr;
             attach(cur, cur2);
+            HEAP_STAT(++counters.links);
             if (con.size() <= cur->degree) {
                 con.push_back(nullptr);
             }
@@ -285,8 +514,8 @@ void FibonacciHeap<Key>::consolidate(Node *root_node) {
 }
 
 
-template<class Key>
-void FibonacciHeap<Key>::cut(Node *node) {
+template <class Key, class Storage>
+void FibonacciHeap<Key, Storage>::cut(Node *node) {
     Node *par = node->parent;
     --par->degree;
     par->child = nullptr;
@@ -303,8 +532,8 @@ void FibonacciHeap<Key>::cut(Node *node) {
     add_node_to_roots(node);
 }
 
-template<class Key>
-void FibonacciHeap<Key>::cascading_cut(Node *node) {
+template <class Key, class Storage>
+void FibonacciHeap<Key, Storage>::cascading_cut(Node *node) {
     Node *par = node->parent;
     if (par != nullptr) {
         if (!node->mark) {
@@ -312,6 +541,7 @@ void FibonacciHeap<Key>::cascading_cut(Node *node) {
         }
         else {
             cut(node);
+            HEAP_STAT(++counters.cascading_cuts);
             cascading_cut(par);
             //this line was added to make this project unable to build!
         }
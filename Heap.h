@@ -3,57 +3,133 @@
 
 
 #include "Vector.h"
+#include "HeapLayout.h"
+#include "HeapSift.h"
+#include "MappedFile.h"
+#include "NodeStorage.h"
+#include "HeapStats.h"
 #include <cstdlib>
+#include <cstdint>
 #include <cmath>
-
-
-template<class Key>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+
+// Layout decides where children and parent of a node are stored in the array,
+// see HeapLayout.h, Sift picks the minimal child in siftDown, see HeapSift.h,
+// Storage allocates the nodes, see NodeStorage.h
+template<class Key, class Layout = LevelOrderLayout, class Sift = BranchingSift, class Storage = NewDeleteStorage>
 class Heap {
 private:
     class Node;
+    typedef typename Storage::template Pool<Node> NodePool;
 
 public:
 
+    // with SlotMapStorage it stays checkable when its element is removed: using it then throws invalid_argument
     class Pointer {
-        friend Heap<Key>;
+        friend Heap<Key, Layout, Sift, Storage>;
     private:
-        Node *ptr;
+        typename NodePool::Handle handle;
         explicit Pointer(Node *ptr_);
+        Node *node() const;
     public:
         Pointer();
-        Key getKey();
+        const Key &getKey();
     };
 
     Heap();
+    // heap with arity children per node instead of 2
+    explicit Heap(int arity);
 
     template <class Iterator>
     Heap(Iterator begin, Iterator end);
 
+    ~Heap();
+    Heap(const Heap&) = delete;
+    Heap &operator=(const Heap&) = delete;
+
     bool is_empty() const;
-    Pointer insert(Key);
+    Pointer insert(const Key&);
+    Pointer insert(Key&&);
+    // constructs the key in its node from the arguments
+    template <class... Args>
+    Pointer emplace(Args&&... args);
+    // inserts all keys of the range in linear time (bottom-up heapify),
+    // pointers to them are appended to pointers in the same order
+    template <class Iterator>
+    void insert_bulk(Iterator begin, Iterator end, Vector<Pointer> &pointers);
+    // the same with node creation and heapify split between threads,
+    // Iterator must be random access; few keys are simply inserted one by one
+    template <class Iterator>
+    void insert_bulk_parallel(Iterator begin, Iterator end, Vector<Pointer> &pointers, size_t threads);
+    // adds all keys of the range and rebuilds the whole heap in parallel, no pointers are kept
+    template <class Iterator>
+    void build_parallel(Iterator begin, Iterator end, size_t threads);
     void erase(Pointer);
+    // the key is moved out of its node
     Key extract_min();
     void change(Pointer, Key);
-    Key get_min() const;
+    const Key &get_min() const;
     void optimize(size_t, size_t);
+    // moves all nodes of otherHeap here, pointers to them stay valid
     void merge(Heap &otherHeap);
+    // siftDown prefetches array cells this many levels below the children of the current node,
+    // 0 turns prefetching off (default)
+    void set_prefetch_distance(int levels);
+    // turns prefetching on with the distance which suits current arity
+    void enable_prefetch();
+    // writes the arity and the keys in array order, Key must be trivially copyable
+    void save(const std::string &path) const;
+    // replaces the content with a snapshot written by save: new nodes are built in one
+    // sequential pass over the file, no sifting if it was saved with the same Layout and arity
+    void load(const std::string &path);
+    // counters of the operations since construction or reset_stats,
+    // all zeros unless compiled with HEAP_STATS, see HeapStats.h
+    HeapStats stats() const;
+    void reset_stats();
+    // the array of node pointers with its spare capacity and the nodes
+    MemoryUsage memory_usage() const;
 private:
 
     class Node {
-        friend Heap<Key>;
+        friend Heap<Key, Layout, Sift, Storage>;
+        friend Sift;
+        friend NodePool;
     private:
         Key key;
         size_t index;
-        Node(Key key_, size_t index_ = 0);
+        template <class... Args>
+        explicit Node(size_t index_, Args&&... args);
     };
 
     Vector<Node*> nodes;
     // amount of children of vertex
     int k;
+    Layout layout;
+    int prefetch_distance;
+#ifdef HEAP_STATS
+    HeapStats counters;
+
+    HeapStats &counting();
+    size_t children(size_t index) const;
+#endif
 
     void swap_nodes(size_t i, size_t j);
     void siftUp(size_t index);
     void siftDown(size_t index);
+    void prefetch_below(size_t index) const;
+
+    template <class Iterator>
+    void append_parallel(Iterator begin, Iterator end, Vector<Pointer> *pointers, size_t threads);
+    void heapify_parallel(size_t threads);
+    void heapify_subtree(size_t root);
+    template <class Function>
+    static void run_parallel(size_t threads, Function function);
 
     double func_support(double);
     double func_optimized(double, int, int);
@@ -61,47 +137,132 @@ private:
 
 
 
-template <class Key>
-Heap<Key>::Pointer::Pointer() {
-    ptr = nullptr;
-}
+template <class Key, class Layout, class Sift, class Storage>
+Heap<Key, Layout, Sift, Storage>::Pointer::Pointer() {}
+
+
+template <class Key, class Layout, class Sift, class Storage>
+Heap<Key, Layout, Sift, Storage>::Pointer::Pointer(Node *ptr_) : handle(NodePool::handle(ptr_)) {}
 
 
-template <class Key>
-Heap<Key>::Pointer::Pointer(Node *ptr_) {
-    ptr = ptr_;
+template <class Key, class Layout, class Sift, class Storage>
+typename Heap<Key, Layout, Sift, Storage>::Node *Heap<Key, Layout, Sift, Storage>::Pointer::node() const {
+    Node *ptr = NodePool::get(handle);
+    if (ptr == nullptr) {
+        throw std::invalid_argument("Pointer to a removed element");
+    }
+    return ptr;
 }
 
 
-template <class Key>
-Key Heap<Key>::Pointer::getKey() {
-    return ptr->key;
+template <class Key, class Layout, class Sift, class Storage>
+const Key &Heap<Key, Layout, Sift, Storage>::Pointer::getKey() {
+    return node()->key;
 }
 
 
-template <class Key>
-Heap<Key>::Heap() {
+template <class Key, class Layout, class Sift, class Storage>
+Heap<Key, Layout, Sift, Storage>::Heap() {
     k = 2;
+    layout.set_arity(k);
+    prefetch_distance = 0;
 }
 
 
-template <class Key>
-bool Heap<Key>::is_empty() const {
+template <class Key, class Layout, class Sift, class Storage>
+Heap<Key, Layout, Sift, Storage>::Heap(int arity) {
+    if (arity < 2) {
+        throw std::invalid_argument("Heap arity must be at least 2");
+    }
+    k = arity;
+    layout.set_arity(k);
+    prefetch_distance = 0;
+}
+
+
+template <class Key, class Layout, class Sift, class Storage>
+Heap<Key, Layout, Sift, Storage>::~Heap() {
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        NodePool::destroy(nodes[i]);
+    }
+}
+
+
+template <class Key, class Layout, class Sift, class Storage>
+bool Heap<Key, Layout, Sift, Storage>::is_empty() const {
     return nodes.is_empty();
 }
 
 
-template<class Key>
-typename Heap<Key>::Pointer Heap<Key>::insert(Key key) {
-    Node *nw = new Node(key, nodes.size());
+template <class Key, class Layout, class Sift, class Storage>
+typename Heap<Key, Layout, Sift, Storage>::Pointer Heap<Key, Layout, Sift, Storage>::insert(const Key &key) {
+    return emplace(key);
+}
+
+
+template <class Key, class Layout, class Sift, class Storage>
+typename Heap<Key, Layout, Sift, Storage>::Pointer Heap<Key, Layout, Sift, Storage>::insert(Key &&key) {
+    return emplace(std::move(key));
+}
+
+
+template <class Key, class Layout, class Sift, class Storage>
+template <class... Args>
+typename Heap<Key, Layout, Sift, Storage>::Pointer Heap<Key, Layout, Sift, Storage>::emplace(Args&&... args) {
+    Node *nw = NodePool::create(nodes.size(), std::forward<Args>(args)...);
+    HEAP_STAT(++counting().allocations);
     nodes.push_back(nw);
     siftUp(nodes.size() - 1);
     return Pointer(nw);
 }
 
 
-template<class Key>
-Key Heap<Key>::get_min() const {
+template <class Key, class Layout, class Sift, class Storage>
+template <class Iterator>
+void Heap<Key, Layout, Sift, Storage>::insert_bulk(Iterator begin, Iterator end, Vector<Pointer> &pointers) {
+    while (begin != end) {
+        Node *nw = NodePool::create(nodes.size(), *begin);
+        HEAP_STAT(++counting().allocations);
+        nodes.push_back(nw);
+        pointers.push_back(Pointer(nw));
+        ++begin;
+    }
+    // children are always after their parent, so going from the end
+    // every siftDown starts above two heaps (works for any layout)
+    for (size_t i = nodes.size(); i-- > 0; ) {
+        siftDown(i);
+    }
+}
+
+
+template <class Key, class Layout, class Sift, class Storage>
+template <class Iterator>
+void Heap<Key, Layout, Sift, Storage>::insert_bulk_parallel(Iterator begin, Iterator end, Vector<Pointer> &pointers,
+                                                   size_t threads) {
+    // m siftUps cost about m * log(n) against n + m for a new heapify
+    size_t m = end - begin, n = nodes.size();
+    if (m * (size_t)log2((double)(n + m) + 1) < n + m) {
+        while (begin != end) {
+            pointers.push_back(insert(*begin));
+            ++begin;
+        }
+        return;
+    }
+    append_parallel(begin, end, &pointers, threads);
+    heapify_parallel(threads);
+}
+
+
+template <class Key, class Layout, class Sift, class Storage>
+template <class Iterator>
+void Heap<Key, Layout, Sift, Storage>::build_parallel(Iterator begin, Iterator end, size_t threads) {
+    append_parallel(begin, end, nullptr, threads);
+    heapify_parallel(threads);
+}
+
+
+template <class Key, class Layout, class Sift, class Storage>
+const Key &Heap<Key, Layout, Sift, Storage>::get_min() const {
     if (is_empty()) {
         throw std::logic_error("Heap instance is empty");
     }
@@ -109,16 +270,16 @@ Key Heap<Key>::get_min() const {
 }
 
 
-template<class Key>
-Key Heap<Key>::extract_min() {
+template <class Key, class Layout, class Sift, class Storage>
+Key Heap<Key, Layout, Sift, Storage>::extract_min() {
     if (is_empty()) {
         throw std::logic_error("Heap instance is empty");
     }
 
-    Key return_value = nodes[0]->key;
+    Key return_value = std::move(nodes[0]->key);
 
     swap_nodes(0, nodes.size() - 1);
-    delete nodes[nodes.size() - 1];
+    NodePool::destroy(nodes[nodes.size() - 1]);
     nodes.pop_back();
     siftDown(0);
 
@@ -126,40 +287,48 @@ Key Heap<Key>::extract_min() {
 }
 
 
-template <class Key>
-void Heap<Key>::erase(Heap<Key>::Pointer ptr) {
-    size_t index = ptr.ptr->index;
+template <class Key, class Layout, class Sift, class Storage>
+void Heap<Key, Layout, Sift, Storage>::erase(Pointer ptr) {
+    Node *node = ptr.node();
+    size_t index = node->index;
     swap_nodes(index, nodes.size() - 1);
     nodes.pop_back();
-    // even if index is out of range now we can use siftDown - it will do nothing in this case
-    siftDown(index);
+    NodePool::destroy(node);
+    // the last node moved to index may be smaller than its new parent as well as bigger than its children
+    if (index < nodes.size()) {
+        siftUp(index);
+        siftDown(index);
+    }
 }
 
 
-template <class Key>
-void Heap<Key>::change(Pointer ptr, Key key) {
-    ptr.ptr->key = key;
-    siftUp(ptr.ptr->index);
-    siftDown(ptr.ptr->index);
+template <class Key, class Layout, class Sift, class Storage>
+void Heap<Key, Layout, Sift, Storage>::change(Pointer ptr, Key key) {
+    Node *node = ptr.node();
+    node->key = std::move(key);
+    siftUp(node->index);
+    siftDown(node->index);
 }
 
 
-template <class Key>
+template <class Key, class Layout, class Sift, class Storage>
 template<class Iterator>
-Heap<Key>::Heap(Iterator begin, Iterator end) {
-    Heap<Key>();
+Heap<Key, Layout, Sift, Storage>::Heap(Iterator begin, Iterator end) {
+    k = 2;
+    layout.set_arity(k);
+    prefetch_distance = 0;
     while (begin != end) {
         insert(*begin);
         ++begin;
     }
-    k = 2;
 }
 
 
-template <class Key>
-void Heap<Key>::optimize(size_t insertCount, size_t extractCount) {
+template <class Key, class Layout, class Sift, class Storage>
+void Heap<Key, Layout, Sift, Storage>::optimize(size_t insertCount, size_t extractCount) {
     if (extractCount == 0) {
         k = insertCount + 10;
+        layout.set_arity(k);
         return;
     }
 
@@ -194,72 +363,381 @@ void Heap<Key>::optimize(size_t insertCount, size_t extractCount) {
     }
 
     k = best_x;
+    layout.set_arity(k);
+}
+
+
+template <class Key, class Layout, class Sift, class Storage>
+void Heap<Key, Layout, Sift, Storage>::set_prefetch_distance(int levels) {
+    prefetch_distance = levels;
+}
+
+
+template <class Key, class Layout, class Sift, class Storage>
+void Heap<Key, Layout, Sift, Storage>::enable_prefetch() {
+    // one level below children is k^2 nodes, two levels is k^3 cache lines more,
+    // which is only worth it for small arities
+    if (k <= 4) {
+        prefetch_distance = 2;
+    }
+    else if (k <= 16) {
+        prefetch_distance = 1;
+    }
+    else {
+        prefetch_distance = 0;
+    }
+}
+
+
+template <class Key, class Layout, class Sift, class Storage>
+void Heap<Key, Layout, Sift, Storage>::save(const std::string &path) const {
+    static_assert(std::is_trivially_copyable<Key>::value, "snapshots store raw bytes of keys");
+    SnapshotWriter writer(path, "HEAPSNP1", sizeof(Key), (uint32_t)k, nodes.size());
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        writer.write(nodes[i]->key);
+    }
+    writer.close();
+}
+
+
+template <class Key, class Layout, class Sift, class Storage>
+void Heap<Key, Layout, Sift, Storage>::load(const std::string &path) {
+    static_assert(std::is_trivially_copyable<Key>::value, "snapshots store raw bytes of keys");
+    MappedFile file(path);
+    SnapshotHeader header;
+    const char *records = snapshot_records(file, "HEAPSNP1", sizeof(Key), sizeof(Key), header);
+    if (header.parameter < 2) {
+        throw std::runtime_error("snapshot is corrupted");
+    }
+
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        NodePool::destroy(nodes[i]);
+    }
+    nodes.clear();
+    k = header.parameter;
+    layout.set_arity(k);
+    bool is_heap = true;
+    for (size_t i = 0; i < header.count; ++i) {
+        Key key;
+        memcpy(&key, records + i * sizeof(Key), sizeof(Key));
+        nodes.push_back(NodePool::create(i, key));
+        HEAP_STAT(++counting().allocations);
+        // checked on the keys of the mapped file, which are contiguous, not through nodes
+        if (i > 0 && is_heap) {
+            Key parent_key;
+            memcpy(&parent_key, records + layout.parent(i) * sizeof(Key), sizeof(Key));
+            is_heap = !(key < parent_key);
+        }
+    }
+    // only a snapshot of a heap with another Layout has to be heapified
+    if (!is_heap) {
+        for (size_t i = nodes.size(); i-- > 0; ) {
+            siftDown(i);
+        }
+    }
 }
 
 
-template <class Key>
-void Heap<Key>::merge(Heap<Key> &otherHeap) {
-    for (int i = 0; i < otherHeap.nodes.size(); ++i) {
-        insert(otherHeap.nodes[i]->key);
+template <class Key, class Layout, class Sift, class Storage>
+HeapStats Heap<Key, Layout, Sift, Storage>::stats() const {
+#ifdef HEAP_STATS
+    return counters;
+#else
+    return HeapStats();
+#endif
+}
+
+
+template <class Key, class Layout, class Sift, class Storage>
+void Heap<Key, Layout, Sift, Storage>::reset_stats() {
+#ifdef HEAP_STATS
+    counters = HeapStats();
+#endif
+}
+
+
+template <class Key, class Layout, class Sift, class Storage>
+MemoryUsage Heap<Key, Layout, Sift, Storage>::memory_usage() const {
+    MemoryUsage usage = nodes.memory_usage();
+    usage.live_bytes += nodes.size() * NodePool::slot_bytes();
+    usage.table_bytes = NodePool::table_bytes();
+    return usage;
+}
+
+
+template <class Key, class Layout, class Sift, class Storage>
+void Heap<Key, Layout, Sift, Storage>::merge(Heap &otherHeap) {
+    // the same choice as in insert_bulk_parallel: m siftUps or a new heapify of n + m nodes
+    size_t m = otherHeap.nodes.size(), n = nodes.size();
+    if (m == 0) {
+        return;
+    }
+    bool heapify = m * (size_t)log2((double)(n + m) + 1) >= n + m;
+    for (size_t i = 0; i < m; ++i) {
+        Node *node = otherHeap.nodes[i];
+        node->index = nodes.size();
+        nodes.push_back(node);
+        if (!heapify) {
+            siftUp(node->index);
+        }
     }
     otherHeap.nodes.clear();
+    if (heapify) {
+        for (size_t i = nodes.size(); i-- > 0; ) {
+            siftDown(i);
+        }
+    }
 }
 
 
 
-template<class Key>
-Heap<Key>::Node::Node(Key key_, size_t index_) {
-    key = key_;
+template <class Key, class Layout, class Sift, class Storage>
+template <class... Args>
+Heap<Key, Layout, Sift, Storage>::Node::Node(size_t index_, Args&&... args) : key(std::forward<Args>(args)...) {
     index = index_;
 }
 
 
-template <class Key>
-void Heap<Key>::swap_nodes(size_t i, size_t j) {
+#ifdef HEAP_STATS
+template <class Key, class Layout, class Sift, class Storage>
+HeapStats &Heap<Key, Layout, Sift, Storage>::counting() {
+    HeapStats *target = HeapStats::thread_target();
+    return target == nullptr ? counters : *target;
+}
+
+
+template <class Key, class Layout, class Sift, class Storage>
+size_t Heap<Key, Layout, Sift, Storage>::children(size_t index) const {
+    size_t count = 0;
+    for (int j = 0; j < k; ++j) {
+        count += layout.child(index, j) < nodes.size() ? 1 : 0;
+    }
+    return count;
+}
+#endif
+
+
+template <class Key, class Layout, class Sift, class Storage>
+void Heap<Key, Layout, Sift, Storage>::swap_nodes(size_t i, size_t j) {
+    HEAP_STAT(++counting().swaps);
     nodes[i]->index = j;
     nodes[j]->index = i;
     swap(nodes[i], nodes[j]);
 }
 
 
-template <class Key>
-void Heap<Key>::siftUp(size_t index) {
-    while (index > 0 && nodes[index]->key < nodes[(index - 1) / k]->key) {
-        swap_nodes(index, (index - 1) / k);
-        index = (index - 1) / k;
+template <class Key, class Layout, class Sift, class Storage>
+void Heap<Key, Layout, Sift, Storage>::siftUp(size_t index) {
+    while (index > 0 && (HEAP_STAT(++counting().comparisons),
+                         nodes[index]->key < nodes[layout.parent(index)]->key)) {
+        size_t parent = layout.parent(index);
+        swap_nodes(index, parent);
+        HEAP_STAT(counting().sift_step());
+        index = parent;
     }
+    HEAP_STAT(counting().sift_done());
 }
 
 
-template<class Key>
-void Heap<Key>::siftDown(size_t index) {
-    while (index * k + 1 < nodes.size()) {
-        size_t min_id = index * k + 1;
-        for (int i = 2; i <= k; ++i) {
-            if (index * k + i < nodes.size() && nodes[index * k + i]->key < nodes[min_id]->key) {
-                min_id = index * k + i;
-            }
+template <class Key, class Layout, class Sift, class Storage>
+void Heap<Key, Layout, Sift, Storage>::siftDown(size_t index) {
+    while (layout.child(index, 0) < nodes.size()) {
+        if (prefetch_distance > 0) {
+            prefetch_below(index);
         }
+        size_t min_id = Sift::min_child(nodes, layout, index, k);
+        // the children among themselves and the minimal one with index
+        HEAP_STAT(counting().comparisons += children(index));
 
         if (nodes[min_id]->key < nodes[index]->key) {
             swap_nodes(min_id, index);
+            HEAP_STAT(counting().sift_step());
             index = min_id;
         }
         else {
             break;
         }
     }
+    HEAP_STAT(counting().sift_done());
+}
+
+
+template <class Key, class Layout, class Sift, class Storage>
+void Heap<Key, Layout, Sift, Storage>::prefetch_below(size_t index) const {
+    // while children of index are compared, one of them becomes the next index:
+    // fetch the cache lines of the grandchildren's cells, and with distance > 1 also cells
+    // further down. Only addresses are taken, reading a cell here would wait for the very miss
+    // the prefetch has to hide; siblings are mostly in one line, which is fetched once
+    for (int i = 0; i < k; ++i) {
+        size_t child = layout.child(index, i);
+        if (child >= nodes.size() || layout.child(child, 0) >= nodes.size()) {
+            break;
+        }
+        uintptr_t last_line = 0;
+        for (int j = 0; j < k; ++j) {
+            size_t grandchild = layout.child(child, j);
+            if (grandchild >= nodes.size()) {
+                break;
+            }
+            uintptr_t line = (uintptr_t)&nodes[grandchild] / 64;
+            if (line != last_line) {
+                __builtin_prefetch(&nodes[grandchild]);
+                last_line = line;
+            }
+        }
+        size_t cell = layout.child(child, 0);
+        for (int level = 1; level < prefetch_distance; ++level) {
+            cell = layout.child(cell, 0);
+        }
+        if (prefetch_distance > 1 && cell < nodes.size()) {
+            __builtin_prefetch(&nodes[cell]);
+        }
+    }
+}
+
+
+template <class Key, class Layout, class Sift, class Storage>
+template <class Iterator>
+void Heap<Key, Layout, Sift, Storage>::append_parallel(Iterator begin, Iterator end, Vector<Pointer> *pointers,
+                                              size_t threads) {
+    size_t start = nodes.size(), m = end - begin;
+    size_t pointers_start = pointers == nullptr ? 0 : pointers->size();
+    for (size_t i = 0; i < m; ++i) {
+        nodes.push_back(nullptr);
+        if (pointers != nullptr) {
+            pointers->push_back(Pointer());
+        }
+    }
+    // every thread allocates the nodes of its own part
+    run_parallel(threads, [&](size_t thread) {
+        size_t from = m * thread / threads, to = m * (thread + 1) / threads;
+        for (size_t i = from; i < to; ++i) {
+            Node *nw = NodePool::create(start + i, *(begin + i));
+            nodes[start + i] = nw;
+            if (pointers != nullptr) {
+                (*pointers)[pointers_start + i] = Pointer(nw);
+            }
+        }
+    });
+    HEAP_STAT(counting().allocations += m);
+}
+
+
+template <class Key, class Layout, class Sift, class Storage>
+void Heap<Key, Layout, Sift, Storage>::heapify_parallel(size_t threads) {
+    // subtrees rooted at one level are independent: the first level with
+    // enough roots for all threads is split between them, the levels above are done after
+    size_t n = nodes.size();
+    if (n == 0) {
+        return;
+    }
+    Vector<size_t> top, level, next;
+    level.push_back(0);
+    while (level.size() < 8 * threads) {
+        next.clear();
+        for (size_t i = 0; i < level.size(); ++i) {
+            for (int j = 0; j < k; ++j) {
+                size_t child = layout.child(level[i], j);
+                if (child >= n) {
+                    break;
+                }
+                next.push_back(child);
+            }
+        }
+        if (next.is_empty()) {
+            break;
+        }
+        level.clear();
+        for (size_t i = 0; i < next.size(); ++i) {
+            top.push_back(next[i]);
+            level.push_back(next[i]);
+        }
+    }
+    // top holds the levels below the root down to the split level, which is at the end of it
+    if (level[0] != 0) {
+        for (size_t i = 0; i < level.size(); ++i) {
+            top.pop_back();
+        }
+    }
+
+    std::atomic<size_t> next_root(0);
+#ifdef HEAP_STATS
+    std::vector<HeapStats> thread_counters(max(threads, (size_t)1));
+#endif
+    run_parallel(threads, [&](size_t thread) {
+        // only the counters tell threads apart
+        (void)thread;
+        HEAP_STAT(HeapStats::thread_target() = &thread_counters[thread]);
+        for (size_t i = next_root++; i < level.size(); i = next_root++) {
+            heapify_subtree(level[i]);
+        }
+        HEAP_STAT(HeapStats::thread_target() = nullptr);
+    });
+#ifdef HEAP_STATS
+    for (size_t i = 0; i < thread_counters.size(); ++i) {
+        counters.add(thread_counters[i]);
+    }
+#endif
+    // parents are above their children in top, as it was filled level by level
+    for (size_t i = top.size(); i-- > 0; ) {
+        siftDown(top[i]);
+    }
+    if (level[0] != 0) {
+        siftDown(0);
+    }
+}
+
+
+template <class Key, class Layout, class Sift, class Storage>
+void Heap<Key, Layout, Sift, Storage>::heapify_subtree(size_t root) {
+    // Floyd's construction in post-order, so every siftDown starts above two heaps,
+    // the stack keeps the path from root and the next child to visit on it
+    Vector<size_t> path;
+    Vector<int> next_child;
+    path.push_back(root);
+    next_child.push_back(0);
+    while (!path.is_empty()) {
+        size_t index = path[path.size() - 1];
+        int j = next_child[next_child.size() - 1];
+        size_t child = layout.child(index, j);
+        if (j < k && child < nodes.size()) {
+            ++next_child[next_child.size() - 1];
+            path.push_back(child);
+            next_child.push_back(0);
+        }
+        else {
+            siftDown(index);
+            path.pop_back();
+            next_child.pop_back();
+        }
+    }
+}
+
+
+template <class Key, class Layout, class Sift, class Storage>
+template <class Function>
+void Heap<Key, Layout, Sift, Storage>::run_parallel(size_t threads, Function function) {
+    // calls function(0), ..., function(threads - 1), the last one in this thread
+    threads = max(threads, (size_t)1);
+    std::vector<std::thread> workers;
+    for (size_t thread = 0; thread + 1 < threads; ++thread) {
+        workers.push_back(std::thread(function, thread));
+    }
+    function(threads - 1);
+    for (size_t i = 0; i < workers.size(); ++i) {
+        workers[i].join();
+    }
 }
 
 
-template <class Key>
-double Heap<Key>::func_optimized(double x, int a, int b) {
+template <class Key, class Layout, class Sift, class Storage>
+double Heap<Key, Layout, Sift, Storage>::func_optimized(double x, int a, int b) {
     return a / log(x) + b * x / log(x);
 }
 
 
-template<class Key>
-double Heap<Key>::func_support(double x) {
+template <class Key, class Layout, class Sift, class Storage>
+double Heap<Key, Layout, Sift, Storage>::func_support(double x) {
     return x * (log(x) - 1);
 }
 
@@ -0,0 +1,119 @@
+#ifndef HEAP_HEAPLAYOUT_H
+#define HEAP_HEAPLAYOUT_H
+
+
+#include <cstdlib>
+
+
+// Layouts tell Heap where the parent and the children of a node are stored.
+// set_arity is called whenever the arity of the heap changes,
+// parent(i) < i must hold, so that every prefix of the array is a tree.
+
+
+// Classic level by level layout: children of i are i * k + 1, ..., i * k + k
+class LevelOrderLayout {
+public:
+    LevelOrderLayout();
+
+    void set_arity(int k);
+    size_t parent(size_t i) const;
+    // j-th child, 0 <= j < k
+    size_t child(size_t i, int j) const;
+
+private:
+    size_t k;
+};
+
+
+// B-heap layout: the array is cut into pages of PageBytes bytes, each page holds
+// a complete k-ary subtree of height h. Children of the bottom level of a page
+// are roots of other pages, which form a k^h-ary tree laid out level by level.
+// Pages are filled one after another, so the array cells of a root-to-leaf path are in
+// O(log n / log(PageBytes)) pages instead of O(log n) for LevelOrderLayout.
+// Heap keeps node pointers in the array, and every comparison still reads a node
+// allocated elsewhere, so only the accesses to the array itself get this locality.
+template <size_t PageBytes = 4096>
+class BlockedLayout {
+public:
+    BlockedLayout();
+
+    void set_arity(int k);
+    size_t parent(size_t i) const;
+    size_t child(size_t i, int j) const;
+
+private:
+    size_t k;
+    // nodes in one page, first node of the bottom level of a page, children pages of a page
+    size_t page_size, first_leaf, page_arity;
+};
+
+
+
+inline LevelOrderLayout::LevelOrderLayout() {
+    k = 2;
+}
+
+
+inline void LevelOrderLayout::set_arity(int k_) {
+    k = k_;
+}
+
+
+inline size_t LevelOrderLayout::parent(size_t i) const {
+    return (i - 1) / k;
+}
+
+
+inline size_t LevelOrderLayout::child(size_t i, int j) const {
+    return i * k + 1 + j;
+}
+
+
+
+template <size_t PageBytes>
+BlockedLayout<PageBytes>::BlockedLayout() {
+    set_arity(2);
+}
+
+
+template <size_t PageBytes>
+void BlockedLayout<PageBytes>::set_arity(int k_) {
+    k = k_;
+    // heap stores one pointer per node
+    size_t capacity = PageBytes / sizeof(void*);
+    size_t level_size = 1;
+    page_size = 1;
+    first_leaf = 0;
+    while (page_size + level_size * k <= capacity) {
+        first_leaf = page_size;
+        level_size *= k;
+        page_size += level_size;
+    }
+    page_arity = level_size * k;
+}
+
+
+template <size_t PageBytes>
+size_t BlockedLayout<PageBytes>::parent(size_t i) const {
+    size_t page = i / page_size, offset = i % page_size;
+    if (offset > 0) {
+        return page * page_size + (offset - 1) / k;
+    }
+    size_t parent_page = (page - 1) / page_arity;
+    size_t leaf = ((page - 1) % page_arity) / k;
+    return parent_page * page_size + first_leaf + leaf;
+}
+
+
+template <size_t PageBytes>
+size_t BlockedLayout<PageBytes>::child(size_t i, int j) const {
+    size_t page = i / page_size, offset = i % page_size;
+    if (offset < first_leaf) {
+        return page * page_size + offset * k + 1 + j;
+    }
+    size_t leaf = offset - first_leaf;
+    return (page * page_arity + 1 + leaf * k + j) * page_size;
+}
+
+
+#endif //HEAP_HEAPLAYOUT_H
@@ -0,0 +1,73 @@
+#ifndef HEAP_HEAPSIFT_H
+#define HEAP_HEAPSIFT_H
+
+
+#include "Vector.h"
+#include <cstdlib>
+
+
+// Sift policies choose the minimal child in Heap::siftDown.
+// min_child is called only when the first child of index exists.
+
+
+// Compares children one by one with a bounds check and a branch per child
+class BranchingSift {
+public:
+    template <class Node, class Layout>
+    static size_t min_child(const Vector<Node*> &nodes, const Layout &layout, size_t index, int k);
+};
+
+
+// When all k children exist and lie in consecutive cells (every node except
+// the last parent in LevelOrderLayout, most nodes in BlockedLayout) there is no
+// bounds check and the minimum is selected with conditional moves instead of
+// branches, which are mispredicted about half of the time on random keys.
+class BranchlessSift {
+public:
+    template <class Node, class Layout>
+    static size_t min_child(const Vector<Node*> &nodes, const Layout &layout, size_t index, int k);
+};
+
+
+
+template <class Node, class Layout>
+size_t BranchingSift::min_child(const Vector<Node*> &nodes, const Layout &layout, size_t index, int k) {
+    size_t min_id = layout.child(index, 0);
+    for (int i = 1; i < k; ++i) {
+        size_t child = layout.child(index, i);
+        if (child < nodes.size() && nodes[child]->key < nodes[min_id]->key) {
+            min_id = child;
+        }
+    }
+    return min_id;
+}
+
+
+template <class Node, class Layout>
+size_t BranchlessSift::min_child(const Vector<Node*> &nodes, const Layout &layout, size_t index, int k) {
+    size_t first = layout.child(index, 0);
+    size_t last = layout.child(index, k - 1);
+    if (last >= nodes.size() || last - first != (size_t)(k - 1)) {
+        size_t min_id = first;
+        for (int i = 1; i < k; ++i) {
+            size_t child = layout.child(index, i);
+            if (child < nodes.size() && nodes[child]->key < nodes[min_id]->key) {
+                min_id = child;
+            }
+        }
+        return min_id;
+    }
+
+    Node *const *cells = &nodes[first];
+    size_t min_id = 0;
+    Node *min_node = cells[0];
+    for (int i = 1; i < k; ++i) {
+        bool less = cells[i]->key < min_node->key;
+        min_id = less ? i : min_id;
+        min_node = less ? cells[i] : min_node;
+    }
+    return first + min_id;
+}
+
+
+#endif //HEAP_HEAPSIFT_H
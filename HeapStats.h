@@ -0,0 +1,107 @@
+#ifndef HEAP_HEAPSTATS_H
+#define HEAP_HEAPSTATS_H
+
+
+#include <cstdlib>
+#include <cstring>
+
+
+// Operation counters of Heap, BinomialHeap and FibonacciHeap, read with their stats().
+// They are compiled in only with HEAP_STATS defined (cmake -DHEAP_STATS=ON):
+// otherwise heaps don't even have the counters, HEAP_STAT drops its argument
+// and stats() returns zeros. Counters which make no sense for an engine stay 0.
+#ifdef HEAP_STATS
+#define HEAP_STAT(expression) (expression)
+#else
+#define HEAP_STAT(expression) ((void)0)
+#endif
+
+
+struct HeapStats {
+    static const int DEPTHS = 32;
+
+    // key comparisons made by the heap itself
+    unsigned long long comparisons;
+    // exchanges of a node with its parent or child (Heap, BinomialHeap)
+    unsigned long long swaps;
+    unsigned long long allocations;
+    // one tree root attached under another (BinomialHeap, FibonacciHeap)
+    unsigned long long links;
+    // FibonacciHeap::consolidate calls
+    unsigned long long consolidations;
+    // cuts of marked parents made by FibonacciHeap::cascading_cut
+    unsigned long long cascading_cuts;
+    // trees carried to the next order while adding BinomialHeap root lists
+    unsigned long long carries;
+    // sift_depths[d] is the number of sifts which moved a node d levels,
+    // the last one counts all deeper sifts
+    unsigned long long sift_depths[DEPTHS];
+
+    HeapStats();
+    // true if heaps are compiled with counters
+    static bool enabled();
+
+    // adds the counts of other to these
+    void add(const HeapStats &other);
+    void sift_step();
+    void sift_done();
+
+    // while it isn't null, heaps count into it instead of their own counters in this thread:
+    // threads of a parallel build count separately and their counts are added after
+    static HeapStats *&thread_target();
+
+private:
+    // levels moved by the sift which is in progress
+    int current_depth;
+};
+
+
+
+inline HeapStats::HeapStats() {
+    comparisons = swaps = allocations = links = consolidations = cascading_cuts = carries = 0;
+    memset(sift_depths, 0, sizeof(sift_depths));
+    current_depth = 0;
+}
+
+
+inline bool HeapStats::enabled() {
+#ifdef HEAP_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+inline void HeapStats::add(const HeapStats &other) {
+    comparisons += other.comparisons;
+    swaps += other.swaps;
+    allocations += other.allocations;
+    links += other.links;
+    consolidations += other.consolidations;
+    cascading_cuts += other.cascading_cuts;
+    carries += other.carries;
+    for (int i = 0; i < DEPTHS; ++i) {
+        sift_depths[i] += other.sift_depths[i];
+    }
+}
+
+
+inline void HeapStats::sift_step() {
+    ++current_depth;
+}
+
+
+inline void HeapStats::sift_done() {
+    ++sift_depths[current_depth < DEPTHS ? current_depth : DEPTHS - 1];
+    current_depth = 0;
+}
+
+
+inline HeapStats *&HeapStats::thread_target() {
+    static thread_local HeapStats *target = nullptr;
+    return target;
+}
+
+
+#endif //HEAP_HEAPSTATS_H
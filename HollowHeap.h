@@ -0,0 +1,353 @@
+#ifndef HEAP_HOLLOWHEAP_H
+#define HEAP_HOLLOWHEAP_H
+
+
+#include "Vector.h"
+#include "NodeStorage.h"
+#include <cstdlib>
+#include <stdexcept>
+
+
+// Hollow heap (Hansen, Kaplan, Tarjan, Zwick), one-tree version.
+// decrease doesn't cut anything: it moves the item into a new node and leaves
+// the old one hollow, hollow nodes are destroyed lazily by extract_min/erase.
+template <class Key, class Storage = NewDeleteStorage>
+class HollowHeap {
+private:
+    class Node;
+    class Item;
+    typedef typename Storage::template Pool<Item> ItemPool;
+
+public:
+    // with SlotMapStorage it stays checkable when its element is removed: using it then throws invalid_argument
+    class Pointer {
+        friend HollowHeap<Key, Storage>;
+    private:
+        typename ItemPool::Handle handle;
+        explicit Pointer(Item *ptr_);
+        Item *node() const;
+    public:
+        Pointer();
+        Key getKey();
+    };
+
+    HollowHeap();
+    ~HollowHeap();
+    HollowHeap(const HollowHeap&) = delete;
+    HollowHeap &operator=(const HollowHeap&) = delete;
+
+    bool is_empty() const;
+    Pointer insert(Key);
+    Key get_min() const;
+    Key extract_min();
+    void merge(HollowHeap&);
+    void decrease(Pointer, Key);
+    void erase(Pointer);
+    // items and nodes, hollow nodes are slack
+    MemoryUsage memory_usage() const;
+
+private:
+    // Item is what Pointer refers to, it stays in place while its node changes
+    class Item {
+        friend HollowHeap<Key, Storage>;
+        friend ItemPool;
+    private:
+        Node *node;
+        Item();
+    };
+
+    class Node {
+        friend HollowHeap<Key, Storage>;
+    private:
+        Key key;
+        // item == nullptr means the node is hollow
+        Item *item;
+        // extra_parent is set only for the hollow node left by decrease,
+        // it is the second parent of the node, and the node is the last child there
+        Node *child, *next, *extra_parent;
+        size_t rank;
+        Node(Key, Item*);
+    };
+
+    Node *root;
+    // only for memory_usage: nodes are more than items by the hollow ones
+    size_t item_count, node_count;
+
+    Node *link(Node*, Node*);
+    Node *meld(Node*, Node*);
+    void add_child(Node *child, Node *parent);
+    void do_ranked_links(Vector<Node*>&, Node*);
+};
+
+
+
+template <class Key, class Storage>
+HollowHeap<Key, Storage>::Pointer::Pointer() {}
+
+
+template <class Key, class Storage>
+HollowHeap<Key, Storage>::Pointer::Pointer(Item *ptr_) : handle(ItemPool::handle(ptr_)) {}
+
+
+template <class Key, class Storage>
+typename HollowHeap<Key, Storage>::Item *HollowHeap<Key, Storage>::Pointer::node() const {
+    Item *ptr = ItemPool::get(handle);
+    if (ptr == nullptr) {
+        throw std::invalid_argument("Pointer to a removed element");
+    }
+    return ptr;
+}
+
+
+template <class Key, class Storage>
+Key HollowHeap<Key, Storage>::Pointer::getKey() {
+    return node()->node->key;
+}
+
+
+
+template <class Key, class Storage>
+HollowHeap<Key, Storage>::HollowHeap() {
+    root = nullptr;
+    item_count = node_count = 0;
+}
+
+
+template <class Key, class Storage>
+HollowHeap<Key, Storage>::~HollowHeap() {
+    if (root == nullptr) {
+        return;
+    }
+    // a node with extra_parent is in two child lists, it is taken from its first parent's one,
+    // in the extra parent's list it is the last child and the rest belongs to the other list.
+    // Both lists are walked, so nothing is freed before every node is found.
+    Vector<Node*> found;
+    found.push_back(root);
+    for (size_t i = 0; i < found.size(); ++i) {
+        Node *parent = found[i];
+        for (Node *u = parent->child; u != nullptr && u->extra_parent != parent; u = u->next) {
+            found.push_back(u);
+        }
+    }
+    for (size_t i = 0; i < found.size(); ++i) {
+        if (found[i]->item != nullptr) {
+            ItemPool::destroy(found[i]->item);
+        }
+        delete found[i];
+    }
+}
+
+
+template <class Key, class Storage>
+bool HollowHeap<Key, Storage>::is_empty() const {
+    return root == nullptr;
+}
+
+
+template <class Key, class Storage>
+typename HollowHeap<Key, Storage>::Pointer HollowHeap<Key, Storage>::insert(Key key) {
+    Item *item = ItemPool::create();
+    item->node = new Node(key, item);
+    ++item_count;
+    ++node_count;
+    root = meld(item->node, root);
+    return Pointer(item);
+}
+
+
+template <class Key, class Storage>
+Key HollowHeap<Key, Storage>::get_min() const {
+    if (is_empty()) {
+        throw std::logic_error("HollowHeap instance is empty");
+    }
+    return root->key;
+}
+
+
+template <class Key, class Storage>
+Key HollowHeap<Key, Storage>::extract_min() {
+    if (is_empty()) {
+        throw std::logic_error("HollowHeap instance is empty");
+    }
+    Key ret = root->key;
+    erase(Pointer(root->item));
+    return ret;
+}
+
+
+template <class Key, class Storage>
+void HollowHeap<Key, Storage>::merge(HollowHeap &otherHeap) {
+    root = meld(root, otherHeap.root);
+    otherHeap.root = nullptr;
+    item_count += otherHeap.item_count;
+    node_count += otherHeap.node_count;
+    otherHeap.item_count = otherHeap.node_count = 0;
+}
+
+
+template <class Key, class Storage>
+void HollowHeap<Key, Storage>::decrease(Pointer ptr, Key key) {
+    Item *item = ptr.node();
+    Node *u = item->node;
+    if (u->key < key) {
+        throw std::invalid_argument("Decrease new value is bigger than current value");
+    }
+
+    if (u == root) {
+        u->key = key;
+        return;
+    }
+
+    // u becomes hollow and stays where it is, the item moves to a new node v
+    // which gets u as its only child (u keeps its place in the old parent's list)
+    Node *v = new Node(key, item);
+    ++node_count;
+    item->node = v;
+    u->item = nullptr;
+    if (u->rank > 2) {
+        v->rank = u->rank - 2;
+    }
+    v->child = u;
+    u->extra_parent = v;
+    root = link(v, root);
+}
+
+
+template <class Key, class Storage>
+void HollowHeap<Key, Storage>::erase(Pointer ptr) {
+    if (is_empty()) {
+        throw std::logic_error("HollowHeap instance is empty");
+    }
+
+    Item *item = ptr.node();
+    item->node->item = nullptr;
+    item->node = nullptr;
+    ItemPool::destroy(item);
+    --item_count;
+
+    if (root->item != nullptr) {
+        // deleted node is not the root, it just stays hollow
+        return;
+    }
+
+    // root is hollow now: destroy it and all hollow nodes which lost their
+    // last parent, other nodes are linked by rank and then into one tree
+    Vector<Node*> by_rank;
+    Node *hollow = root;
+    hollow->next = nullptr;
+    root = nullptr;
+    while (hollow != nullptr) {
+        Node *cur = hollow->child;
+        Node *parent = hollow;
+        hollow = hollow->next;
+        while (cur != nullptr) {
+            Node *u = cur;
+            cur = cur->next;
+            if (u->item == nullptr) {
+                if (u->extra_parent == nullptr) {
+                    u->next = hollow;
+                    hollow = u;
+                }
+                else {
+                    if (u->extra_parent == parent) {
+                        // u is the last child of its extra parent,
+                        // the rest of the list belongs to the other parent
+                        cur = nullptr;
+                    }
+                    else {
+                        u->next = nullptr;
+                    }
+                    u->extra_parent = nullptr;
+                }
+            }
+            else {
+                do_ranked_links(by_rank, u);
+            }
+        }
+        delete parent;
+        --node_count;
+    }
+
+    for (size_t i = 0; i < by_rank.size(); ++i) {
+        if (by_rank[i] != nullptr) {
+            root = meld(root, by_rank[i]);
+        }
+    }
+}
+
+
+
+template <class Key, class Storage>
+MemoryUsage HollowHeap<Key, Storage>::memory_usage() const {
+    MemoryUsage usage(item_count * ItemPool::slot_bytes() + node_count * sizeof(Node),
+                      (node_count - item_count) * sizeof(Node), item_count);
+    usage.table_bytes = ItemPool::table_bytes();
+    return usage;
+}
+
+
+
+template <class Key, class Storage>
+HollowHeap<Key, Storage>::Item::Item() {
+    node = nullptr;
+}
+
+
+template <class Key, class Storage>
+HollowHeap<Key, Storage>::Node::Node(Key key_, Item *item_) {
+    key = key_;
+    item = item_;
+    child = next = extra_parent = nullptr;
+    rank = 0;
+}
+
+
+template <class Key, class Storage>
+void HollowHeap<Key, Storage>::add_child(Node *child, Node *parent) {
+    child->next = parent->child;
+    parent->child = child;
+}
+
+
+template <class Key, class Storage>
+typename HollowHeap<Key, Storage>::Node *HollowHeap<Key, Storage>::link(Node *a, Node *b) {
+    // returns the winner, the other node becomes its first child
+    if (b->key < a->key) {
+        add_child(a, b);
+        return b;
+    }
+    else {
+        add_child(b, a);
+        return a;
+    }
+}
+
+
+template <class Key, class Storage>
+typename HollowHeap<Key, Storage>::Node *HollowHeap<Key, Storage>::meld(Node *a, Node *b) {
+    if (a == nullptr) {
+        return b;
+    }
+    if (b == nullptr) {
+        return a;
+    }
+    return link(a, b);
+}
+
+
+template <class Key, class Storage>
+void HollowHeap<Key, Storage>::do_ranked_links(Vector<Node*> &by_rank, Node *node) {
+    while (node->rank < by_rank.size() && by_rank[node->rank] != nullptr) {
+        Node *other = by_rank[node->rank];
+        by_rank[node->rank] = nullptr;
+        node = link(node, other);
+        ++node->rank;
+    }
+    while (by_rank.size() <= node->rank) {
+        by_rank.push_back(nullptr);
+    }
+    by_rank[node->rank] = node;
+}
+
+
+#endif //HEAP_HOLLOWHEAP_H
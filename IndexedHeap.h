@@ -0,0 +1,241 @@
+#ifndef HEAP_INDEXEDHEAP_H
+#define HEAP_INDEXEDHEAP_H
+
+
+#include "Vector.h"
+#include "HeapLayout.h"
+#include <cstdlib>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+
+// d-ary heap of elements with dense ids 0 <= id < capacity, as vertices in graph algorithms.
+// Keys are stored inline next to their ids, and an array indexed by id keeps positions,
+// so there is neither a node allocation per element nor a Pointer to keep outside:
+// decrease and contains take the id itself. Layout is the same policy as in Heap.
+template <class Key, class Layout = LevelOrderLayout>
+class IndexedHeap {
+public:
+    // 4 children are usually the fastest for Dijkstra-like mixes of pushes and decreases
+    explicit IndexedHeap(uint32_t capacity, int arity = 4);
+
+    bool is_empty() const;
+    size_t size() const;
+    uint32_t capacity() const;
+    bool contains(uint32_t id) const;
+    const Key &get_key(uint32_t id) const;
+
+    void push(uint32_t id, Key key);
+    void decrease(uint32_t id, Key key);
+    // the id with the minimal key
+    uint32_t top() const;
+    const Key &get_min() const;
+    std::pair<uint32_t, Key> pop();
+    // items with their spare capacity and positions of all ids
+    MemoryUsage memory_usage() const;
+
+private:
+    static const uint32_t NOT_IN_HEAP = UINT32_MAX;
+
+    class Item {
+        friend IndexedHeap<Key, Layout>;
+    private:
+        Key key;
+        uint32_t id;
+    public:
+        // Vector creates items
+        Item();
+        Item(Key key_, uint32_t id_);
+    };
+
+    Vector<Item> items;
+    // position of every id in items or NOT_IN_HEAP
+    Vector<uint32_t> positions;
+    int k;
+    Layout layout;
+
+    void check_id(uint32_t id) const;
+    void move_item(size_t from, size_t to);
+    void siftUp(size_t index);
+    void siftDown(size_t index);
+};
+
+
+
+template <class Key, class Layout>
+IndexedHeap<Key, Layout>::IndexedHeap(uint32_t capacity, int arity) : positions(capacity, NOT_IN_HEAP) {
+    if (arity < 2) {
+        throw std::invalid_argument("IndexedHeap arity must be at least 2");
+    }
+    k = arity;
+    layout.set_arity(k);
+}
+
+
+template <class Key, class Layout>
+bool IndexedHeap<Key, Layout>::is_empty() const {
+    return items.is_empty();
+}
+
+
+template <class Key, class Layout>
+size_t IndexedHeap<Key, Layout>::size() const {
+    return items.size();
+}
+
+
+template <class Key, class Layout>
+uint32_t IndexedHeap<Key, Layout>::capacity() const {
+    return (uint32_t)positions.size();
+}
+
+
+template <class Key, class Layout>
+bool IndexedHeap<Key, Layout>::contains(uint32_t id) const {
+    check_id(id);
+    return positions[id] != NOT_IN_HEAP;
+}
+
+
+template <class Key, class Layout>
+const Key &IndexedHeap<Key, Layout>::get_key(uint32_t id) const {
+    if (!contains(id)) {
+        throw std::logic_error("IndexedHeap doesn't contain the id");
+    }
+    return items[positions[id]].key;
+}
+
+
+template <class Key, class Layout>
+void IndexedHeap<Key, Layout>::push(uint32_t id, Key key) {
+    if (contains(id)) {
+        throw std::logic_error("IndexedHeap already contains the id");
+    }
+    items.push_back(Item(std::move(key), id));
+    positions[id] = (uint32_t)(items.size() - 1);
+    siftUp(items.size() - 1);
+}
+
+
+template <class Key, class Layout>
+void IndexedHeap<Key, Layout>::decrease(uint32_t id, Key key) {
+    if (!contains(id)) {
+        throw std::logic_error("IndexedHeap doesn't contain the id");
+    }
+    size_t index = positions[id];
+    if (items[index].key < key) {
+        throw std::invalid_argument("Decrease new value is bigger than current value");
+    }
+    items[index].key = std::move(key);
+    siftUp(index);
+}
+
+
+template <class Key, class Layout>
+uint32_t IndexedHeap<Key, Layout>::top() const {
+    if (is_empty()) {
+        throw std::logic_error("IndexedHeap instance is empty");
+    }
+    return items[0].id;
+}
+
+
+template <class Key, class Layout>
+const Key &IndexedHeap<Key, Layout>::get_min() const {
+    if (is_empty()) {
+        throw std::logic_error("IndexedHeap instance is empty");
+    }
+    return items[0].key;
+}
+
+
+template <class Key, class Layout>
+MemoryUsage IndexedHeap<Key, Layout>::memory_usage() const {
+    MemoryUsage usage = items.memory_usage();
+    usage.add_bytes(positions.memory_usage());
+    return usage;
+}
+
+
+template <class Key, class Layout>
+std::pair<uint32_t, Key> IndexedHeap<Key, Layout>::pop() {
+    if (is_empty()) {
+        throw std::logic_error("IndexedHeap instance is empty");
+    }
+    std::pair<uint32_t, Key> result(items[0].id, std::move(items[0].key));
+    positions[result.first] = NOT_IN_HEAP;
+    size_t last = items.size() - 1;
+    if (last > 0) {
+        move_item(last, 0);
+    }
+    items.pop_back();
+    siftDown(0);
+    return result;
+}
+
+
+
+template <class Key, class Layout>
+IndexedHeap<Key, Layout>::Item::Item() : key(), id(NOT_IN_HEAP) {}
+
+
+template <class Key, class Layout>
+IndexedHeap<Key, Layout>::Item::Item(Key key_, uint32_t id_) : key(std::move(key_)), id(id_) {}
+
+
+template <class Key, class Layout>
+void IndexedHeap<Key, Layout>::check_id(uint32_t id) const {
+    if (id >= positions.size()) {
+        throw std::out_of_range("IndexedHeap id is out of range");
+    }
+}
+
+
+template <class Key, class Layout>
+void IndexedHeap<Key, Layout>::move_item(size_t from, size_t to) {
+    items[to] = std::move(items[from]);
+    positions[items[to].id] = (uint32_t)to;
+}
+
+
+template <class Key, class Layout>
+void IndexedHeap<Key, Layout>::siftUp(size_t index) {
+    // the item is held aside and the parents move down into the hole, one write per level
+    Item item = std::move(items[index]);
+    while (index > 0 && item.key < items[layout.parent(index)].key) {
+        size_t parent = layout.parent(index);
+        move_item(parent, index);
+        index = parent;
+    }
+    items[index] = std::move(item);
+    positions[items[index].id] = (uint32_t)index;
+}
+
+
+template <class Key, class Layout>
+void IndexedHeap<Key, Layout>::siftDown(size_t index) {
+    if (index >= items.size()) {
+        return;
+    }
+    Item item = std::move(items[index]);
+    while (layout.child(index, 0) < items.size()) {
+        size_t min_id = layout.child(index, 0);
+        for (int i = 1; i < k; ++i) {
+            size_t child = layout.child(index, i);
+            if (child < items.size() && items[child].key < items[min_id].key) {
+                min_id = child;
+            }
+        }
+        if (!(items[min_id].key < item.key)) {
+            break;
+        }
+        move_item(min_id, index);
+        index = min_id;
+    }
+    items[index] = std::move(item);
+    positions[items[index].id] = (uint32_t)index;
+}
+
+
+#endif //HEAP_INDEXEDHEAP_H
@@ -0,0 +1,40 @@
+#ifndef HEAP_KEYVALUE_H
+#define HEAP_KEYVALUE_H
+
+
+#include <utility>
+
+
+// Key with a payload for Heap, BinomialHeap and FibonacciHeap: only keys are compared,
+// so the payload needs no operator< and doesn't have to be encoded in the key.
+// Use emplace(key, value) or insert with an rvalue to move both into the node,
+// get_min and Pointer::getKey give a reference, extract_min moves the pair out.
+template <class Key, class Value>
+class KeyValue {
+public:
+    Key key;
+    Value value;
+
+    KeyValue();
+    KeyValue(Key key_, Value value_);
+
+    bool operator<(const KeyValue &other) const;
+};
+
+
+
+template <class Key, class Value>
+KeyValue<Key, Value>::KeyValue() : key(), value() {}
+
+
+template <class Key, class Value>
+KeyValue<Key, Value>::KeyValue(Key key_, Value value_) : key(std::move(key_)), value(std::move(value_)) {}
+
+
+template <class Key, class Value>
+bool KeyValue<Key, Value>::operator<(const KeyValue &other) const {
+    return key < other.key;
+}
+
+
+#endif //HEAP_KEYVALUE_H
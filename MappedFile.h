@@ -0,0 +1,164 @@
+#ifndef HEAP_MAPPEDFILE_H
+#define HEAP_MAPPEDFILE_H
+
+
+#include <cstdlib>
+#include <cstdint>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <fstream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+// Whole file mapped read-only into memory, pages are read from the file when they are touched.
+// Snapshots and traces are only read through it, loading copies everything out.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string &path);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile &operator=(const MappedFile&) = delete;
+
+    const char *data() const;
+    size_t size() const;
+
+private:
+    char *begin;
+    size_t length;
+};
+
+
+// Heap snapshots are this header followed by count records of the heap, see save methods
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t key_size;
+    // arity for Heap, unused by others
+    uint32_t parameter;
+    uint64_t count;
+};
+
+
+// writes a snapshot file record by record through the stream buffer
+class SnapshotWriter {
+public:
+    SnapshotWriter(const std::string &path, const char *magic, size_t key_size, uint32_t parameter, uint64_t count);
+
+    template <class Record>
+    void write(const Record &record);
+    // throws if anything was not written
+    void close();
+
+private:
+    std::ofstream out;
+    std::string path;
+};
+
+
+// checks the header and the length of a mapped snapshot, returns the first record
+inline const char *snapshot_records(const MappedFile &file, const char *magic, size_t key_size,
+                                    size_t record_size, SnapshotHeader &header);
+
+
+
+inline MappedFile::MappedFile(const std::string &path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("can't open " + path + ": " + strerror(errno));
+    }
+    struct stat info;
+    if (fstat(fd, &info) < 0) {
+        close(fd);
+        throw std::runtime_error("can't open " + path + ": " + strerror(errno));
+    }
+    length = (size_t)info.st_size;
+    begin = nullptr;
+    if (length > 0) {
+        void *mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("can't map " + path + ": " + strerror(errno));
+        }
+        begin = (char*)mapped;
+        // snapshots are read front to back, the kernel may read ahead aggressively
+        madvise(mapped, length, MADV_SEQUENTIAL);
+    }
+    // the mapping keeps the file open by itself
+    close(fd);
+}
+
+
+inline MappedFile::~MappedFile() {
+    if (begin != nullptr) {
+        munmap(begin, length);
+    }
+}
+
+
+inline const char *MappedFile::data() const {
+    return begin;
+}
+
+
+inline size_t MappedFile::size() const {
+    return length;
+}
+
+
+
+inline SnapshotWriter::SnapshotWriter(const std::string &path_, const char *magic, size_t key_size,
+                                      uint32_t parameter, uint64_t count)
+        : out(path_.c_str(), std::ios::binary | std::ios::trunc) {
+    path = path_;
+    if (!out) {
+        throw std::runtime_error("can't create " + path);
+    }
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, magic, sizeof(header.magic));
+    header.key_size = (uint32_t)key_size;
+    header.parameter = parameter;
+    header.count = count;
+    write(header);
+}
+
+
+template <class Record>
+void SnapshotWriter::write(const Record &record) {
+    out.write((const char*)&record, sizeof(Record));
+}
+
+
+inline void SnapshotWriter::close() {
+    out.close();
+    if (!out) {
+        throw std::runtime_error("can't write " + path);
+    }
+}
+
+
+inline const char *snapshot_records(const MappedFile &file, const char *magic, size_t key_size,
+                                    size_t record_size, SnapshotHeader &header) {
+    if (file.size() < sizeof(SnapshotHeader)) {
+        throw std::runtime_error("not a heap snapshot");
+    }
+    memcpy(&header, file.data(), sizeof(SnapshotHeader));
+    if (memcmp(header.magic, magic, sizeof(header.magic)) != 0) {
+        throw std::runtime_error("snapshot of another kind of heap");
+    }
+    if (header.key_size != key_size) {
+        throw std::runtime_error("snapshot of a heap with another key type");
+    }
+    if ((file.size() - sizeof(SnapshotHeader)) / record_size != header.count
+        || (file.size() - sizeof(SnapshotHeader)) % record_size != 0) {
+        throw std::runtime_error("snapshot is truncated");
+    }
+    return file.data() + sizeof(SnapshotHeader);
+}
+
+
+#endif //HEAP_MAPPEDFILE_H
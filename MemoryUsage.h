@@ -0,0 +1,57 @@
+#ifndef HEAP_MEMORYUSAGE_H
+#define HEAP_MEMORYUSAGE_H
+
+
+#include <cstdlib>
+
+
+// Memory of a container as its memory_usage() reports it. Bytes are those of the
+// container's own allocations (arrays with their spare capacity, nodes and slots
+// of SlotMap), the object itself and the keys' own allocations are not included.
+struct MemoryUsage {
+    size_t live_bytes;
+    // allocated but holding nothing: spare capacity of arrays
+    size_t slack_bytes;
+    size_t elements;
+    // chunks of the process-wide SlotMap tables of elements in SlotMapStorage, not in live_bytes:
+    // they are shared by all containers of the same kind and never freed, so they stay at the peak
+    size_t table_bytes;
+
+    MemoryUsage();
+    MemoryUsage(size_t live_bytes_, size_t slack_bytes_, size_t elements_);
+    // 0 for an empty container
+    double bytes_per_element() const;
+    // adds bytes of a part, elements are the container's own business;
+    // parts keep elements of other types, so their tables are added too
+    MemoryUsage &add_bytes(const MemoryUsage &part);
+};
+
+
+
+inline MemoryUsage::MemoryUsage() {
+    live_bytes = slack_bytes = elements = table_bytes = 0;
+}
+
+
+inline MemoryUsage::MemoryUsage(size_t live_bytes_, size_t slack_bytes_, size_t elements_) {
+    live_bytes = live_bytes_;
+    slack_bytes = slack_bytes_;
+    elements = elements_;
+    table_bytes = 0;
+}
+
+
+inline double MemoryUsage::bytes_per_element() const {
+    return elements == 0 ? 0 : (double)live_bytes / elements;
+}
+
+
+inline MemoryUsage &MemoryUsage::add_bytes(const MemoryUsage &part) {
+    live_bytes += part.live_bytes;
+    slack_bytes += part.slack_bytes;
+    table_bytes += part.table_bytes;
+    return *this;
+}
+
+
+#endif //HEAP_MEMORYUSAGE_H
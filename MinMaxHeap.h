@@ -0,0 +1,326 @@
+#ifndef HEAP_MINMAXHEAP_H
+#define HEAP_MINMAXHEAP_H
+
+
+#include "Vector.h"
+#include "NodeStorage.h"
+#include <cstdlib>
+#include <stdexcept>
+
+
+// Min-max heap (Atkinson et al.): binary heap where nodes on even levels are
+// not greater than all their descendants and nodes on odd levels are not less.
+// Minimum is the root, maximum is one of its children.
+template <class Key, class Storage = NewDeleteStorage>
+class MinMaxHeap {
+private:
+    class Node;
+    typedef typename Storage::template Pool<Node> NodePool;
+
+public:
+    // with SlotMapStorage it stays checkable when its element is removed: using it then throws invalid_argument
+    class Pointer {
+        friend MinMaxHeap<Key, Storage>;
+    private:
+        typename NodePool::Handle handle;
+        explicit Pointer(Node *ptr_);
+        Node *node() const;
+    public:
+        Pointer();
+        Key getKey();
+    };
+
+    MinMaxHeap();
+    ~MinMaxHeap();
+    MinMaxHeap(const MinMaxHeap&) = delete;
+    MinMaxHeap &operator=(const MinMaxHeap&) = delete;
+
+    bool is_empty() const;
+    Pointer insert(Key);
+    void erase(Pointer);
+    Key extract_min();
+    Key extract_max();
+    void change(Pointer, Key);
+    Key get_min() const;
+    Key get_max() const;
+    // the array of node pointers with its spare capacity and the nodes
+    MemoryUsage memory_usage() const;
+
+private:
+    class Node {
+        friend MinMaxHeap<Key, Storage>;
+        friend NodePool;
+    private:
+        Key key;
+        size_t index;
+        Node(Key key_, size_t index_ = 0);
+    };
+
+    Vector<Node*> nodes;
+
+    static bool is_min_level(size_t index);
+    // a < b on min levels and b < a on max levels
+    bool before(size_t a, size_t b, bool min_level) const;
+    size_t max_index() const;
+
+    void swap_nodes(size_t i, size_t j);
+    void siftUp(size_t index);
+    void siftUp(size_t index, bool min_level);
+    void siftDown(size_t index);
+    void remove(size_t index);
+};
+
+
+
+template <class Key, class Storage>
+MinMaxHeap<Key, Storage>::Pointer::Pointer() {}
+
+
+template <class Key, class Storage>
+MinMaxHeap<Key, Storage>::Pointer::Pointer(Node *ptr_) : handle(NodePool::handle(ptr_)) {}
+
+
+template <class Key, class Storage>
+typename MinMaxHeap<Key, Storage>::Node *MinMaxHeap<Key, Storage>::Pointer::node() const {
+    Node *ptr = NodePool::get(handle);
+    if (ptr == nullptr) {
+        throw std::invalid_argument("Pointer to a removed element");
+    }
+    return ptr;
+}
+
+
+template <class Key, class Storage>
+Key MinMaxHeap<Key, Storage>::Pointer::getKey() {
+    return node()->key;
+}
+
+
+template <class Key, class Storage>
+MinMaxHeap<Key, Storage>::MinMaxHeap() {}
+
+
+template <class Key, class Storage>
+MinMaxHeap<Key, Storage>::~MinMaxHeap() {
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        NodePool::destroy(nodes[i]);
+    }
+}
+
+
+template <class Key, class Storage>
+bool MinMaxHeap<Key, Storage>::is_empty() const {
+    return nodes.is_empty();
+}
+
+
+template <class Key, class Storage>
+typename MinMaxHeap<Key, Storage>::Pointer MinMaxHeap<Key, Storage>::insert(Key key) {
+    Node *nw = NodePool::create(key, nodes.size());
+    nodes.push_back(nw);
+    siftUp(nodes.size() - 1);
+    return Pointer(nw);
+}
+
+
+template <class Key, class Storage>
+void MinMaxHeap<Key, Storage>::erase(Pointer ptr) {
+    Node *node = ptr.node();
+    remove(node->index);
+    NodePool::destroy(node);
+}
+
+
+template <class Key, class Storage>
+Key MinMaxHeap<Key, Storage>::extract_min() {
+    if (is_empty()) {
+        throw std::logic_error("MinMaxHeap instance is empty");
+    }
+    Node *node = nodes[0];
+    Key ret = node->key;
+    remove(0);
+    NodePool::destroy(node);
+    return ret;
+}
+
+
+template <class Key, class Storage>
+Key MinMaxHeap<Key, Storage>::extract_max() {
+    if (is_empty()) {
+        throw std::logic_error("MinMaxHeap instance is empty");
+    }
+    Node *node = nodes[max_index()];
+    Key ret = node->key;
+    remove(node->index);
+    NodePool::destroy(node);
+    return ret;
+}
+
+
+template <class Key, class Storage>
+void MinMaxHeap<Key, Storage>::change(Pointer ptr, Key key) {
+    Node *node = ptr.node();
+    node->key = key;
+    siftDown(node->index);
+    siftUp(node->index);
+}
+
+
+template <class Key, class Storage>
+Key MinMaxHeap<Key, Storage>::get_min() const {
+    if (is_empty()) {
+        throw std::logic_error("MinMaxHeap instance is empty");
+    }
+    return nodes[0]->key;
+}
+
+
+template <class Key, class Storage>
+Key MinMaxHeap<Key, Storage>::get_max() const {
+    if (is_empty()) {
+        throw std::logic_error("MinMaxHeap instance is empty");
+    }
+    return nodes[max_index()]->key;
+}
+
+
+template <class Key, class Storage>
+MemoryUsage MinMaxHeap<Key, Storage>::memory_usage() const {
+    MemoryUsage usage = nodes.memory_usage();
+    usage.live_bytes += nodes.size() * NodePool::slot_bytes();
+    usage.table_bytes = NodePool::table_bytes();
+    return usage;
+}
+
+
+
+template <class Key, class Storage>
+MinMaxHeap<Key, Storage>::Node::Node(Key key_, size_t index_) {
+    key = key_;
+    index = index_;
+}
+
+
+template <class Key, class Storage>
+bool MinMaxHeap<Key, Storage>::is_min_level(size_t index) {
+    // level of index is floor(log2(index + 1))
+    size_t level = 0;
+    for (size_t i = index + 1; i > 1; i >>= 1) {
+        ++level;
+    }
+    return level % 2 == 0;
+}
+
+
+template <class Key, class Storage>
+bool MinMaxHeap<Key, Storage>::before(size_t a, size_t b, bool min_level) const {
+    if (min_level) {
+        return nodes[a]->key < nodes[b]->key;
+    }
+    else {
+        return nodes[b]->key < nodes[a]->key;
+    }
+}
+
+
+template <class Key, class Storage>
+size_t MinMaxHeap<Key, Storage>::max_index() const {
+    if (nodes.size() == 1) {
+        return 0;
+    }
+    if (nodes.size() == 2 || nodes[2]->key < nodes[1]->key) {
+        return 1;
+    }
+    return 2;
+}
+
+
+template <class Key, class Storage>
+void MinMaxHeap<Key, Storage>::swap_nodes(size_t i, size_t j) {
+    nodes[i]->index = j;
+    nodes[j]->index = i;
+    swap(nodes[i], nodes[j]);
+}
+
+
+template <class Key, class Storage>
+void MinMaxHeap<Key, Storage>::siftUp(size_t index) {
+    if (index == 0) {
+        return;
+    }
+    bool min_level = is_min_level(index);
+    size_t parent = (index - 1) / 2;
+    if (before(parent, index, min_level)) {
+        // node belongs to the levels of the other kind
+        swap_nodes(index, parent);
+        siftUp(parent, !min_level);
+    }
+    else {
+        siftUp(index, min_level);
+    }
+}
+
+
+template <class Key, class Storage>
+void MinMaxHeap<Key, Storage>::siftUp(size_t index, bool min_level) {
+    // moves node up through grandparents, all of them are on the levels of the same kind
+    while (index > 2) {
+        size_t grandparent = ((index - 1) / 2 - 1) / 2;
+        if (!before(index, grandparent, min_level)) {
+            break;
+        }
+        swap_nodes(index, grandparent);
+        index = grandparent;
+    }
+}
+
+
+template <class Key, class Storage>
+void MinMaxHeap<Key, Storage>::siftDown(size_t index) {
+    bool min_level = is_min_level(index);
+    while (index * 2 + 1 < nodes.size()) {
+        // best of children and grandchildren, best is min on min levels and max on max levels
+        size_t best = index * 2 + 1;
+        if (index * 2 + 2 < nodes.size() && before(index * 2 + 2, best, min_level)) {
+            best = index * 2 + 2;
+        }
+        size_t first_grandchild = index * 4 + 3;
+        for (size_t i = first_grandchild; i < first_grandchild + 4 && i < nodes.size(); ++i) {
+            if (before(i, best, min_level)) {
+                best = i;
+            }
+        }
+
+        if (!before(best, index, min_level)) {
+            break;
+        }
+        swap_nodes(best, index);
+        if (best < first_grandchild) {
+            // best was a child on a level of the other kind, so it was already not better
+            // than its own descendants, and the node is even worse - as that level requires
+            break;
+        }
+        size_t parent = (best - 1) / 2;
+        if (before(parent, best, min_level)) {
+            swap_nodes(best, parent);
+        }
+        index = best;
+    }
+}
+
+
+template <class Key, class Storage>
+void MinMaxHeap<Key, Storage>::remove(size_t index) {
+    // replaces the node with the last one, which then goes down and up
+    size_t last = nodes.size() - 1;
+    swap_nodes(index, last);
+    nodes.pop_back();
+    if (index < nodes.size()) {
+        Node *moved = nodes[index];
+        siftDown(index);
+        siftUp(moved->index);
+    }
+}
+
+
+#endif //HEAP_MINMAXHEAP_H
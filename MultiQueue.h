@@ -0,0 +1,168 @@
+#ifndef HEAP_MULTIQUEUE_H
+#define HEAP_MULTIQUEUE_H
+
+
+#include "Vector.h"
+#include "Heap.h"
+#include "ThreadRandom.h"
+#include <cstdlib>
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+
+
+// Relaxed concurrent priority queue (Rihani, Sanders, Dementiev): c * threads
+// independent Heap shards, each behind its own mutex. insert goes to a random shard,
+// extract_min takes the smaller minimum of two random shards. Nobody waits for a lock:
+// a busy shard is replaced by another random one.
+// Extracted key is not always the minimum, but on average it is among
+// the O(c * threads) smallest ones, with much better throughput than one locked heap.
+template <class Key>
+class MultiQueue {
+public:
+    explicit MultiQueue(size_t threads, size_t shards_per_thread = 2);
+
+    // both are only a snapshot when other threads are working
+    bool is_empty() const;
+    size_t size() const;
+    size_t shards_count() const;
+
+    void insert(Key);
+    // returns false if the queue is empty
+    bool try_extract_min(Key &result);
+    Key extract_min();
+
+private:
+    class Shard {
+        friend MultiQueue<Key>;
+    private:
+        std::mutex lock;
+        Heap<Key> heap;
+    public:
+        // Vector creates shards
+        Shard();
+    };
+
+    Vector<Shard> shards;
+    std::atomic<size_t> count;
+
+    size_t random_shard();
+    bool extract_from(size_t shard, Key &result);
+};
+
+
+
+template <class Key>
+MultiQueue<Key>::MultiQueue(size_t threads, size_t shards_per_thread)
+        : shards(max(threads * shards_per_thread, (size_t)2)), count(0) {}
+
+
+template <class Key>
+bool MultiQueue<Key>::is_empty() const {
+    return size() == 0;
+}
+
+
+template <class Key>
+size_t MultiQueue<Key>::size() const {
+    return count.load();
+}
+
+
+template <class Key>
+size_t MultiQueue<Key>::shards_count() const {
+    return shards.size();
+}
+
+
+template <class Key>
+void MultiQueue<Key>::insert(Key key) {
+    while (true) {
+        Shard &shard = shards[random_shard()];
+        if (shard.lock.try_lock()) {
+            shard.heap.insert(key);
+            ++count;
+            shard.lock.unlock();
+            return;
+        }
+    }
+}
+
+
+template <class Key>
+bool MultiQueue<Key>::try_extract_min(Key &result) {
+    while (count.load() > 0) {
+        size_t i = random_shard(), j = random_shard();
+        if (i == j) {
+            continue;
+        }
+        Shard &a = shards[i], &b = shards[j];
+        if (!a.lock.try_lock()) {
+            continue;
+        }
+        if (!b.lock.try_lock()) {
+            a.lock.unlock();
+            continue;
+        }
+        Shard *best = nullptr;
+        if (!a.heap.is_empty() && (b.heap.is_empty() || !(b.heap.get_min() < a.heap.get_min()))) {
+            best = &a;
+        }
+        else if (!b.heap.is_empty()) {
+            best = &b;
+        }
+        if (best != nullptr) {
+            result = best->heap.extract_min();
+            --count;
+        }
+        b.lock.unlock();
+        a.lock.unlock();
+        if (best != nullptr) {
+            return true;
+        }
+        // both shards are empty, few elements are left: look through all shards
+        for (size_t k = 0; k < shards.size(); ++k) {
+            if (extract_from(k, result)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+
+template <class Key>
+Key MultiQueue<Key>::extract_min() {
+    Key result;
+    if (!try_extract_min(result)) {
+        throw std::logic_error("MultiQueue instance is empty");
+    }
+    return result;
+}
+
+
+
+template <class Key>
+MultiQueue<Key>::Shard::Shard() {}
+
+
+template <class Key>
+size_t MultiQueue<Key>::random_shard() {
+    return (size_t)(thread_random() % shards.size());
+}
+
+
+template <class Key>
+bool MultiQueue<Key>::extract_from(size_t index, Key &result) {
+    // a busy shard counts as empty, try_extract_min goes on while count shows elements
+    std::unique_lock<std::mutex> guard(shards[index].lock, std::try_to_lock);
+    if (!guard.owns_lock() || shards[index].heap.is_empty()) {
+        return false;
+    }
+    result = shards[index].heap.extract_min();
+    --count;
+    return true;
+}
+
+
+#endif //HEAP_MULTIQUEUE_H
@@ -0,0 +1,98 @@
+#ifndef HEAP_NODESTORAGE_H
+#define HEAP_NODESTORAGE_H
+
+
+#include "SlotMap.h"
+#include <cstdlib>
+#include <utility>
+
+
+// Storage policies decide where the engines allocate the nodes their Pointers refer to.
+// Storage::Pool<T> has the interface of SlotMap<T>: create, destroy, handle, get,
+// slot_bytes and table_bytes; get returns nullptr for the handle of a default Pointer.
+
+
+// Every node is allocated with new and freed with delete as soon as its element is removed.
+// A handle is the node's address, so using a Pointer to a removed element is undefined behavior.
+class NewDeleteStorage {
+public:
+    template <class T>
+    class Pool {
+    public:
+        class Handle {
+            friend Pool<T>;
+        private:
+            T *ptr;
+        public:
+            Handle();
+        };
+
+        template <class... Args>
+        static T *create(Args&&... args);
+        static void destroy(T*);
+        static Handle handle(T*);
+        static T *get(Handle);
+        static size_t slot_bytes();
+        // there is no table, nodes are separate allocations
+        static size_t table_bytes();
+    };
+};
+
+
+// Nodes live in the process-wide SlotMap<T> (see SlotMap.h): using a Pointer to a removed element
+// throws invalid_argument, also after its heap is gone, but the table of every node type
+// stays at its peak size until the process exits.
+class SlotMapStorage {
+public:
+    template <class T>
+    using Pool = SlotMap<T>;
+};
+
+
+
+template <class T>
+NewDeleteStorage::Pool<T>::Handle::Handle() {
+    ptr = nullptr;
+}
+
+
+template <class T>
+template <class... Args>
+T *NewDeleteStorage::Pool<T>::create(Args&&... args) {
+    return new T(std::forward<Args>(args)...);
+}
+
+
+template <class T>
+void NewDeleteStorage::Pool<T>::destroy(T *element) {
+    delete element;
+}
+
+
+template <class T>
+typename NewDeleteStorage::Pool<T>::Handle NewDeleteStorage::Pool<T>::handle(T *element) {
+    Handle result;
+    result.ptr = element;
+    return result;
+}
+
+
+template <class T>
+T *NewDeleteStorage::Pool<T>::get(Handle handle) {
+    return handle.ptr;
+}
+
+
+template <class T>
+size_t NewDeleteStorage::Pool<T>::slot_bytes() {
+    return sizeof(T);
+}
+
+
+template <class T>
+size_t NewDeleteStorage::Pool<T>::table_bytes() {
+    return 0;
+}
+
+
+#endif //HEAP_NODESTORAGE_H
@@ -0,0 +1,364 @@
+#ifndef HEAP_OPERATIONTRACE_H
+#define HEAP_OPERATIONTRACE_H
+
+
+#include "MappedFile.h"
+#include "PriorityQueue.h"
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+
+// Traces of priority queue operations. A trace is a SnapshotHeader with magic "HEAPTRC1",
+// the number of queues in parameter and the number of records in count, followed by
+// fixed-size records, so a trace is read through a mapping like heap snapshots.
+// Elements are named by handle ids: the n-th insert of the trace gets id n.
+enum TraceOperation {
+    TRACE_INSERT,
+    TRACE_EXTRACT_MIN,
+    TRACE_CHANGE,
+    TRACE_DECREASE,
+    TRACE_ERASE,
+    // handle holds the id of the queue which is merged into queue
+    TRACE_MERGE,
+    TRACE_OPERATIONS
+};
+
+
+template <class Key>
+struct TraceRecord {
+    uint8_t operation;
+    uint8_t reserved[3];
+    uint32_t queue;
+    uint64_t handle;
+    // inserted or new key, the extracted one for TRACE_EXTRACT_MIN, zeros for the rest
+    Key key;
+};
+
+
+// Writes a trace to a file; queues and handles are numbered by it, so one writer
+// can serve several RecordingQueues. Not thread-safe.
+template <class Key>
+class TraceWriter {
+public:
+    explicit TraceWriter(const std::string &path);
+    // closes the file if close wasn't called, errors are lost then
+    ~TraceWriter();
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter &operator=(const TraceWriter&) = delete;
+
+    uint32_t new_queue();
+    uint64_t new_handle();
+    void write(TraceOperation, uint32_t queue, uint64_t handle, const Key &key);
+    void write(TraceOperation, uint32_t queue, uint64_t handle);
+    // writes the final header, throws if anything was not written
+    void close();
+
+private:
+    std::ofstream out;
+    std::string path;
+    uint32_t queues;
+    uint64_t handles, records;
+};
+
+
+// Trace written by TraceWriter, mapped into memory
+template <class Key>
+class TraceReader {
+public:
+    explicit TraceReader(const std::string &path);
+
+    uint32_t queues() const;
+    // one more than the biggest handle id in the trace
+    uint64_t handles() const;
+    size_t size() const;
+    TraceRecord<Key> operator[](size_t i) const;
+
+private:
+    MappedFile file;
+    SnapshotHeader header;
+    const char *records;
+    uint64_t handle_count;
+};
+
+
+// PriorityQueue which writes every operation to a trace,
+// Handles are valid in the queues of the same writer, as after merge
+template <class Key, class Engine>
+class RecordingQueue {
+public:
+    class Handle {
+        friend RecordingQueue<Key, Engine>;
+    private:
+        typename PriorityQueue<Key, Engine>::Handle handle;
+        uint64_t id;
+        Handle(typename PriorityQueue<Key, Engine>::Handle handle_, uint64_t id_);
+    public:
+        Handle();
+        Key getKey();
+    };
+
+    static const bool has_decrease = PriorityQueue<Key, Engine>::has_decrease;
+    static const bool has_change = PriorityQueue<Key, Engine>::has_change;
+    static const bool has_erase = PriorityQueue<Key, Engine>::has_erase;
+    static const bool has_meld = PriorityQueue<Key, Engine>::has_meld;
+
+    // arguments go to the engine constructor
+    template <class... Args>
+    explicit RecordingQueue(TraceWriter<Key> &writer, Args&&... args);
+
+    bool is_empty() const;
+    Handle insert(Key);
+    Key get_min() const;
+    Key extract_min();
+    void erase(Handle);
+    void decrease(Handle, Key);
+    void change(Handle, Key);
+    void merge(RecordingQueue &otherQueue);
+
+private:
+    static_assert(std::is_trivially_copyable<Key>::value, "traces store raw bytes of keys");
+
+    PriorityQueue<Key, Engine> queue;
+    TraceWriter<Key> &writer;
+    uint32_t id;
+};
+
+
+
+template <class Key>
+TraceWriter<Key>::TraceWriter(const std::string &path_) : out(path_.c_str(), std::ios::binary | std::ios::trunc) {
+    static_assert(std::is_trivially_copyable<Key>::value, "traces store raw bytes of keys");
+    path = path_;
+    if (!out) {
+        throw std::runtime_error("can't create " + path);
+    }
+    queues = 0;
+    handles = records = 0;
+    // rewritten by close with the real counts
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    out.write((const char*)&header, sizeof(header));
+}
+
+
+template <class Key>
+TraceWriter<Key>::~TraceWriter() {
+    if (out.is_open()) {
+        try {
+            close();
+        }
+        catch (const std::exception&) {
+        }
+    }
+}
+
+
+template <class Key>
+uint32_t TraceWriter<Key>::new_queue() {
+    return queues++;
+}
+
+
+template <class Key>
+uint64_t TraceWriter<Key>::new_handle() {
+    return handles++;
+}
+
+
+template <class Key>
+void TraceWriter<Key>::write(TraceOperation operation, uint32_t queue, uint64_t handle, const Key &key) {
+    TraceRecord<Key> record;
+    // padding of the record is zeroed too, so traces of the same operations are equal
+    memset(&record, 0, sizeof(record));
+    record.operation = (uint8_t)operation;
+    record.queue = queue;
+    record.handle = handle;
+    record.key = key;
+    out.write((const char*)&record, sizeof(record));
+    ++records;
+}
+
+
+template <class Key>
+void TraceWriter<Key>::write(TraceOperation operation, uint32_t queue, uint64_t handle) {
+    TraceRecord<Key> record;
+    memset(&record, 0, sizeof(record));
+    record.operation = (uint8_t)operation;
+    record.queue = queue;
+    record.handle = handle;
+    out.write((const char*)&record, sizeof(record));
+    ++records;
+}
+
+
+template <class Key>
+void TraceWriter<Key>::close() {
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "HEAPTRC1", sizeof(header.magic));
+    header.key_size = sizeof(Key);
+    header.parameter = queues;
+    header.count = records;
+    out.seekp(0);
+    out.write((const char*)&header, sizeof(header));
+    out.close();
+    if (!out) {
+        throw std::runtime_error("can't write " + path);
+    }
+}
+
+
+
+template <class Key>
+TraceReader<Key>::TraceReader(const std::string &path) : file(path) {
+    records = snapshot_records(file, "HEAPTRC1", sizeof(Key), sizeof(TraceRecord<Key>), header);
+    // ids are checked once here, so replaying tools can index arrays with them
+    handle_count = 0;
+    for (size_t i = 0; i < size(); ++i) {
+        TraceRecord<Key> record = (*this)[i];
+        if (record.operation >= TRACE_OPERATIONS || record.queue >= header.parameter
+            || (record.operation == TRACE_MERGE && record.handle >= header.parameter)
+            || (record.operation == TRACE_INSERT && record.handle != handle_count)
+            || (record.operation != TRACE_INSERT && record.operation != TRACE_EXTRACT_MIN
+                && record.operation != TRACE_MERGE && record.handle >= handle_count)) {
+            throw std::runtime_error("trace is corrupted");
+        }
+        if (record.operation == TRACE_INSERT) {
+            ++handle_count;
+        }
+    }
+}
+
+
+template <class Key>
+uint32_t TraceReader<Key>::queues() const {
+    return header.parameter;
+}
+
+
+template <class Key>
+uint64_t TraceReader<Key>::handles() const {
+    return handle_count;
+}
+
+
+template <class Key>
+size_t TraceReader<Key>::size() const {
+    return header.count;
+}
+
+
+template <class Key>
+TraceRecord<Key> TraceReader<Key>::operator[](size_t i) const {
+    TraceRecord<Key> record;
+    memcpy(&record, records + i * sizeof(TraceRecord<Key>), sizeof(record));
+    return record;
+}
+
+
+
+template <class Key, class Engine>
+const bool RecordingQueue<Key, Engine>::has_decrease;
+
+template <class Key, class Engine>
+const bool RecordingQueue<Key, Engine>::has_change;
+
+template <class Key, class Engine>
+const bool RecordingQueue<Key, Engine>::has_erase;
+
+template <class Key, class Engine>
+const bool RecordingQueue<Key, Engine>::has_meld;
+
+
+template <class Key, class Engine>
+RecordingQueue<Key, Engine>::Handle::Handle() {
+    id = UINT64_MAX;
+}
+
+
+template <class Key, class Engine>
+RecordingQueue<Key, Engine>::Handle::Handle(typename PriorityQueue<Key, Engine>::Handle handle_, uint64_t id_) {
+    handle = handle_;
+    id = id_;
+}
+
+
+template <class Key, class Engine>
+Key RecordingQueue<Key, Engine>::Handle::getKey() {
+    return handle.getKey();
+}
+
+
+template <class Key, class Engine>
+template <class... Args>
+RecordingQueue<Key, Engine>::RecordingQueue(TraceWriter<Key> &writer_, Args&&... args)
+        : queue(std::forward<Args>(args)...), writer(writer_) {
+    id = writer.new_queue();
+}
+
+
+template <class Key, class Engine>
+bool RecordingQueue<Key, Engine>::is_empty() const {
+    return queue.is_empty();
+}
+
+
+template <class Key, class Engine>
+typename RecordingQueue<Key, Engine>::Handle RecordingQueue<Key, Engine>::insert(Key key) {
+    // nothing is written for operations which throw
+    typename PriorityQueue<Key, Engine>::Handle handle = queue.insert(key);
+    uint64_t handle_id = writer.new_handle();
+    writer.write(TRACE_INSERT, id, handle_id, key);
+    return Handle(handle, handle_id);
+}
+
+
+template <class Key, class Engine>
+Key RecordingQueue<Key, Engine>::get_min() const {
+    return queue.get_min();
+}
+
+
+template <class Key, class Engine>
+Key RecordingQueue<Key, Engine>::extract_min() {
+    Key key = queue.extract_min();
+    writer.write(TRACE_EXTRACT_MIN, id, 0, key);
+    return key;
+}
+
+
+template <class Key, class Engine>
+void RecordingQueue<Key, Engine>::erase(Handle handle) {
+    queue.erase(handle.handle);
+    writer.write(TRACE_ERASE, id, handle.id);
+}
+
+
+template <class Key, class Engine>
+void RecordingQueue<Key, Engine>::decrease(Handle handle, Key key) {
+    queue.decrease(handle.handle, key);
+    writer.write(TRACE_DECREASE, id, handle.id, key);
+}
+
+
+template <class Key, class Engine>
+void RecordingQueue<Key, Engine>::change(Handle handle, Key key) {
+    queue.change(handle.handle, key);
+    writer.write(TRACE_CHANGE, id, handle.id, key);
+}
+
+
+template <class Key, class Engine>
+void RecordingQueue<Key, Engine>::merge(RecordingQueue &otherQueue) {
+    queue.merge(otherQueue.queue);
+    writer.write(TRACE_MERGE, id, otherQueue.id);
+}
+
+
+#endif //HEAP_OPERATIONTRACE_H
@@ -0,0 +1,269 @@
+#ifndef HEAP_PRIORITYQUEUE_H
+#define HEAP_PRIORITYQUEUE_H
+
+
+#include <cstdlib>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+
+// What an engine (Heap, BinomialHeap, FibonacciHeap, ...) can do besides
+// insert/get_min/extract_min/is_empty, detected from its member functions.
+template <class Engine, class Key>
+class EngineTraits {
+private:
+    typedef typename Engine::Pointer Pointer;
+
+    template <class E>
+    static auto test_decrease(int) -> decltype(std::declval<E&>().decrease(std::declval<Pointer>(),
+                                                                         std::declval<Key>()), std::true_type());
+    template <class E>
+    static std::false_type test_decrease(...);
+
+    template <class E>
+    static auto test_change(int) -> decltype(std::declval<E&>().change(std::declval<Pointer>(),
+                                                                     std::declval<Key>()), std::true_type());
+    template <class E>
+    static std::false_type test_change(...);
+
+    template <class E>
+    static auto test_erase(int) -> decltype(std::declval<E&>().erase(std::declval<Pointer>()), std::true_type());
+    template <class E>
+    static std::false_type test_erase(...);
+
+    template <class E>
+    static auto test_meld(int) -> decltype(std::declval<E&>().merge(std::declval<E&>()), std::true_type());
+    template <class E>
+    static std::false_type test_meld(...);
+
+    template <class E>
+    static auto test_emplace(int) -> decltype(std::declval<E&>().emplace(std::declval<Key>()), std::true_type());
+    template <class E>
+    static std::false_type test_emplace(...);
+
+public:
+    static const bool has_decrease = decltype(test_decrease<Engine>(0))::value;
+    static const bool has_change = decltype(test_change<Engine>(0))::value;
+    static const bool has_erase = decltype(test_erase<Engine>(0))::value;
+    static const bool has_meld = decltype(test_meld<Engine>(0))::value;
+    // builds keys in their nodes, PriorityQueue::emplace constructs a Key for the other engines
+    static const bool has_emplace = decltype(test_emplace<Engine>(0))::value;
+};
+
+
+// One interface over all engines: switching the engine is changing a template argument.
+// Operations the engine can't do fail to compile (see has_* constants),
+// decrease falls back to change for engines which have only change.
+// Keys are moved into the engine and not copied on the way, so move-only keys work
+// with the engines which support them.
+template <class Key, class Engine>
+class PriorityQueue {
+public:
+    // const Key& from engines which give a reference to the key in their node, Key from the others
+    typedef decltype(std::declval<const Engine&>().get_min()) MinResult;
+    typedef decltype(std::declval<typename Engine::Pointer&>().getKey()) KeyResult;
+
+    class Handle {
+        friend PriorityQueue<Key, Engine>;
+    private:
+        typename Engine::Pointer ptr;
+        explicit Handle(typename Engine::Pointer ptr_);
+    public:
+        Handle();
+        KeyResult getKey();
+    };
+
+    static const bool has_decrease = EngineTraits<Engine, Key>::has_decrease ||
+                                     EngineTraits<Engine, Key>::has_change;
+    static const bool has_change = EngineTraits<Engine, Key>::has_change;
+    static const bool has_erase = EngineTraits<Engine, Key>::has_erase;
+    static const bool has_meld = EngineTraits<Engine, Key>::has_meld;
+
+    // arguments go to the engine constructor (range of BucketQueue, for example)
+    template <class... Args>
+    explicit PriorityQueue(Args&&... args);
+
+    bool is_empty() const;
+    Handle insert(const Key&);
+    Handle insert(Key&&);
+    // constructs the key from the arguments, in its node if the engine has emplace
+    template <class... Args>
+    Handle emplace(Args&&... args);
+    MinResult get_min() const;
+    Key extract_min();
+    void erase(Handle);
+    void decrease(Handle, Key);
+    void change(Handle, Key);
+    void merge(PriorityQueue &otherQueue);
+
+    Engine &get_engine();
+
+private:
+    Engine engine;
+
+    template <class... Args>
+    Handle emplace_in_engine(std::true_type, Args&&... args);
+    template <class... Args>
+    Handle emplace_in_engine(std::false_type, Args&&... args);
+    void decrease(Handle, Key, std::true_type);
+    void decrease(Handle, Key, std::false_type);
+};
+
+
+
+template <class Engine, class Key>
+const bool EngineTraits<Engine, Key>::has_decrease;
+
+template <class Engine, class Key>
+const bool EngineTraits<Engine, Key>::has_change;
+
+template <class Engine, class Key>
+const bool EngineTraits<Engine, Key>::has_erase;
+
+template <class Engine, class Key>
+const bool EngineTraits<Engine, Key>::has_meld;
+
+template <class Engine, class Key>
+const bool EngineTraits<Engine, Key>::has_emplace;
+
+
+
+template <class Key, class Engine>
+const bool PriorityQueue<Key, Engine>::has_decrease;
+
+template <class Key, class Engine>
+const bool PriorityQueue<Key, Engine>::has_change;
+
+template <class Key, class Engine>
+const bool PriorityQueue<Key, Engine>::has_erase;
+
+template <class Key, class Engine>
+const bool PriorityQueue<Key, Engine>::has_meld;
+
+
+template <class Key, class Engine>
+PriorityQueue<Key, Engine>::Handle::Handle() {}
+
+
+template <class Key, class Engine>
+PriorityQueue<Key, Engine>::Handle::Handle(typename Engine::Pointer ptr_) {
+    ptr = ptr_;
+}
+
+
+template <class Key, class Engine>
+typename PriorityQueue<Key, Engine>::KeyResult PriorityQueue<Key, Engine>::Handle::getKey() {
+    return ptr.getKey();
+}
+
+
+
+template <class Key, class Engine>
+template <class... Args>
+PriorityQueue<Key, Engine>::PriorityQueue(Args&&... args) : engine(std::forward<Args>(args)...) {}
+
+
+template <class Key, class Engine>
+bool PriorityQueue<Key, Engine>::is_empty() const {
+    return engine.is_empty();
+}
+
+
+template <class Key, class Engine>
+typename PriorityQueue<Key, Engine>::Handle PriorityQueue<Key, Engine>::insert(const Key &key) {
+    return Handle(engine.insert(key));
+}
+
+
+template <class Key, class Engine>
+typename PriorityQueue<Key, Engine>::Handle PriorityQueue<Key, Engine>::insert(Key &&key) {
+    return Handle(engine.insert(std::move(key)));
+}
+
+
+template <class Key, class Engine>
+template <class... Args>
+typename PriorityQueue<Key, Engine>::Handle PriorityQueue<Key, Engine>::emplace(Args&&... args) {
+    return emplace_in_engine(std::integral_constant<bool, EngineTraits<Engine, Key>::has_emplace>(),
+                             std::forward<Args>(args)...);
+}
+
+
+template <class Key, class Engine>
+typename PriorityQueue<Key, Engine>::MinResult PriorityQueue<Key, Engine>::get_min() const {
+    return engine.get_min();
+}
+
+
+template <class Key, class Engine>
+Key PriorityQueue<Key, Engine>::extract_min() {
+    return engine.extract_min();
+}
+
+
+template <class Key, class Engine>
+void PriorityQueue<Key, Engine>::erase(Handle handle) {
+    static_assert(has_erase, "Engine doesn't support erase");
+    engine.erase(handle.ptr);
+}
+
+
+template <class Key, class Engine>
+void PriorityQueue<Key, Engine>::decrease(Handle handle, Key key) {
+    static_assert(has_decrease, "Engine supports neither decrease nor change");
+    decrease(handle, std::move(key), std::integral_constant<bool, EngineTraits<Engine, Key>::has_decrease>());
+}
+
+
+template <class Key, class Engine>
+void PriorityQueue<Key, Engine>::change(Handle handle, Key key) {
+    static_assert(has_change, "Engine doesn't support change");
+    engine.change(handle.ptr, std::move(key));
+}
+
+
+template <class Key, class Engine>
+void PriorityQueue<Key, Engine>::merge(PriorityQueue &otherQueue) {
+    static_assert(has_meld, "Engine doesn't support merge");
+    engine.merge(otherQueue.engine);
+}
+
+
+template <class Key, class Engine>
+Engine &PriorityQueue<Key, Engine>::get_engine() {
+    return engine;
+}
+
+
+template <class Key, class Engine>
+template <class... Args>
+typename PriorityQueue<Key, Engine>::Handle PriorityQueue<Key, Engine>::emplace_in_engine(std::true_type, Args&&... args) {
+    return Handle(engine.emplace(std::forward<Args>(args)...));
+}
+
+
+template <class Key, class Engine>
+template <class... Args>
+typename PriorityQueue<Key, Engine>::Handle PriorityQueue<Key, Engine>::emplace_in_engine(std::false_type, Args&&... args) {
+    return Handle(engine.insert(Key(std::forward<Args>(args)...)));
+}
+
+
+template <class Key, class Engine>
+void PriorityQueue<Key, Engine>::decrease(Handle handle, Key key, std::true_type) {
+    engine.decrease(handle.ptr, std::move(key));
+}
+
+
+template <class Key, class Engine>
+void PriorityQueue<Key, Engine>::decrease(Handle handle, Key key, std::false_type) {
+    // same contract as FibonacciHeap::decrease
+    if (handle.ptr.getKey() < key) {
+        throw std::invalid_argument("Decrease new value is bigger than current value");
+    }
+    engine.change(handle.ptr, std::move(key));
+}
+
+
+#endif //HEAP_PRIORITYQUEUE_H
@@ -0,0 +1,475 @@
+#ifndef HEAP_SHAREDHEAP_H
+#define HEAP_SHAREDHEAP_H
+
+
+#include "Vector.h"
+#include <atomic>
+#include <cstdlib>
+#include <cstdint>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <stdexcept>
+#include <type_traits>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+// Binary heap of fixed capacity in a POSIX shared memory segment, so processes
+// on one host work with the same heap directly. One process creates the segment by name,
+// others attach to it. There are no pointers in the segment: items are keys with slot numbers,
+// a Pointer is a slot number, and slots know positions of their items in the array.
+// All operations hold a robust process-shared mutex; if a process dies holding it,
+// the next one to lock repairs the heap from the items array. A swap keeps a copy of its
+// first item in the header, so an interrupted swap is finished and no element is lost.
+// Key is copied into the segment as raw bytes, so it must be trivially copyable.
+template <class Key>
+class SharedHeap {
+    static_assert(std::is_trivially_copyable<Key>::value, "SharedHeap stores raw bytes of keys");
+public:
+    class Pointer {
+        friend SharedHeap<Key>;
+    private:
+        uint32_t slot;
+        explicit Pointer(uint32_t slot_);
+    public:
+        Pointer();
+    };
+
+    // creates the segment, throws if it already exists
+    SharedHeap(const std::string &name, size_t capacity);
+    // attaches to the segment created by another process
+    explicit SharedHeap(const std::string &name);
+    // detaches, the segment stays until remove
+    ~SharedHeap();
+    SharedHeap(const SharedHeap&) = delete;
+    SharedHeap &operator=(const SharedHeap&) = delete;
+
+    static void remove(const std::string &name);
+
+    bool is_empty() const;
+    size_t size() const;
+    size_t capacity() const;
+
+    Pointer insert(Key);
+    Key get_min() const;
+    Key extract_min();
+    // returns false if the heap is empty
+    bool try_extract_min(Key &result);
+    // pointers are valid until their element is extracted or erased, then slots are reused
+    void erase(Pointer);
+    void change(Pointer, Key);
+    Key get_key(Pointer) const;
+
+private:
+    static const uint64_t MAGIC = 0x5041454844455253ull;
+
+    struct Item {
+        Key key;
+        uint32_t slot;
+    };
+
+    struct Header {
+        uint64_t magic;
+        uint64_t key_size;
+        uint64_t capacity;
+        uint64_t count;
+        uint64_t free_count;
+        pthread_mutex_t lock;
+        // the swap in progress: 0 - none, 1 - items[swap_i] is being overwritten by items[swap_j],
+        // 2 - items[swap_j] is being overwritten by swap_item, the old items[swap_i]
+        uint64_t swap_phase;
+        uint64_t swap_i;
+        uint64_t swap_j;
+        Item swap_item;
+    };
+
+    // holds the mutex of the segment, repairs the heap after a dead owner
+    class Guard {
+    public:
+        explicit Guard(const SharedHeap &heap_);
+        ~Guard();
+    private:
+        const SharedHeap &heap;
+    };
+
+    char *base;
+    size_t length;
+    // parts of the segment
+    Header *header;
+    Item *items;
+    uint64_t *positions;
+    uint32_t *free_slots;
+
+    static size_t segment_length(size_t capacity);
+    void map(int fd, size_t length_);
+    void locate(size_t capacity);
+    void check_slot(Pointer) const;
+    void erase_at(size_t index) const;
+    void swap_items(size_t i, size_t j) const;
+    void set_swap_phase(uint64_t phase) const;
+    void sift_up(size_t index) const;
+    void sift_down(size_t index) const;
+    void repair() const;
+};
+
+
+
+template <class Key>
+SharedHeap<Key>::Pointer::Pointer(uint32_t slot_) {
+    slot = slot_;
+}
+
+
+template <class Key>
+SharedHeap<Key>::Pointer::Pointer() {
+    slot = UINT32_MAX;
+}
+
+
+
+template <class Key>
+SharedHeap<Key>::SharedHeap(const std::string &name, size_t capacity) {
+    if (capacity == 0 || capacity >= UINT32_MAX) {
+        throw std::invalid_argument("SharedHeap capacity must be in [1, 2^32 - 1)");
+    }
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        throw std::runtime_error("can't create shared memory " + name + ": " + strerror(errno));
+    }
+    size_t length_ = segment_length(capacity);
+    if (ftruncate(fd, (off_t)length_) < 0) {
+        close(fd);
+        shm_unlink(name.c_str());
+        throw std::runtime_error("can't create shared memory " + name + ": " + strerror(errno));
+    }
+    try {
+        map(fd, length_);
+    }
+    catch (...) {
+        shm_unlink(name.c_str());
+        throw;
+    }
+    locate(capacity);
+
+    header->key_size = sizeof(Key);
+    header->capacity = capacity;
+    header->count = 0;
+    header->free_count = capacity;
+    header->swap_phase = 0;
+    for (size_t i = 0; i < capacity; ++i) {
+        free_slots[i] = (uint32_t)(capacity - 1 - i);
+    }
+    pthread_mutexattr_t attributes;
+    pthread_mutexattr_init(&attributes);
+    pthread_mutexattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&attributes, PTHREAD_MUTEX_ROBUST);
+    pthread_mutex_init(&header->lock, &attributes);
+    pthread_mutexattr_destroy(&attributes);
+    // others check the magic, so it is the last thing written
+    __atomic_store_n(&header->magic, MAGIC, __ATOMIC_RELEASE);
+}
+
+
+template <class Key>
+SharedHeap<Key>::SharedHeap(const std::string &name) {
+    int fd = shm_open(name.c_str(), O_RDWR, 0600);
+    if (fd < 0) {
+        throw std::runtime_error("can't open shared memory " + name + ": " + strerror(errno));
+    }
+    struct stat info;
+    if (fstat(fd, &info) < 0 || (size_t)info.st_size < sizeof(Header)) {
+        close(fd);
+        throw std::runtime_error("shared memory " + name + " is not a SharedHeap");
+    }
+    map(fd, (size_t)info.st_size);
+    if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != MAGIC || header->key_size != sizeof(Key)
+        || segment_length(header->capacity) != length) {
+        munmap(base, length);
+        throw std::runtime_error("shared memory " + name + " is not a SharedHeap of this key type");
+    }
+    locate(header->capacity);
+}
+
+
+template <class Key>
+SharedHeap<Key>::~SharedHeap() {
+    munmap(base, length);
+}
+
+
+template <class Key>
+void SharedHeap<Key>::remove(const std::string &name) {
+    shm_unlink(name.c_str());
+}
+
+
+template <class Key>
+bool SharedHeap<Key>::is_empty() const {
+    return size() == 0;
+}
+
+
+template <class Key>
+size_t SharedHeap<Key>::size() const {
+    Guard guard(*this);
+    return header->count;
+}
+
+
+template <class Key>
+size_t SharedHeap<Key>::capacity() const {
+    return header->capacity;
+}
+
+
+template <class Key>
+typename SharedHeap<Key>::Pointer SharedHeap<Key>::insert(Key key) {
+    Guard guard(*this);
+    if (header->free_count == 0) {
+        throw std::logic_error("SharedHeap instance is full");
+    }
+    uint32_t slot = free_slots[header->free_count - 1];
+    size_t index = header->count;
+    items[index].key = key;
+    items[index].slot = slot;
+    positions[slot] = index;
+    // counters change after the item is written, so a dead owner leaves no garbage
+    --header->free_count;
+    ++header->count;
+    sift_up(index);
+    return Pointer(slot);
+}
+
+
+template <class Key>
+Key SharedHeap<Key>::get_min() const {
+    Guard guard(*this);
+    if (header->count == 0) {
+        throw std::logic_error("SharedHeap instance is empty");
+    }
+    return items[0].key;
+}
+
+
+template <class Key>
+Key SharedHeap<Key>::extract_min() {
+    Key result;
+    if (!try_extract_min(result)) {
+        throw std::logic_error("SharedHeap instance is empty");
+    }
+    return result;
+}
+
+
+template <class Key>
+bool SharedHeap<Key>::try_extract_min(Key &result) {
+    Guard guard(*this);
+    if (header->count == 0) {
+        return false;
+    }
+    result = items[0].key;
+    erase_at(0);
+    return true;
+}
+
+
+template <class Key>
+void SharedHeap<Key>::erase(Pointer ptr) {
+    Guard guard(*this);
+    check_slot(ptr);
+    erase_at(positions[ptr.slot]);
+}
+
+
+template <class Key>
+void SharedHeap<Key>::change(Pointer ptr, Key key) {
+    Guard guard(*this);
+    check_slot(ptr);
+    size_t index = positions[ptr.slot];
+    items[index].key = key;
+    sift_up(index);
+    sift_down(positions[ptr.slot]);
+}
+
+
+template <class Key>
+Key SharedHeap<Key>::get_key(Pointer ptr) const {
+    Guard guard(*this);
+    check_slot(ptr);
+    return items[positions[ptr.slot]].key;
+}
+
+
+
+template <class Key>
+SharedHeap<Key>::Guard::Guard(const SharedHeap &heap_) : heap(heap_) {
+    int result = pthread_mutex_lock(&heap.header->lock);
+    if (result == EOWNERDEAD) {
+        heap.repair();
+        pthread_mutex_consistent(&heap.header->lock);
+    }
+    else if (result != 0) {
+        throw std::runtime_error(std::string("can't lock SharedHeap: ") + strerror(result));
+    }
+}
+
+
+template <class Key>
+SharedHeap<Key>::Guard::~Guard() {
+    pthread_mutex_unlock(&heap.header->lock);
+}
+
+
+
+template <class Key>
+size_t SharedHeap<Key>::segment_length(size_t capacity) {
+    // Items first after the header, then 8-byte positions, then 4-byte free slots
+    size_t items_offset = (sizeof(Header) + alignof(Item) - 1) / alignof(Item) * alignof(Item);
+    size_t positions_offset = (items_offset + capacity * sizeof(Item) + 7) / 8 * 8;
+    return positions_offset + capacity * (sizeof(uint64_t) + sizeof(uint32_t));
+}
+
+
+template <class Key>
+void SharedHeap<Key>::map(int fd, size_t length_) {
+    void *mapped = mmap(nullptr, length_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        throw std::runtime_error(std::string("can't map shared memory: ") + strerror(errno));
+    }
+    base = (char*)mapped;
+    length = length_;
+    header = (Header*)base;
+}
+
+
+template <class Key>
+void SharedHeap<Key>::locate(size_t capacity) {
+    // the same offsets as in segment_length
+    size_t items_offset = (sizeof(Header) + alignof(Item) - 1) / alignof(Item) * alignof(Item);
+    size_t positions_offset = (items_offset + capacity * sizeof(Item) + 7) / 8 * 8;
+    items = (Item*)(base + items_offset);
+    positions = (uint64_t*)(base + positions_offset);
+    free_slots = (uint32_t*)(base + positions_offset + capacity * sizeof(uint64_t));
+}
+
+
+template <class Key>
+void SharedHeap<Key>::check_slot(Pointer ptr) const {
+    if (ptr.slot >= header->capacity || positions[ptr.slot] >= header->count
+        || items[positions[ptr.slot]].slot != ptr.slot) {
+        throw std::invalid_argument("Pointer doesn't point to an element of this SharedHeap");
+    }
+}
+
+
+template <class Key>
+void SharedHeap<Key>::erase_at(size_t index) const {
+    uint32_t slot = items[index].slot;
+    size_t last = header->count - 1;
+    swap_items(index, last);
+    --header->count;
+    free_slots[header->free_count++] = slot;
+    if (index < last) {
+        sift_up(index);
+        sift_down(positions[items[index].slot]);
+    }
+}
+
+
+template <class Key>
+void SharedHeap<Key>::swap_items(size_t i, size_t j) const {
+    // every moment one of the items is in the array and the other one is in the header
+    header->swap_item = items[i];
+    header->swap_i = i;
+    header->swap_j = j;
+    set_swap_phase(1);
+    items[i] = items[j];
+    set_swap_phase(2);
+    items[j] = header->swap_item;
+    set_swap_phase(0);
+    positions[items[i].slot] = i;
+    positions[items[j].slot] = j;
+}
+
+
+template <class Key>
+void SharedHeap<Key>::set_swap_phase(uint64_t phase) const {
+    // only the order of writes as seen after the death of this process matters,
+    // so it is enough to keep the compiler from moving them across the phase
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    header->swap_phase = phase;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+}
+
+
+template <class Key>
+void SharedHeap<Key>::sift_up(size_t index) const {
+    while (index > 0 && items[index].key < items[(index - 1) / 2].key) {
+        swap_items(index, (index - 1) / 2);
+        index = (index - 1) / 2;
+    }
+}
+
+
+template <class Key>
+void SharedHeap<Key>::sift_down(size_t index) const {
+    while (2 * index + 1 < header->count) {
+        size_t child = 2 * index + 1;
+        if (child + 1 < header->count && items[child + 1].key < items[child].key) {
+            ++child;
+        }
+        if (!(items[child].key < items[index].key)) {
+            break;
+        }
+        swap_items(index, child);
+        index = child;
+    }
+}
+
+
+template <class Key>
+void SharedHeap<Key>::repair() const {
+    // the owner died inside an operation: its swap is finished from the copy in the header,
+    // then items up to count are trusted, slots, positions and order are rebuilt
+    size_t capacity = header->capacity;
+    if (header->count > capacity) {
+        header->count = capacity;
+    }
+    if (header->swap_phase != 0 && header->swap_i < capacity && header->swap_j < capacity) {
+        if (header->swap_phase == 1) {
+            items[header->swap_i] = items[header->swap_j];
+        }
+        items[header->swap_j] = header->swap_item;
+    }
+    header->swap_phase = 0;
+    Vector<bool> used(capacity, false);
+    size_t kept = 0;
+    for (size_t i = 0; i < header->count; ++i) {
+        uint32_t slot = items[i].slot;
+        if (slot < capacity && !used[slot]) {
+            used[slot] = true;
+            items[kept++] = items[i];
+        }
+    }
+    header->count = kept;
+    header->free_count = 0;
+    for (size_t slot = capacity; slot-- > 0; ) {
+        if (!used[slot]) {
+            free_slots[header->free_count++] = (uint32_t)slot;
+        }
+    }
+    for (size_t i = 0; i < kept; ++i) {
+        positions[items[i].slot] = i;
+    }
+    for (size_t i = kept / 2 + 1; i-- > 0; ) {
+        sift_down(i);
+    }
+}
+
+
+#endif //HEAP_SHAREDHEAP_H
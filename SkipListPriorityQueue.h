@@ -0,0 +1,380 @@
+#ifndef HEAP_SKIPLISTPRIORITYQUEUE_H
+#define HEAP_SKIPLISTPRIORITYQUEUE_H
+
+
+#include <cstdlib>
+#include <cstdint>
+#include <atomic>
+#include <stdexcept>
+#include "EpochReclamation.h"
+#include "ThreadRandom.h"
+
+
+// Lock-free priority queue on a skip list (Linden, Jonsson, 2013).
+// extract_min deletes the first node logically by setting the lowest bit of the next[0]
+// pointer of its predecessor, so the deleted nodes always form a prefix of the list.
+// Only when the prefix is longer than max_offset the head is moved past it in one CAS
+// and the upper levels are restructured, so deleters rarely touch the same memory.
+// Removed nodes may still be read by other threads, every operation runs inside an
+// EpochReclamation::Guard and the thread which cuts the prefix frees the nodes removed
+// two epochs before.
+template <class Key>
+class SkipListPriorityQueue {
+public:
+    explicit SkipListPriorityQueue(int max_offset = 32);
+    ~SkipListPriorityQueue();
+
+    // only a snapshot when other threads are working
+    bool is_empty() const;
+    void insert(Key);
+    // returns false if the queue is empty
+    bool try_extract_min(Key &result);
+    Key extract_min();
+    // removed nodes which are not freed yet
+    size_t retired_count() const;
+
+private:
+    static const int MAX_LEVEL = 32;
+
+    class Node {
+        friend SkipListPriorityQueue<Key>;
+    private:
+        Key key;
+        int level;
+        // pointers with the mark bit, mark in next[0] means the next node is deleted
+        std::atomic<uintptr_t> *next;
+        std::atomic<bool> inserting;
+        // list of removed nodes
+        Node *retired_next;
+        // the epoch after the node was cut off
+        uint64_t retired_epoch;
+
+        Node(Key key_, int level_);
+        ~Node();
+    };
+
+    Node *head, *tail;
+    int max_offset;
+    std::atomic<Node*> retired;
+    std::atomic<size_t> retired_nodes;
+    // only the thread which holds reclaiming touches pending
+    std::atomic_flag reclaiming;
+    Node *pending;
+
+    static bool is_marked(uintptr_t);
+    static Node *unmarked(uintptr_t);
+    static uintptr_t marked(Node*);
+    static uintptr_t ref(Node*);
+    static int random_level();
+
+    bool before(Node*, const Key&) const;
+    Node *locate_preds(const Key&, Node **preds, Node **succs);
+    void restructure();
+    void retire(Node*);
+    void reclaim();
+};
+
+
+
+template <class Key>
+SkipListPriorityQueue<Key>::SkipListPriorityQueue(int max_offset_) : retired(nullptr), retired_nodes(0) {
+    reclaiming.clear();
+    pending = nullptr;
+    max_offset = max_offset_;
+    head = new Node(Key(), MAX_LEVEL);
+    tail = new Node(Key(), MAX_LEVEL);
+    for (int i = 0; i < MAX_LEVEL; ++i) {
+        head->next[i] = ref(tail);
+        tail->next[i] = ref(nullptr);
+    }
+}
+
+
+template <class Key>
+SkipListPriorityQueue<Key>::~SkipListPriorityQueue() {
+    // nodes after the head, deleted or not, are still linked on level 0
+    Node *cur = unmarked(head->next[0]);
+    while (cur != tail) {
+        Node *nxt = unmarked(cur->next[0]);
+        delete cur;
+        cur = nxt;
+    }
+    Node *lists[] = {retired.load(), pending};
+    for (int i = 0; i < 2; ++i) {
+        cur = lists[i];
+        while (cur != nullptr) {
+            Node *nxt = cur->retired_next;
+            delete cur;
+            cur = nxt;
+        }
+    }
+    delete head;
+    delete tail;
+}
+
+
+template <class Key>
+bool SkipListPriorityQueue<Key>::is_empty() const {
+    EpochReclamation::Guard guard;
+    Node *x = head;
+    uintptr_t nxt = x->next[0];
+    while (is_marked(nxt)) {
+        x = unmarked(nxt);
+        nxt = x->next[0];
+    }
+    return unmarked(nxt) == tail;
+}
+
+
+template <class Key>
+void SkipListPriorityQueue<Key>::insert(Key key) {
+    EpochReclamation::Guard guard;
+    int height = random_level();
+    Node *nw = new Node(key, height);
+    nw->inserting = true;
+    Node *preds[MAX_LEVEL], *succs[MAX_LEVEL];
+    Node *del;
+    while (true) {
+        del = locate_preds(key, preds, succs);
+        nw->next[0] = ref(succs[0]);
+        uintptr_t expected = ref(succs[0]);
+        if (preds[0]->next[0].compare_exchange_strong(expected, ref(nw))) {
+            break;
+        }
+    }
+    // upper levels are only hints, linking stops as soon as the node gets deleted
+    int i = 1;
+    while (i < height) {
+        nw->next[i] = ref(succs[i]);
+        if (is_marked(nw->next[0]) || is_marked(succs[i]->next[0]) || del == succs[i]) {
+            break;
+        }
+        uintptr_t expected = ref(succs[i]);
+        if (preds[i]->next[i].compare_exchange_strong(expected, ref(nw))) {
+            ++i;
+        }
+        else {
+            del = locate_preds(key, preds, succs);
+            if (succs[0] != nw) {
+                break;
+            }
+        }
+    }
+    nw->inserting = false;
+}
+
+
+template <class Key>
+bool SkipListPriorityQueue<Key>::try_extract_min(Key &result) {
+    EpochReclamation::Guard guard;
+    Node *x = head, *newhead = nullptr;
+    uintptr_t obs_head = x->next[0], nxt;
+    int offset = 0;
+    // walk the deleted prefix and mark the first node which is not deleted yet
+    do {
+        ++offset;
+        nxt = x->next[0];
+        if (unmarked(nxt) == tail) {
+            return false;
+        }
+        if (newhead == nullptr && x->inserting) {
+            // the prefix can't be cut after a node whose insert may still link it
+            newhead = x;
+        }
+        if (is_marked(nxt)) {
+            continue;
+        }
+        nxt = x->next[0].fetch_or(1);
+    } while ((x = unmarked(nxt)) && is_marked(nxt));
+
+    result = x->key;
+    if (newhead == nullptr) {
+        newhead = x;
+    }
+    if (offset <= max_offset) {
+        return true;
+    }
+    if (head->next[0] != obs_head) {
+        return true;
+    }
+    if (head->next[0].compare_exchange_strong(obs_head, marked(newhead))) {
+        restructure();
+        Node *cur = unmarked(obs_head);
+        while (cur != newhead) {
+            Node *next_node = unmarked(cur->next[0]);
+            retire(cur);
+            cur = next_node;
+        }
+        reclaim();
+    }
+    return true;
+}
+
+
+template <class Key>
+Key SkipListPriorityQueue<Key>::extract_min() {
+    Key result;
+    if (!try_extract_min(result)) {
+        throw std::logic_error("SkipListPriorityQueue instance is empty");
+    }
+    return result;
+}
+
+
+template <class Key>
+size_t SkipListPriorityQueue<Key>::retired_count() const {
+    return retired_nodes.load();
+}
+
+
+
+template <class Key>
+SkipListPriorityQueue<Key>::Node::Node(Key key_, int level_) : inserting(false) {
+    key = key_;
+    level = level_;
+    next = new std::atomic<uintptr_t>[level];
+    retired_next = nullptr;
+    retired_epoch = 0;
+}
+
+
+template <class Key>
+SkipListPriorityQueue<Key>::Node::~Node() {
+    delete[] next;
+}
+
+
+template <class Key>
+bool SkipListPriorityQueue<Key>::is_marked(uintptr_t ptr) {
+    return (ptr & 1) != 0;
+}
+
+
+template <class Key>
+typename SkipListPriorityQueue<Key>::Node *SkipListPriorityQueue<Key>::unmarked(uintptr_t ptr) {
+    return (Node*)(ptr & ~(uintptr_t)1);
+}
+
+
+template <class Key>
+uintptr_t SkipListPriorityQueue<Key>::marked(Node *node) {
+    return (uintptr_t)node | 1;
+}
+
+
+template <class Key>
+uintptr_t SkipListPriorityQueue<Key>::ref(Node *node) {
+    return (uintptr_t)node;
+}
+
+
+template <class Key>
+int SkipListPriorityQueue<Key>::random_level() {
+    // geometric with p = 1/2
+    uint64_t bits = thread_random();
+    int level = 1;
+    while (level < MAX_LEVEL && (bits >> (level - 1) & 1)) {
+        ++level;
+    }
+    return level;
+}
+
+
+template <class Key>
+bool SkipListPriorityQueue<Key>::before(Node *node, const Key &key) const {
+    return node != tail && node->key < key;
+}
+
+
+template <class Key>
+typename SkipListPriorityQueue<Key>::Node *SkipListPriorityQueue<Key>::locate_preds(const Key &key, Node **preds,
+                                                                                    Node **succs) {
+    // finds the place for key on every level, skipping deleted nodes,
+    // returns the last deleted node seen on level 0
+    Node *pred = head, *del = nullptr;
+    for (int i = MAX_LEVEL - 1; i >= 0; --i) {
+        uintptr_t cur_ref = pred->next[i];
+        bool d = is_marked(cur_ref);
+        Node *cur = unmarked(cur_ref);
+        while (before(cur, key) || (cur != tail && is_marked(cur->next[0])) || (i == 0 && d)) {
+            if (d && i == 0) {
+                del = cur;
+            }
+            pred = cur;
+            cur_ref = pred->next[i];
+            d = is_marked(cur_ref);
+            cur = unmarked(cur_ref);
+        }
+        preds[i] = pred;
+        succs[i] = cur;
+    }
+    return del;
+}
+
+
+template <class Key>
+void SkipListPriorityQueue<Key>::restructure() {
+    // moves upper level pointers of the head past the deleted prefix
+    Node *pred = head;
+    int i = MAX_LEVEL - 1;
+    while (i > 0) {
+        uintptr_t h = head->next[i];
+        Node *cur = unmarked(pred->next[i]);
+        if (unmarked(h) == tail || !is_marked(unmarked(h)->next[0])) {
+            --i;
+            continue;
+        }
+        while (cur != tail && is_marked(cur->next[0])) {
+            pred = cur;
+            cur = unmarked(pred->next[i]);
+        }
+        if (head->next[i].compare_exchange_strong(h, pred->next[i])) {
+            --i;
+        }
+    }
+}
+
+
+template <class Key>
+void SkipListPriorityQueue<Key>::retire(Node *node) {
+    // the node is unreachable from the head already
+    node->retired_epoch = EpochReclamation::current();
+    ++retired_nodes;
+    Node *first = retired.load();
+    do {
+        node->retired_next = first;
+    } while (!retired.compare_exchange_weak(first, node));
+}
+
+
+template <class Key>
+void SkipListPriorityQueue<Key>::reclaim() {
+    // nobody waits: if another thread is reclaiming, it will take these nodes later
+    if (reclaiming.test_and_set()) {
+        return;
+    }
+    uint64_t now = EpochReclamation::try_advance();
+    Node *cur = retired.exchange(nullptr);
+    while (cur != nullptr) {
+        Node *nxt = cur->retired_next;
+        cur->retired_next = pending;
+        pending = cur;
+        cur = nxt;
+    }
+    Node **link = &pending;
+    while (*link != nullptr) {
+        Node *node = *link;
+        if (EpochReclamation::is_safe(node->retired_epoch, now)) {
+            *link = node->retired_next;
+            delete node;
+            --retired_nodes;
+        }
+        else {
+            link = &node->retired_next;
+        }
+    }
+    reclaiming.clear();
+}
+
+
+#endif //HEAP_SKIPLISTPRIORITYQUEUE_H
@@ -0,0 +1,334 @@
+#ifndef HEAP_SLOTMAP_H
+#define HEAP_SLOTMAP_H
+
+
+#include <cstdlib>
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+
+// Elements of type T in the slots of one process-wide table, addressed by 32-bit indices.
+// The generation of a slot is incremented when an element is created in it and when it is
+// destroyed, so it is odd while the slot is taken. A Handle keeps the index and the generation,
+// and get detects in O(1) that its element was destroyed, even if the slot holds another one now.
+// Slot memory is never given back, only reused for elements of the same T, so a handle
+// can be checked at any time, also after the heap which created the element is gone.
+// Free slots are cached by every thread, batches of them go through a common list under a mutex.
+// After 2^31 reuses of one slot the generation wraps and a stale handle may match again.
+// Engines keep their nodes here with SlotMapStorage, see NodeStorage.h.
+template <class T>
+class SlotMap {
+public:
+    class Handle {
+        friend SlotMap<T>;
+    private:
+        uint32_t index;
+        uint32_t generation;
+        Handle(uint32_t index_, uint32_t generation_);
+    public:
+        // refers to no element
+        Handle();
+    };
+
+    // constructs an element from the arguments in a free slot
+    template <class... Args>
+    static T *create(Args&&... args);
+    static void destroy(T*);
+    static Handle handle(const T*);
+    // the element of the handle, nullptr if it was destroyed
+    static T *get(Handle);
+    // bytes one element takes in the table
+    static size_t slot_bytes();
+    // bytes of all chunks of the table, the most it ever needed in this process
+    static size_t table_bytes();
+
+private:
+    static const uint32_t NO_SLOT = UINT32_MAX;
+    // chunk c has FIRST_CHUNK << c slots, chunks are never moved or freed
+    static const uint64_t FIRST_CHUNK = 1024;
+    static const int MAX_CHUNKS = 22;
+    // amount of slots which move between a thread and the common list at once
+    static const size_t BATCH = 64;
+
+    struct Slot {
+        // the element while the slot is taken, the index of the next free slot otherwise
+        typename std::aligned_storage<(sizeof(T) > sizeof(uint32_t) ? sizeof(T) : sizeof(uint32_t)),
+                                      (alignof(T) > alignof(uint32_t) ? alignof(T) : alignof(uint32_t))>::type storage;
+        std::atomic<uint32_t> generation;
+        uint32_t index;
+    };
+
+    struct Shared {
+        std::mutex mutex;
+        std::atomic<Slot*> chunks[MAX_CHUNKS];
+        // slots below next_index were handed out at least once
+        uint64_t next_index;
+        uint32_t free_head;
+        size_t free_count;
+        Shared();
+    };
+
+    struct Cache {
+        uint32_t free_head;
+        size_t free_count;
+        Cache();
+        // slots of a finished thread are left for others
+        ~Cache();
+    };
+
+    static Shared &shared();
+    static Cache &cache();
+    static Slot *slot(uint32_t index);
+    static uint32_t &next_free(Slot*);
+    static uint32_t take_slot();
+    static void put_slot(uint32_t index);
+    static void refill(Cache&);
+    static void give_back(Cache&, size_t count);
+};
+
+
+
+template <class T>
+SlotMap<T>::Handle::Handle() {
+    index = 0;
+    generation = 0;
+}
+
+
+template <class T>
+SlotMap<T>::Handle::Handle(uint32_t index_, uint32_t generation_) {
+    index = index_;
+    generation = generation_;
+}
+
+
+
+template <class T>
+template <class... Args>
+T *SlotMap<T>::create(Args&&... args) {
+    uint32_t index = take_slot();
+    Slot *s = slot(index);
+    T *element;
+    try {
+        element = new (&s->storage) T(std::forward<Args>(args)...);
+    }
+    catch (...) {
+        put_slot(index);
+        throw;
+    }
+    s->generation.store(s->generation.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    return element;
+}
+
+
+template <class T>
+void SlotMap<T>::destroy(T *element) {
+    Slot *s = reinterpret_cast<Slot*>(element);
+    element->~T();
+    s->generation.store(s->generation.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    put_slot(s->index);
+}
+
+
+template <class T>
+typename SlotMap<T>::Handle SlotMap<T>::handle(const T *element) {
+    const Slot *s = reinterpret_cast<const Slot*>(element);
+    return Handle(s->index, s->generation.load(std::memory_order_relaxed));
+}
+
+
+template <class T>
+T *SlotMap<T>::get(Handle handle) {
+    // generations of taken slots are odd, so the default handle never matches,
+    // and any other one was made from a slot whose chunk exists
+    if (handle.generation % 2 == 0) {
+        return nullptr;
+    }
+    Slot *s = slot(handle.index);
+    if (s->generation.load(std::memory_order_acquire) != handle.generation) {
+        return nullptr;
+    }
+    return reinterpret_cast<T*>(&s->storage);
+}
+
+
+template <class T>
+size_t SlotMap<T>::slot_bytes() {
+    return sizeof(Slot);
+}
+
+
+template <class T>
+size_t SlotMap<T>::table_bytes() {
+    size_t bytes = 0;
+    for (int c = 0; c < MAX_CHUNKS; ++c) {
+        if (shared().chunks[c].load(std::memory_order_acquire) != nullptr) {
+            bytes += (FIRST_CHUNK << c) * sizeof(Slot);
+        }
+    }
+    return bytes;
+}
+
+
+
+template <class T>
+SlotMap<T>::Shared::Shared() {
+    for (int i = 0; i < MAX_CHUNKS; ++i) {
+        chunks[i].store(nullptr);
+    }
+    next_index = 0;
+    free_head = NO_SLOT;
+    free_count = 0;
+}
+
+
+template <class T>
+SlotMap<T>::Cache::Cache() {
+    free_head = NO_SLOT;
+    free_count = 0;
+}
+
+
+template <class T>
+SlotMap<T>::Cache::~Cache() {
+    give_back(*this, free_count);
+}
+
+
+template <class T>
+typename SlotMap<T>::Shared &SlotMap<T>::shared() {
+    // never destroyed: handles may be checked and thread caches returned until the very end
+    static Shared *instance = new Shared();
+    return *instance;
+}
+
+
+template <class T>
+typename SlotMap<T>::Cache &SlotMap<T>::cache() {
+    static thread_local Cache instance;
+    return instance;
+}
+
+
+template <class T>
+typename SlotMap<T>::Slot *SlotMap<T>::slot(uint32_t index) {
+    // chunk c starts at index FIRST_CHUNK * (2^c - 1)
+    uint64_t chunk_number = index / FIRST_CHUNK + 1;
+    int c = 63 - __builtin_clzll(chunk_number);
+    return shared().chunks[c].load(std::memory_order_acquire) + (index - FIRST_CHUNK * (((uint64_t)1 << c) - 1));
+}
+
+
+template <class T>
+uint32_t &SlotMap<T>::next_free(Slot *s) {
+    return *reinterpret_cast<uint32_t*>(&s->storage);
+}
+
+
+template <class T>
+uint32_t SlotMap<T>::take_slot() {
+    Cache &own = cache();
+    if (own.free_count == 0) {
+        refill(own);
+    }
+    uint32_t index = own.free_head;
+    own.free_head = next_free(slot(index));
+    --own.free_count;
+    return index;
+}
+
+
+template <class T>
+void SlotMap<T>::put_slot(uint32_t index) {
+    Cache &own = cache();
+    next_free(slot(index)) = own.free_head;
+    own.free_head = index;
+    ++own.free_count;
+    if (own.free_count >= 2 * BATCH) {
+        give_back(own, BATCH);
+    }
+}
+
+
+template <class T>
+void SlotMap<T>::refill(Cache &own) {
+    Shared &common = shared();
+    std::lock_guard<std::mutex> lock(common.mutex);
+    if (common.free_count > 0) {
+        // the first free slots of the common list are cut off together
+        size_t count = common.free_count < BATCH ? common.free_count : BATCH;
+        uint32_t last = common.free_head;
+        for (size_t i = 1; i < count; ++i) {
+            last = next_free(slot(last));
+        }
+        own.free_head = common.free_head;
+        common.free_head = next_free(slot(last));
+        next_free(slot(last)) = NO_SLOT;
+        own.free_count = count;
+        common.free_count -= count;
+        return;
+    }
+    for (size_t i = 0; i < BATCH; ++i) {
+        uint64_t index = common.next_index;
+        uint64_t chunk_number = index / FIRST_CHUNK + 1;
+        int c = 63 - __builtin_clzll(chunk_number);
+        if (c >= MAX_CHUNKS) {
+            if (own.free_count > 0) {
+                return;
+            }
+            throw std::length_error("SlotMap has no free slots");
+        }
+        if (common.chunks[c].load(std::memory_order_relaxed) == nullptr) {
+            uint64_t length = FIRST_CHUNK << c;
+            Slot *chunk = new Slot[length];
+            for (uint64_t j = 0; j < length; ++j) {
+                chunk[j].generation.store(0, std::memory_order_relaxed);
+                chunk[j].index = (uint32_t)(index + j);
+            }
+            common.chunks[c].store(chunk, std::memory_order_release);
+        }
+        ++common.next_index;
+        next_free(slot((uint32_t)index)) = own.free_head;
+        own.free_head = (uint32_t)index;
+        ++own.free_count;
+    }
+}
+
+
+template <class T>
+void SlotMap<T>::give_back(Cache &own, size_t count) {
+    if (count == 0) {
+        return;
+    }
+    // the slots freed last are kept, they are the most likely to be in the cache
+    size_t keep = own.free_count - count;
+    uint32_t first = own.free_head, kept_last = NO_SLOT;
+    for (size_t i = 0; i < keep; ++i) {
+        kept_last = first;
+        first = next_free(slot(first));
+    }
+    uint32_t last = first;
+    for (size_t i = 1; i < count; ++i) {
+        last = next_free(slot(last));
+    }
+    if (kept_last == NO_SLOT) {
+        own.free_head = NO_SLOT;
+    }
+    else {
+        next_free(slot(kept_last)) = NO_SLOT;
+    }
+    own.free_count = keep;
+    Shared &common = shared();
+    std::lock_guard<std::mutex> lock(common.mutex);
+    next_free(slot(last)) = common.free_head;
+    common.free_head = first;
+    common.free_count += count;
+}
+
+
+#endif //HEAP_SLOTMAP_H
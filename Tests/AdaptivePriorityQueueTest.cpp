@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "../AdaptivePriorityQueue.h"
+#include "../Heap.h"
+#include "../FibonacciHeap.h"
+#include "TimeReport.h"
+#include <queue>
+#include <set>
+
+using testing::Eq;
+
+
+static_assert(!std::is_copy_constructible<AdaptivePriorityQueue<int> >::value, "AdaptivePriorityQueue can't be copied");
+
+
+TEST(InsertExtractRandOrder, AdaptivePriorityQueueCorrectnessTests) {
+    AdaptivePriorityQueue<int> h;
+    std::priority_queue<int> h2;
+
+    srand(139);
+    for (int i = 0; i < 100000; ++i) {
+        if (rand() % 3) {
+            int x = rand() % 1000;
+            h.insert(x);
+            h2.push(-x);
+        }
+        else if (!h.is_empty()) {
+            ASSERT_EQ(h.get_min(), -h2.top());
+            ASSERT_EQ(h.extract_min(), -h2.top());
+            h2.pop();
+        }
+    }
+    ASSERT_EQ(h.size(), h2.size());
+}
+
+
+TEST(PointersSurviveMigrations, AdaptivePriorityQueueCorrectnessTests) {
+    AdaptivePriorityQueue<int> h;
+    h.set_period(0);
+    Vector<AdaptivePriorityQueue<int>::Pointer> arr;
+    std::multiset<int> s;
+    for (int i = 0; i < 1000; ++i) {
+        arr.push_back(h.insert(i * 10));
+        s.insert(i * 10);
+    }
+
+    AdaptivePriorityQueue<int>::EngineKind kinds[] = {
+        AdaptivePriorityQueue<int>::FIBONACCI, AdaptivePriorityQueue<int>::BINOMIAL,
+        AdaptivePriorityQueue<int>::HEAP, AdaptivePriorityQueue<int>::BINOMIAL,
+        AdaptivePriorityQueue<int>::FIBONACCI, AdaptivePriorityQueue<int>::HEAP
+    };
+    srand(2020);
+    for (int round = 0; round < 6; ++round) {
+        h.migrate(kinds[round]);
+        ASSERT_EQ(h.engine(), kinds[round]);
+        for (int i = 0; i < 100; ++i) {
+            int id = rand() % arr.size();
+            int x = arr[id].getKey() + rand() % 100 - 70;
+            s.erase(s.find(arr[id].getKey()));
+            s.insert(x);
+            h.change(arr[id], x);
+            ASSERT_EQ(arr[id].getKey(), x);
+            ASSERT_EQ(h.get_min(), *s.begin());
+        }
+    }
+    ASSERT_EQ(h.migrations(), 6);
+
+    // erase every other element, the rest must come out in order
+    for (size_t i = 0; i < arr.size(); i += 2) {
+        s.erase(s.find(arr[i].getKey()));
+        h.erase(arr[i]);
+    }
+    ASSERT_EQ(h.size(), s.size());
+    for (std::multiset<int>::iterator it = s.begin(); it != s.end(); ++it) {
+        ASSERT_EQ(h.extract_min(), *it);
+    }
+    ASSERT_EQ(h.is_empty(), true);
+}
+
+
+TEST(FollowsPhases, AdaptivePriorityQueueCorrectnessTests) {
+    // ingestion, relaxation with many decreases, drain
+    int n = 20000;
+    AdaptivePriorityQueue<long long> h;
+    Vector<AdaptivePriorityQueue<long long>::Pointer> arr;
+    srand(5);
+    for (int i = 0; i < n; ++i) {
+        arr.push_back(h.insert(1000000000LL + rand()));
+    }
+    // cheaper inserts don't pay for a move
+    ASSERT_EQ(h.engine(), AdaptivePriorityQueue<long long>::HEAP);
+
+    for (int i = 0; i < 3 * n; ++i) {
+        int id = rand() % n;
+        h.decrease(arr[id], arr[id].getKey() - rand() % 100);
+    }
+    ASSERT_EQ(h.engine(), AdaptivePriorityQueue<long long>::FIBONACCI);
+
+    long long last = -1;
+    for (int i = 0; i < n; ++i) {
+        long long x = h.extract_min();
+        ASSERT_LE(last, x);
+        last = x;
+        if (i == n * 3 / 4) {
+            ASSERT_EQ(h.engine(), AdaptivePriorityQueue<long long>::HEAP);
+        }
+    }
+    ASSERT_EQ(h.is_empty(), true);
+    ASSERT_GE(h.migrations(), 2);
+}
+
+
+TEST(DecreaseValidation, AdaptivePriorityQueueValidationTests) {
+    AdaptivePriorityQueue<int> h;
+    AdaptivePriorityQueue<int>::Pointer ptr = h.insert(5);
+    ASSERT_THROW(h.decrease(ptr, 6), std::invalid_argument);
+    ASSERT_EQ(h.extract_min(), 5);
+    ASSERT_THROW(h.extract_min(), std::logic_error);
+    ASSERT_THROW(h.get_min(), std::logic_error);
+}
+
+
+template <class Queue>
+int phasesTime(Queue &h) {
+    int n = 1000000;
+    Vector<typename Queue::Pointer> arr;
+    srand(5);
+    time_t t0 = clock();
+    for (int i = 0; i < n; ++i) {
+        arr.push_back(h.insert(1000000000LL + rand()));
+    }
+    for (int i = 0; i < 3 * n; ++i) {
+        int id = rand() % n;
+        h.decrease(arr[id], arr[id].getKey() - rand());
+    }
+    while (!h.is_empty()) {
+        h.extract_min();
+    }
+    return clock() - t0;
+}
+
+
+TEST(Phases, DISABLED_AdaptivePriorityQueueTimeTests) {
+    AdaptivePriorityQueue<long long> adaptive;
+    reportTime("AdaptivePriorityQueue ingest, decrease, drain", phasesTime(adaptive));
+
+    AdaptivePriorityQueue<long long> heap_only;
+    heap_only.set_period(0);
+    reportTime("AdaptivePriorityQueue pinned to Heap ingest, decrease, drain", phasesTime(heap_only));
+
+    AdaptivePriorityQueue<long long> fibonacci_only;
+    fibonacci_only.set_period(0);
+    fibonacci_only.migrate(AdaptivePriorityQueue<long long>::FIBONACCI);
+    reportTime("AdaptivePriorityQueue pinned to FibonacciHeap ingest, decrease, drain", phasesTime(fibonacci_only));
+}
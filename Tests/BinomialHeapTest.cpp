@@ -8,6 +8,9 @@
 using testing::Eq;
 
 
+static_assert(!std::is_copy_constructible<BinomialHeap<int> >::value, "BinomialHeap can't be copied");
+
+
 TEST(InsertExtract, BinomialHeapCorrectnessTests) {
     int q = 1000;
     BinomialHeap<int> h;
@@ -109,6 +112,26 @@ TEST(ChangeMethod, BinomialHeapCorrectnessTests) {
 }
 
 
+TEST(ChangeKeepsPointers, BinomialHeapCorrectnessTests) {
+    BinomialHeap<int> h;
+    Vector<BinomialHeap<int>::Pointer> arr;
+    for (int i = 0; i < 100; ++i) {
+        arr.push_back(h.insert(i));
+    }
+    h.change(arr[50], -1);
+    h.change(arr[0], 200);
+    h.change(arr[99], 1);
+    ASSERT_EQ(arr[50].getKey(), -1);
+    ASSERT_EQ(arr[0].getKey(), 200);
+    ASSERT_EQ(arr[99].getKey(), 1);
+    h.change(arr[0], 0);
+    ASSERT_EQ(h.extract_min(), -1);
+    ASSERT_EQ(h.extract_min(), 0);
+    ASSERT_EQ(h.extract_min(), 1);
+    ASSERT_EQ(h.extract_min(), 1);
+}
+
+
 TEST(MergeHeaps, BinomialHeapCorrectnessTests) {
     srand(34234);
     Vector<int> qs;
@@ -178,6 +201,86 @@ TEST(MergeHeapsStressWithFibonacciHeap, BinomialHeapCorrecnessTests) {
 
 
 
+TEST(SaveLoad, BinomialHeapCorrectnessTests) {
+    std::string path = testing::TempDir() + "binomial_heap_snapshot";
+    srand(142);
+    BinomialHeap<int> h;
+    std::priority_queue<int> h2;
+    for (int i = 0; i < 10000; ++i) {
+        int x = rand();
+        h.insert(x);
+        h2.push(-x);
+        if (i % 3 == 0) {
+            ASSERT_EQ(h.extract_min(), -h2.top());
+            h2.pop();
+        }
+    }
+    h.save(path);
+
+    BinomialHeap<int> loaded;
+    loaded.insert(-1);
+    loaded.load(path);
+    // the loaded trees must keep working with inserts, not only extracts
+    for (int i = 0; i < 1000; ++i) {
+        int x = rand();
+        loaded.insert(x);
+        h2.push(-x);
+    }
+    while (!h2.empty()) {
+        ASSERT_EQ(loaded.extract_min(), -h2.top());
+        h2.pop();
+    }
+    ASSERT_EQ(loaded.is_empty(), true);
+    remove(path.c_str());
+}
+
+
+TEST(Stats, BinomialHeapCorrectnessTests) {
+    // 1024 inserts work as a binary counter: every link carries a tree to the next order
+    BinomialHeap<int> h;
+    Vector<BinomialHeap<int>::Pointer> pointers;
+    for (int i = 0; i < 1024; ++i) {
+        pointers.push_back(h.insert(i));
+    }
+    HeapStats stats = h.stats();
+    if (!HeapStats::enabled()) {
+        ASSERT_EQ(stats.allocations, 0u);
+        ASSERT_EQ(stats.links, 0u);
+        return;
+    }
+    ASSERT_EQ(stats.allocations, 1024u);
+    ASSERT_EQ(stats.links, 1023u);
+    ASSERT_EQ(stats.carries, 1023u);
+    ASSERT_EQ(stats.swaps, 0u);
+
+    // the last key is a leaf 10 levels below the root
+    h.reset_stats();
+    h.change(pointers[1023], -1);
+    ASSERT_EQ(h.stats().swaps, 10u);
+    ASSERT_EQ(h.stats().sift_depths[10], 1u);
+    ASSERT_EQ(h.extract_min(), -1);
+}
+
+
+TEST(MemoryUsage, BinomialHeapCorrectnessTests) {
+    BinomialHeap<int> h, other;
+    for (int i = 0; i < 1000; ++i) {
+        h.insert(i);
+        other.insert(i);
+    }
+    h.merge(other);
+    MemoryUsage usage = h.memory_usage();
+    ASSERT_EQ(usage.elements, 2000u);
+    // a node has 3 brother and child links and 2 LayerNode pointers, a LayerNode has the parent
+    ASSERT_GE(usage.bytes_per_element(), 6 * sizeof(void*) + sizeof(int));
+    ASSERT_EQ(other.memory_usage().elements, 0u);
+    for (int i = 0; i < 2000; ++i) {
+        h.extract_min();
+    }
+    ASSERT_EQ(h.memory_usage().elements, 0u);
+}
+
+
 TEST(GetMinOnEmptyHeap, BinomialHeapValidationTests) {
     BinomialHeap<int> h;
     ASSERT_THROW(h.get_min(), std::logic_error);
@@ -199,6 +302,85 @@ TEST(ExtractMinOnEmptyHeap, BinomialHeapValidationTests) {
 }
 
 
+TEST(RemovedElementPointer, BinomialHeapValidationTests) {
+    BinomialHeap<int, SlotMapStorage> h;
+    BinomialHeap<int, SlotMapStorage>::Pointer extracted = h.insert(1);
+    BinomialHeap<int, SlotMapStorage>::Pointer erased = h.insert(2);
+    BinomialHeap<int, SlotMapStorage>::Pointer kept = h.insert(3);
+    ASSERT_EQ(h.extract_min(), 1);
+    h.erase(erased);
+    BinomialHeap<int, SlotMapStorage>::Pointer reused = h.insert(4);
+    ASSERT_THROW(h.change(extracted, 0), std::invalid_argument);
+    ASSERT_THROW(h.erase(erased), std::invalid_argument);
+    ASSERT_THROW(extracted.getKey(), std::invalid_argument);
+    ASSERT_EQ(kept.getKey(), 3);
+    h.change(reused, 0);
+    ASSERT_EQ(h.extract_min(), 0);
+    ASSERT_EQ(h.extract_min(), 3);
+}
+
+
+// the layout of BinomialHeap's snapshot records
+struct BinomialRecord {
+    int key;
+    uint64_t parent;
+};
+
+
+static void write_binomial_snapshot(const std::string &path, const int keys[], const uint64_t parents[], size_t count) {
+    SnapshotWriter writer(path, "BINOSNP1", sizeof(int), 0, count);
+    for (size_t i = 0; i < count; ++i) {
+        BinomialRecord record;
+        memset(&record, 0, sizeof(record));
+        record.key = keys[i];
+        record.parent = parents[i];
+        writer.write(record);
+    }
+    writer.close();
+}
+
+
+TEST(LoadCorruptedSnapshot, BinomialHeapValidationTests) {
+    std::string path = testing::TempDir() + "binomial_heap_snapshot";
+    BinomialHeap<int> h;
+    h.insert(-1);
+    h.insert(7);
+    // two roots of order 0
+    int two_roots[] = {5, 3};
+    uint64_t two_roots_parents[] = {0, 1};
+    write_binomial_snapshot(path, two_roots, two_roots_parents, 2);
+    ASSERT_THROW(h.load(path), std::runtime_error);
+    // a child less than its parent
+    int inverted[] = {5, 3};
+    uint64_t inverted_parents[] = {0, 0};
+    write_binomial_snapshot(path, inverted, inverted_parents, 2);
+    ASSERT_THROW(h.load(path), std::runtime_error);
+    // a root with two leaves is not a binomial tree
+    int wide[] = {1, 2, 3};
+    uint64_t wide_parents[] = {0, 0, 0};
+    write_binomial_snapshot(path, wide, wide_parents, 3);
+    ASSERT_THROW(h.load(path), std::runtime_error);
+    // a child of order 0 before the one of order 1
+    int reordered[] = {1, 2, 3, 4};
+    uint64_t reordered_parents[] = {0, 0, 0, 2};
+    write_binomial_snapshot(path, reordered, reordered_parents, 4);
+    ASSERT_THROW(h.load(path), std::runtime_error);
+    // the content stays when the file is rejected
+    ASSERT_EQ(h.extract_min(), -1);
+    ASSERT_EQ(h.extract_min(), 7);
+    ASSERT_EQ(h.is_empty(), true);
+
+    int valid[] = {1, 2, 4, 3};
+    uint64_t valid_parents[] = {0, 0, 1, 0};
+    write_binomial_snapshot(path, valid, valid_parents, 4);
+    h.load(path);
+    for (int i = 1; i <= 4; ++i) {
+        ASSERT_EQ(h.extract_min(), i);
+    }
+    remove(path.c_str());
+}
+
+
 TEST(DISABLED_InsertExtract, BinomialHeapTimeTests) {
     time_t t0 = clock();
 
@@ -0,0 +1,320 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "../BucketQueue.h"
+#include "../Heap.h"
+#include "TimeReport.h"
+#include <queue>
+#include <set>
+
+using testing::Eq;
+
+
+TEST(InsertExtract, BucketQueueCorrectnessTests) {
+    int q = 1000;
+    BucketQueue<int> h(q);
+
+    ASSERT_EQ(h.is_empty(), true);
+    for (int i = q - 1; i >= 0; --i) {
+        h.insert(i);
+    }
+    for (int i = 0; i < q; ++i) {
+        ASSERT_EQ(h.extract_min(), i);
+    }
+    ASSERT_EQ(h.is_empty(), true);
+}
+
+
+TEST(InsertExtractRandOrder, BucketQueueCorrectnessTests) {
+    int q = 1000;
+    BucketQueue<int> h(100);
+    std::priority_queue<int> h2;
+
+    srand(139);
+    for (int i = 0; i < q; ++i) {
+        if (rand() % 3) {
+            int x = rand() % 100;
+            h.insert(x);
+            h2.push(-x);
+        }
+        else if (!h.is_empty()) {
+            ASSERT_EQ(h.extract_min(), -h2.top());
+            h2.pop();
+        }
+    }
+}
+
+
+TEST(SparseKeysInLargeRange, BucketQueueCorrectnessTests) {
+    // keys far from each other make find_next go through the summary words
+    int range = 1 << 20;
+    BucketQueue<int> h(range);
+    std::multiset<int> s;
+
+    srand(4096);
+    for (int i = 0; i < 300; ++i) {
+        int x = (int)(((long long)rand() * 7919 + rand()) % range);
+        h.insert(x);
+        s.insert(x);
+    }
+    h.insert(range - 1);
+    s.insert(range - 1);
+    while (!s.empty()) {
+        ASSERT_EQ(h.get_min(), *s.begin());
+        ASSERT_EQ(h.extract_min(), *s.begin());
+        s.erase(s.begin());
+    }
+    ASSERT_EQ(h.is_empty(), true);
+}
+
+
+TEST(InsertEraseByPointer, BucketQueueCorrectnessTests) {
+    srand(1791791791);
+    int q = 1000;
+
+    BucketQueue<int> h(q);
+    Vector<BucketQueue<int>::Pointer> arr;
+    for (int i = 0; i < q; ++i) {
+        arr.push_back(h.insert(i));
+    }
+
+    Vector<bool> alive(arr.size(), true);
+    for (int i = 0; i < q - 1; ++i) {
+        int id = rand() % (q - i);
+        Vector<int> pos;
+        for (int j = 0; j < q; ++j) {
+            if (alive[j]) {
+                pos.push_back(j);
+            }
+        }
+        int index = pos[id];
+        h.erase(arr[index]);
+        alive[index] = false;
+
+        for (size_t j = id; j + 1 < pos.size(); ++j) {
+            pos[j] = pos[j + 1];
+        }
+        pos.pop_back();
+
+        ASSERT_EQ(arr[pos[0]].getKey(), h.get_min());
+        ASSERT_EQ(h.is_empty(), false);
+    }
+    h.extract_min();
+    ASSERT_EQ(h.is_empty(), true);
+}
+
+
+TEST(ChangeMethod, BucketQueueCorrectnessTests) {
+    BucketQueue<int> h(10);
+    BucketQueue<int>::Pointer ptr = h.insert(1);
+    h.insert(2);
+    h.insert(3);
+    ASSERT_EQ(h.get_min(), 1);
+    h.change(ptr, 4);
+    ASSERT_EQ(h.get_min(), 2);
+    h.extract_min();
+    h.extract_min();
+    ASSERT_EQ(h.extract_min(), 4);
+    ASSERT_EQ(h.is_empty(), true);
+}
+
+
+TEST(SlidingWindow, CalendarQueueCorrectnessTests) {
+    // timestamps move forward, every key is within window of the last extracted one
+    int window = 4096;
+    CalendarQueue<long long> h(window);
+    std::multiset<long long> s;
+
+    srand(77);
+    long long now = 1000000;
+    for (int i = 0; i < 100000; ++i) {
+        if (s.empty() || rand() % 2) {
+            long long x = now + rand() % window;
+            if (s.empty()) {
+                // window of an empty queue starts at the first inserted key
+                now = x;
+            }
+            h.insert(x);
+            s.insert(x);
+        }
+        else {
+            ASSERT_EQ(h.get_min(), *s.begin());
+            now = h.extract_min();
+            ASSERT_EQ(now, *s.begin());
+            s.erase(s.begin());
+        }
+    }
+    while (!s.empty()) {
+        ASSERT_EQ(h.extract_min(), *s.begin());
+        s.erase(s.begin());
+    }
+    ASSERT_EQ(h.is_empty(), true);
+}
+
+
+TEST(WrapAround, CalendarQueueCorrectnessTests) {
+    CalendarQueue<int> h(8);
+    h.insert(6);
+    h.insert(9);
+    h.insert(7);
+    ASSERT_EQ(h.extract_min(), 6);
+    CalendarQueue<int>::Pointer ptr = h.insert(12);
+    h.insert(13);
+    ASSERT_EQ(h.extract_min(), 7);
+    h.change(ptr, 8);
+    ASSERT_EQ(h.extract_min(), 8);
+    ASSERT_EQ(h.extract_min(), 9);
+    ASSERT_EQ(h.extract_min(), 13);
+    ASSERT_EQ(h.is_empty(), true);
+}
+
+
+TEST(KeyOutOfRange, BucketQueueValidationTests) {
+    BucketQueue<int> h(10);
+    ASSERT_THROW(h.insert(10), std::out_of_range);
+    ASSERT_THROW(h.insert(-1), std::out_of_range);
+    BucketQueue<int>::Pointer ptr = h.insert(9);
+    ASSERT_THROW(h.change(ptr, 100), std::out_of_range);
+    ASSERT_EQ(h.extract_min(), 9);
+}
+
+
+TEST(UnsignedKeys, BucketQueueValidationTests) {
+    BucketQueue<unsigned> h(10);
+    ASSERT_THROW(h.insert(10u), std::out_of_range);
+    h.insert(0u);
+    ASSERT_EQ(h.extract_min(), 0u);
+    CalendarQueue<unsigned> calendar(10);
+    calendar.insert(100u);
+    ASSERT_THROW(calendar.insert(99u), std::out_of_range);
+    ASSERT_EQ(calendar.extract_min(), 100u);
+}
+
+
+TEST(NarrowKeys, BucketQueueValidationTests) {
+    // 256 buckets don't fit into uint8_t, every key must still be accepted
+    BucketQueue<uint8_t> h(256);
+    for (int i = 255; i >= 0; --i) {
+        h.insert((uint8_t)i);
+    }
+    for (int i = 0; i < 256; ++i) {
+        ASSERT_EQ(h.extract_min(), (uint8_t)i);
+    }
+    CalendarQueue<uint8_t> calendar(256);
+    calendar.insert(200);
+    calendar.insert(255);
+    calendar.insert(201);
+    ASSERT_EQ(calendar.extract_min(), 200);
+    ASSERT_EQ(calendar.extract_min(), 201);
+    ASSERT_EQ(calendar.extract_min(), 255);
+}
+
+
+TEST(EmptyQueue, BucketQueueValidationTests) {
+    BucketQueue<int> h(10);
+    ASSERT_THROW(h.get_min(), std::logic_error);
+    ASSERT_THROW(h.extract_min(), std::logic_error);
+    h.insert(1);
+    ASSERT_NO_THROW(h.get_min());
+    ASSERT_NO_THROW(h.extract_min());
+}
+
+
+TEST(DestroyedQueuePointers, BucketQueueValidationTests) {
+    Vector<BucketQueue<int, SlotMapStorage>::Pointer> pointers;
+    Vector<CalendarQueue<int, SlotMapStorage>::Pointer> calendar_pointers;
+    {
+        BucketQueue<int, SlotMapStorage> h(100);
+        CalendarQueue<int, SlotMapStorage> calendar(100);
+        for (int i = 0; i < 1000; ++i) {
+            pointers.push_back(h.insert(i % 100));
+            calendar_pointers.push_back(calendar.insert(i % 100));
+        }
+    }
+    for (size_t i = 0; i < pointers.size(); ++i) {
+        ASSERT_THROW(pointers[i].getKey(), std::invalid_argument);
+        ASSERT_THROW(calendar_pointers[i].getKey(), std::invalid_argument);
+    }
+}
+
+
+TEST(KeyOutOfWindow, CalendarQueueValidationTests) {
+    CalendarQueue<int> h(10);
+    h.insert(100);
+    ASSERT_THROW(h.insert(99), std::out_of_range);
+    ASSERT_THROW(h.insert(110), std::out_of_range);
+    CalendarQueue<int>::Pointer ptr = h.insert(109);
+    ASSERT_THROW(h.change(ptr, 120), std::out_of_range);
+    ASSERT_EQ(ptr.getKey(), 109);
+    ASSERT_EQ(h.extract_min(), 100);
+    ASSERT_EQ(h.extract_min(), 109);
+    ASSERT_THROW(h.extract_min(), std::logic_error);
+}
+
+
+TEST(InsertExtract, DISABLED_BucketQueueTimeTests) {
+    time_t t0 = clock();
+
+    int q = 5000000;
+    BucketQueue<int> h(4096);
+    srand(239);
+    for (int i = 0; i < q; ++i) {
+        if (!h.is_empty() && !(rand() % 3)) {
+            h.extract_min();
+        }
+        else {
+            h.insert(rand() % 4096);
+        }
+    }
+
+    int res = clock() - t0;
+
+    reportTime("BucketQueue inserts and extracts, keys in [0, 4096)", res);
+}
+
+
+TEST(HeapInsertExtract, DISABLED_BucketQueueTimeTests) {
+    // the same workload on Heap<int> for comparison
+    time_t t0 = clock();
+
+    int q = 5000000;
+    Heap<int> h;
+    srand(239);
+    for (int i = 0; i < q; ++i) {
+        if (!h.is_empty() && !(rand() % 3)) {
+            h.extract_min();
+        }
+        else {
+            h.insert(rand() % 4096);
+        }
+    }
+
+    int res = clock() - t0;
+
+    reportTime("Heap inserts and extracts, keys in [0, 4096)", res);
+}
+
+
+TEST(SlidingWindow, DISABLED_BucketQueueTimeTests) {
+    time_t t0 = clock();
+
+    int q = 5000000;
+    CalendarQueue<long long> h(4096);
+    srand(239);
+    long long now = 0;
+    for (int i = 0; i < q; ++i) {
+        if (!h.is_empty() && !(rand() % 3)) {
+            now = h.extract_min();
+        }
+        else {
+            long long x = now + rand() % 4096;
+            if (h.is_empty()) {
+                now = x;
+            }
+            h.insert(x);
+        }
+    }
+
+    int res = clock() - t0;
+
+    reportTime("CalendarQueue inserts and extracts, window 4096", res);
+}
@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "../ConcurrentHeap.h"
+#include "../Heap.h"
+#include "TimeReport.h"
+#include "LockedHeap.h"
+#include <queue>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <chrono>
+
+using testing::Eq;
+
+
+TEST(InsertExtractRandOrder, ConcurrentHeapCorrectnessTests) {
+    int q = 100000;
+    ConcurrentHeap<int> h(q);
+    std::priority_queue<int> h2;
+
+    srand(139);
+    for (int i = 0; i < q; ++i) {
+        if (rand() % 3) {
+            int x = rand() % 1000;
+            h.insert(x);
+            h2.push(-x);
+        }
+        else if (!h.is_empty()) {
+            ASSERT_EQ(h.extract_min(), -h2.top());
+            h2.pop();
+        }
+    }
+    ASSERT_EQ(h.size(), h2.size());
+}
+
+
+TEST(ParallelInsertThenExtract, ConcurrentHeapCorrectnessTests) {
+    int threads = 8, per_thread = 20000;
+    ConcurrentHeap<int> h(threads * per_thread);
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.push_back(std::thread([&h, t, threads, per_thread]() {
+            for (int i = 0; i < per_thread; ++i) {
+                h.insert(i * threads + t);
+            }
+        }));
+    }
+    for (int t = 0; t < threads; ++t) {
+        workers[t].join();
+    }
+    ASSERT_EQ(h.size(), threads * per_thread);
+    for (int i = 0; i < threads * per_thread; ++i) {
+        ASSERT_EQ(h.extract_min(), i);
+    }
+    ASSERT_EQ(h.is_empty(), true);
+}
+
+
+TEST(ParallelMixedEveryKeyOnce, ConcurrentHeapCorrectnessTests) {
+    // producers and consumers at the same time, every key must come out exactly once
+    int producers = 4, consumers = 4, per_producer = 50000;
+    ConcurrentHeap<int> h(producers * per_producer);
+    std::vector<std::atomic<int> > seen(producers * per_producer);
+    for (int i = 0; i < producers * per_producer; ++i) {
+        seen[i] = 0;
+    }
+    std::atomic<int> extracted(0);
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < producers; ++t) {
+        workers.push_back(std::thread([&h, t, producers, per_producer]() {
+            for (int i = 0; i < per_producer; ++i) {
+                h.insert(i * producers + t);
+            }
+        }));
+    }
+    for (int t = 0; t < consumers; ++t) {
+        workers.push_back(std::thread([&h, &seen, &extracted, producers, per_producer]() {
+            int key;
+            while (extracted.load() < producers * per_producer) {
+                if (h.try_extract_min(key)) {
+                    ++seen[key];
+                    ++extracted;
+                }
+            }
+        }));
+    }
+    for (int t = 0; t < (int)workers.size(); ++t) {
+        workers[t].join();
+    }
+    for (int i = 0; i < producers * per_producer; ++i) {
+        ASSERT_EQ(seen[i].load(), 1);
+    }
+    ASSERT_EQ(h.is_empty(), true);
+}
+
+
+TEST(CapacityAndEmpty, ConcurrentHeapValidationTests) {
+    ConcurrentHeap<int> h(2);
+    int x;
+    ASSERT_EQ(h.try_extract_min(x), false);
+    ASSERT_THROW(h.extract_min(), std::logic_error);
+    h.insert(2);
+    h.insert(1);
+    ASSERT_THROW(h.insert(3), std::logic_error);
+    ASSERT_EQ(h.try_extract_min(x), true);
+    ASSERT_EQ(x, 1);
+    ASSERT_EQ(h.extract_min(), 2);
+}
+
+
+template <class Queue>
+int producersConsumersTime(Queue &h, int producers, int consumers, int per_producer) {
+    // consumers take everything producers put
+    std::atomic<long long> extracted(0);
+    long long total = (long long)producers * per_producer;
+    std::vector<std::thread> workers;
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    for (int t = 0; t < producers; ++t) {
+        workers.push_back(std::thread([&h, t, per_producer]() {
+            unsigned int seed = t + 1;
+            for (int i = 0; i < per_producer; ++i) {
+                h.insert(rand_r(&seed));
+            }
+        }));
+    }
+    for (int t = 0; t < consumers; ++t) {
+        workers.push_back(std::thread([&h, &extracted, total]() {
+            int key;
+            while (extracted.load() < total) {
+                if (h.try_extract_min(key)) {
+                    ++extracted;
+                }
+            }
+        }));
+    }
+    for (int t = 0; t < (int)workers.size(); ++t) {
+        workers[t].join();
+    }
+    return (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t0).count();
+}
+
+
+TEST(ProducersConsumersScaling, DISABLED_ConcurrentHeapTimeTests) {
+    // the same number of operations for every thread count
+    int total = 1600000;
+    int threads = std::max((int)std::thread::hardware_concurrency() / 2, 4);
+    for (int p = 1; p <= threads; p *= 2) {
+        ConcurrentHeap<int> concurrent(total);
+        LockedHeap<int, Heap<int> > locked;
+        std::string name = std::to_string(p) + " producers, " + std::to_string(p) + " consumers";
+        reportTime(("ConcurrentHeap " + name).c_str(), producersConsumersTime(concurrent, p, p, total / p));
+        reportTime(("Heap behind a mutex " + name).c_str(), producersConsumersTime(locked, p, p, total / p));
+    }
+}
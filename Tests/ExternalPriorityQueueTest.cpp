@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "../ExternalPriorityQueue.h"
+#include "../Heap.h"
+#include "TimeReport.h"
+#include <queue>
+#include <ctime>
+
+using testing::Eq;
+
+
+TEST(InsertExtractRandOrder, ExternalPriorityQueueCorrectnessTests) {
+    // 4 KiB budget: a few dozen keys in memory, many runs and merges of runs
+    ExternalPriorityQueue<int> h(4096);
+    std::priority_queue<int> h2;
+
+    srand(140);
+    for (int i = 0; i < 200000; ++i) {
+        if (rand() % 3) {
+            int x = rand() % 100000;
+            h.insert(x);
+            h2.push(-x);
+        }
+        else if (!h2.empty()) {
+            ASSERT_EQ(h.get_min(), -h2.top());
+            ASSERT_EQ(h.extract_min(), -h2.top());
+            h2.pop();
+        }
+        ASSERT_EQ(h.size(), h2.size());
+    }
+    ASSERT_GT(h.runs_count(), (size_t)0);
+    while (!h2.empty()) {
+        ASSERT_EQ(h.extract_min(), -h2.top());
+        h2.pop();
+    }
+    ASSERT_EQ(h.is_empty(), true);
+}
+
+
+TEST(AllInsertsThenExtracts, ExternalPriorityQueueCorrectnessTests) {
+    ExternalPriorityQueue<long long> h(1 << 14);
+    int n = 300000;
+    for (int i = 0; i < n; ++i) {
+        h.insert(((long long)i * 7919) % n);
+    }
+    for (int i = 0; i < n; ++i) {
+        ASSERT_EQ(h.extract_min(), i);
+    }
+    ASSERT_EQ(h.is_empty(), true);
+}
+
+
+TEST(ExtractMinOnEmptyQueue, ExternalPriorityQueueValidationTests) {
+    ExternalPriorityQueue<int> h(4096);
+    ASSERT_THROW(h.extract_min(), std::logic_error);
+    ASSERT_THROW(h.get_min(), std::logic_error);
+    h.insert(1);
+    h.extract_min();
+    ASSERT_THROW(h.extract_min(), std::logic_error);
+}
+
+
+TEST(WrongTempDir, ExternalPriorityQueueValidationTests) {
+    ASSERT_THROW(ExternalPriorityQueue<int> h(4096, "/nonexistent/directory"), std::runtime_error);
+}
+
+
+TEST(SpillToDisk, DISABLED_ExternalPriorityQueueTimeTests) {
+    // 3 * 10^7 keys of 8 bytes through a 64 MiB budget against Heap holding everything in memory
+    int n = 30000000;
+    {
+        ExternalPriorityQueue<long long> h;
+        srand(2024);
+        clock_t t0 = clock();
+        for (int i = 0; i < n; ++i) {
+            h.insert(((long long)rand() << 31) ^ rand());
+        }
+        clock_t t1 = clock();
+        for (int i = 0; i < n; ++i) {
+            h.extract_min();
+        }
+        clock_t t2 = clock();
+        reportTime("ExternalPriorityQueue 64 MiB budget, 3 * 10^7 inserts", (int)((t1 - t0) * 1000 / CLOCKS_PER_SEC));
+        reportTime("ExternalPriorityQueue 64 MiB budget, 3 * 10^7 extracts", (int)((t2 - t1) * 1000 / CLOCKS_PER_SEC));
+    }
+    {
+        Heap<long long> h;
+        srand(2024);
+        clock_t t0 = clock();
+        for (int i = 0; i < n; ++i) {
+            h.insert(((long long)rand() << 31) ^ rand());
+        }
+        clock_t t1 = clock();
+        for (int i = 0; i < n; ++i) {
+            h.extract_min();
+        }
+        clock_t t2 = clock();
+        reportTime("Heap, 3 * 10^7 inserts", (int)((t1 - t0) * 1000 / CLOCKS_PER_SEC));
+        reportTime("Heap, 3 * 10^7 extracts", (int)((t2 - t1) * 1000 / CLOCKS_PER_SEC));
+    }
+}
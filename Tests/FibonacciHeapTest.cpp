@@ -3,10 +3,15 @@
 #include "../FibonacciHeap.h"
 #include "TimeReport.h"
 #include <queue>
+#include <vector>
+#include <algorithm>
 
 using testing::Eq;
 
 
+static_assert(!std::is_copy_constructible<FibonacciHeap<int> >::value, "FibonacciHeap can't be copied");
+
+
 TEST(InsertExtract, FibonacciHeapCorrectnessTests) {
     int q = 1000;
     FibonacciHeap<int> h;
@@ -125,6 +130,25 @@ TEST(MergeHeaps, FibonacciHeapCorrectnessTests) {
 }
 
 
+TEST(MergeKeepsRootList, FibonacciHeapCorrectnessTests) {
+    // both root lists have several nodes, then a root of the first list is extracted
+    FibonacciHeap<int> h1, h2;
+    h1.insert(0);
+    FibonacciHeap<int>::Pointer ptr = h1.insert(1);
+    h2.insert(2);
+    h2.insert(3);
+    h1.merge(h2);
+    h1.decrease(ptr, -1);
+    ASSERT_EQ(h1.extract_min(), -1);
+    for (int i = 0; i < 4; ++i) {
+        if (i != 1) {
+            ASSERT_EQ(h1.extract_min(), i);
+        }
+    }
+    ASSERT_EQ(h1.is_empty(), true);
+}
+
+
 TEST(GetDecreaseExtract, FibonacciHeapCorrectnessTests) {
     FibonacciHeap<int> h;
     FibonacciHeap<int>::Pointer ptr1 = h.insert(1);
@@ -144,6 +168,86 @@ TEST(GetDecreaseExtract, FibonacciHeapCorrectnessTests) {
 }
 
 
+TEST(SaveLoad, FibonacciHeapCorrectnessTests) {
+    // decreases after consolidation make cut children and marks, which must survive the reload
+    std::string path = testing::TempDir() + "fibonacci_heap_snapshot";
+    srand(143);
+    int q = 10000, extracted = 1000;
+    FibonacciHeap<int> h;
+    Vector<FibonacciHeap<int>::Pointer> arr;
+    std::vector<int> keys;
+    for (int i = 0; i < q; ++i) {
+        arr.push_back(h.insert(10 * i));
+        keys.push_back(10 * i);
+    }
+    for (int i = 0; i < extracted; ++i) {
+        ASSERT_EQ(h.extract_min(), keys[i]);
+    }
+    for (int i = 0; i < 3000; ++i) {
+        int index = extracted + rand() % (q - extracted);
+        keys[index] -= rand() % (keys[index] + 1);
+        h.decrease(arr[index], keys[index]);
+    }
+    h.save(path);
+
+    FibonacciHeap<int> loaded;
+    loaded.insert(-1);
+    loaded.load(path);
+    std::sort(keys.begin() + extracted, keys.end());
+    for (int i = extracted; i < q; ++i) {
+        ASSERT_EQ(loaded.extract_min(), keys[i]);
+    }
+    ASSERT_EQ(loaded.is_empty(), true);
+    remove(path.c_str());
+}
+
+
+TEST(Stats, FibonacciHeapCorrectnessTests) {
+    FibonacciHeap<int> h;
+    std::vector<FibonacciHeap<int>::Pointer> pointers;
+    for (int i = 0; i < 100; ++i) {
+        pointers.push_back(h.insert(i));
+    }
+    // 99 roots are linked into trees of sizes 64, 32, 2 and 1
+    ASSERT_EQ(h.extract_min(), 0);
+    HeapStats stats = h.stats();
+    if (!HeapStats::enabled()) {
+        ASSERT_EQ(stats.allocations, 0u);
+        ASSERT_EQ(stats.consolidations, 0u);
+        return;
+    }
+    ASSERT_EQ(stats.allocations, 100u);
+    ASSERT_EQ(stats.consolidations, 1u);
+    ASSERT_EQ(stats.links, 95u);
+    ASSERT_EQ(stats.cascading_cuts, 0u);
+
+    // the second cut below a parent cuts the marked parent too
+    for (int i = 99; i > 0; --i) {
+        h.decrease(pointers[i], -i);
+    }
+    ASSERT_GT(h.stats().cascading_cuts, 0u);
+    ASSERT_EQ(h.extract_min(), -99);
+}
+
+
+TEST(MemoryUsage, FibonacciHeapCorrectnessTests) {
+    FibonacciHeap<int> h, other;
+    for (int i = 0; i < 100; ++i) {
+        h.insert(i);
+    }
+    for (int i = 0; i < 50; ++i) {
+        other.insert(i);
+    }
+    h.merge(other);
+    h.extract_min();
+    MemoryUsage usage = h.memory_usage();
+    ASSERT_EQ(usage.elements, 149u);
+    ASSERT_EQ(usage.slack_bytes, 0u);
+    ASSERT_GE(usage.bytes_per_element(), 4 * sizeof(void*) + sizeof(int));
+    ASSERT_EQ(other.memory_usage().live_bytes, 0u);
+}
+
+
 TEST(GetMin, FibonacciHeapValidationTests) {
     FibonacciHeap<int> h;
     ASSERT_THROW(h.get_min(), std::logic_error);
@@ -168,6 +272,52 @@ TEST(Decrease, FibonacciHeapValidationTests) {
 }
 
 
+TEST(RemovedElementPointer, FibonacciHeapValidationTests) {
+    FibonacciHeap<int, SlotMapStorage> h;
+    FibonacciHeap<int, SlotMapStorage>::Pointer extracted = h.insert(1);
+    FibonacciHeap<int, SlotMapStorage>::Pointer kept = h.insert(3);
+    ASSERT_EQ(h.extract_min(), 1);
+    FibonacciHeap<int, SlotMapStorage>::Pointer reused = h.insert(4);
+    ASSERT_THROW(h.decrease(extracted, 0), std::invalid_argument);
+    ASSERT_THROW(extracted.getKey(), std::invalid_argument);
+    ASSERT_EQ(kept.getKey(), 3);
+    h.decrease(reused, 0);
+    ASSERT_EQ(h.extract_min(), 0);
+    ASSERT_EQ(h.extract_min(), 3);
+}
+
+
+TEST(LoadCorruptedSnapshot, FibonacciHeapValidationTests) {
+    // the layout of FibonacciHeap's snapshot records
+    struct Record {
+        int key;
+        uint64_t parent;
+        bool mark;
+    };
+    std::string path = testing::TempDir() + "fibonacci_heap_snapshot";
+    Record records[3];
+    memset(records, 0, sizeof(records));
+    records[0].key = 5;
+    records[0].parent = 0;
+    records[1].key = 6;
+    records[1].parent = 0;
+    // less than its parent
+    records[2].key = 3;
+    records[2].parent = 1;
+    SnapshotWriter writer(path, "FIBOSNP1", sizeof(int), 0, 3);
+    for (int i = 0; i < 3; ++i) {
+        writer.write(records[i]);
+    }
+    writer.close();
+    FibonacciHeap<int> h;
+    h.insert(-1);
+    ASSERT_THROW(h.load(path), std::runtime_error);
+    ASSERT_EQ(h.extract_min(), -1);
+    ASSERT_EQ(h.is_empty(), true);
+    remove(path.c_str());
+}
+
+
 TEST(DISABLED_InsertExtract, FibonacciHeapTimeTests) {
     time_t t0 = clock();
 
@@ -2,12 +2,22 @@
 #include <gmock/gmock.h>
 #include <fstream>
 #include "../Heap.h"
+#include "../BinomialHeap.h"
 #include "TimeReport.h"
+#include "PerfCounters.h"
 #include <queue>
+#include <set>
+#include <chrono>
+#include <thread>
+#include <string>
 
 using testing::Eq;
 
 
+// the destructor frees the nodes, so copies are not allowed
+static_assert(!std::is_copy_constructible<Heap<int> >::value, "Heap can't be copied");
+
+
 TEST(InsertExtract, HeapCorrectnessTests) {
     int q = 1000;
     Heap<int> h;
@@ -77,6 +87,36 @@ TEST(InsertEraseByPointer, HeapCorrectnessTests) {
 }
 
 
+TEST(EraseThenDrain, HeapCorrectnessTests) {
+    // the node moved into an erased place can belong above it, in another subtree
+    srand(8);
+    for (int trial = 0; trial < 200; ++trial) {
+        int n = 1 + rand() % 40;
+        Heap<int> h;
+        std::multiset<int> expected;
+        Vector<Heap<int>::Pointer> ptrs;
+        for (int i = 0; i < n; ++i) {
+            int x = rand() % 100;
+            ptrs.push_back(h.insert(x));
+            expected.insert(x);
+        }
+        Vector<bool> erased(ptrs.size(), false);
+        for (int i = 0; i < n / 2; ++i) {
+            size_t id = rand() % n;
+            if (!erased[id]) {
+                expected.erase(expected.find(ptrs[id].getKey()));
+                h.erase(ptrs[id]);
+                erased[id] = true;
+            }
+        }
+        for (std::multiset<int>::iterator it = expected.begin(); it != expected.end(); ++it) {
+            ASSERT_EQ(h.extract_min(), *it);
+        }
+        ASSERT_EQ(h.is_empty(), true);
+    }
+}
+
+
 TEST(InsertEqualNumbers, HeapCorrectnessTests) {
     Heap<int> h;
     h.insert(1);
@@ -153,6 +193,357 @@ TEST(MergeHeaps, HeapCorrectnessTests) {
 }
 
 
+TEST(MergeKeepsPointers, HeapCorrectnessTests) {
+    // nodes move to the other heap, so pointers into both heaps stay usable
+    for (int q = 1; q <= 10000; q *= 10) {
+        Heap<int> h1, h2;
+        Vector<Heap<int>::Pointer> pointers;
+        for (int i = 0; i < q; ++i) {
+            pointers.push_back(h1.insert(2 * i));
+            pointers.push_back(h2.insert(2 * i + 1));
+        }
+        h1.merge(h2);
+        ASSERT_EQ(h2.is_empty(), true);
+        for (int i = 0; i < 2 * q; ++i) {
+            h1.change(pointers[i], pointers[i].getKey() + 2 * q);
+        }
+        for (int i = 0; i < 2 * q; ++i) {
+            ASSERT_EQ(h1.extract_min(), i + 2 * q);
+        }
+        ASSERT_EQ(h1.is_empty(), true);
+    }
+}
+
+
+TEST(LayoutParentChild, HeapCorrectnessTests) {
+    // every node is the parent of its children and every prefix of the array is a tree
+    for (int k = 2; k <= 9; ++k) {
+        LevelOrderLayout level_order;
+        BlockedLayout<> blocked;
+        BlockedLayout<64> small_pages;
+        level_order.set_arity(k);
+        blocked.set_arity(k);
+        small_pages.set_arity(k);
+        for (size_t i = 0; i < 20000; ++i) {
+            for (int j = 0; j < k; ++j) {
+                ASSERT_EQ(level_order.parent(level_order.child(i, j)), i);
+                ASSERT_EQ(blocked.parent(blocked.child(i, j)), i);
+                ASSERT_EQ(small_pages.parent(small_pages.child(i, j)), i);
+                ASSERT_LT(i, blocked.child(i, j));
+                ASSERT_LT(i, small_pages.child(i, j));
+            }
+        }
+    }
+}
+
+
+TEST(BlockedLayoutRandOrder, HeapCorrectnessTests) {
+    int q = 100000;
+    Heap<int, BlockedLayout<> > h;
+    Heap<int, BlockedLayout<64> > h_small_pages;
+    std::priority_queue<int> h2;
+
+    srand(139);
+    for (int i = 0; i < q; ++i) {
+        if (rand() % 3) {
+            int x = rand();
+            h.insert(x);
+            h_small_pages.insert(x);
+            h2.push(-x);
+        }
+        else if (!h.is_empty()) {
+            ASSERT_EQ(h.extract_min(), -h2.top());
+            ASSERT_EQ(h_small_pages.extract_min(), -h2.top());
+            h2.pop();
+        }
+    }
+}
+
+
+TEST(BlockedLayoutChangeErase, HeapCorrectnessTests) {
+    srand(2018);
+    for (int k = 2; k <= 5; ++k) {
+        Heap<int, BlockedLayout<128> > h(k);
+        std::multiset<int> s;
+        Vector<Heap<int, BlockedLayout<128> >::Pointer> pointers;
+        Vector<int> keys;
+        Vector<bool> alive;
+        for (int i = 0; i < 20000; ++i) {
+            int op = rand() % 3;
+            if (op == 0 || s.empty()) {
+                int x = rand() % 100000;
+                pointers.push_back(h.insert(x));
+                keys.push_back(x);
+                alive.push_back(true);
+                s.insert(x);
+            }
+            else if (op == 1) {
+                int id = rand() % pointers.size();
+                if (alive[id]) {
+                    int x = rand() % 100000;
+                    s.erase(s.find(keys[id]));
+                    s.insert(x);
+                    h.change(pointers[id], x);
+                    keys[id] = x;
+                }
+            }
+            else {
+                int id = rand() % pointers.size();
+                if (alive[id]) {
+                    s.erase(s.find(keys[id]));
+                    h.erase(pointers[id]);
+                    alive[id] = false;
+                }
+            }
+            ASSERT_EQ(h.is_empty(), s.empty());
+            if (!s.empty()) {
+                ASSERT_EQ(h.get_min(), *s.begin());
+            }
+        }
+    }
+}
+
+
+TEST(PrefetchRandOrder, HeapCorrectnessTests) {
+    // prefetching must not change the result for any arity and layout
+    for (int k = 2; k <= 6; ++k) {
+        Heap<int> h(k);
+        Heap<int, BlockedLayout<256> > h_blocked(k);
+        h.set_prefetch_distance(k % 3);
+        h_blocked.enable_prefetch();
+        std::priority_queue<int> h2;
+
+        srand(139 + k);
+        for (int i = 0; i < 30000; ++i) {
+            if (rand() % 3) {
+                int x = rand();
+                h.insert(x);
+                h_blocked.insert(x);
+                h2.push(-x);
+            }
+            else if (!h2.empty()) {
+                ASSERT_EQ(h.extract_min(), -h2.top());
+                ASSERT_EQ(h_blocked.extract_min(), -h2.top());
+                h2.pop();
+            }
+        }
+    }
+}
+
+
+TEST(BranchlessSiftRandOrder, HeapCorrectnessTests) {
+    for (int k = 2; k <= 7; ++k) {
+        Heap<int, LevelOrderLayout, BranchlessSift> h(k);
+        Heap<int, BlockedLayout<128>, BranchlessSift> h_blocked(k);
+        std::priority_queue<int> h2;
+        Vector<Heap<int, LevelOrderLayout, BranchlessSift>::Pointer> pointers;
+
+        srand(239 + k);
+        for (int i = 0; i < 30000; ++i) {
+            if (rand() % 3) {
+                int x = rand() % 1000;
+                pointers.push_back(h.insert(x));
+                h_blocked.insert(x);
+                h2.push(-x);
+            }
+            else if (!h2.empty()) {
+                ASSERT_EQ(h.extract_min(), -h2.top());
+                ASSERT_EQ(h_blocked.extract_min(), -h2.top());
+                h2.pop();
+            }
+        }
+    }
+}
+
+
+template <class HeapType>
+void checkBuildParallel(int n, int k, size_t threads) {
+    HeapType h(k);
+    Vector<int> keys;
+    srand(n + k);
+    for (int i = 0; i < n; ++i) {
+        keys.push_back(rand() % 100000);
+    }
+    h.build_parallel(&keys[0], &keys[0] + n, threads);
+
+    std::priority_queue<int> h2;
+    for (int i = 0; i < n; ++i) {
+        h2.push(-keys[i]);
+    }
+    for (int i = 0; i < n; ++i) {
+        ASSERT_EQ(h.extract_min(), -h2.top());
+        h2.pop();
+    }
+    ASSERT_EQ(h.is_empty(), true);
+}
+
+
+TEST(BuildParallel, HeapCorrectnessTests) {
+    int sizes[] = {1, 2, 10, 100, 1000, 54321};
+    for (int i = 0; i < 6; ++i) {
+        for (int k = 2; k <= 5; ++k) {
+            for (size_t threads = 1; threads <= 4; ++threads) {
+                checkBuildParallel<Heap<int> >(sizes[i], k, threads);
+                checkBuildParallel<Heap<int, BlockedLayout<128> > >(sizes[i], k, threads);
+            }
+        }
+    }
+}
+
+
+TEST(InsertBulkParallel, HeapCorrectnessTests) {
+    // small batches are inserted one by one, big ones make the heap rebuild
+    Heap<int> h;
+    std::multiset<int> s;
+    Vector<Heap<int>::Pointer> pointers;
+    srand(38);
+    int batches[] = {1000, 5, 20000, 1, 300};
+    for (int b = 0; b < 5; ++b) {
+        Vector<int> keys;
+        for (int i = 0; i < batches[b]; ++i) {
+            keys.push_back(rand() % 100000);
+            s.insert(keys[i]);
+        }
+        size_t before = pointers.size();
+        h.insert_bulk_parallel(&keys[0], &keys[0] + batches[b], pointers, 3);
+        ASSERT_EQ(pointers.size(), before + batches[b]);
+        for (int i = 0; i < batches[b]; ++i) {
+            ASSERT_EQ(pointers[before + i].getKey(), keys[i]);
+        }
+    }
+    // pointers still work after the rebuilds
+    s.erase(s.find(pointers[0].getKey()));
+    s.insert(-1);
+    h.change(pointers[0], -1);
+    for (std::multiset<int>::iterator it = s.begin(); it != s.end(); ++it) {
+        ASSERT_EQ(h.extract_min(), *it);
+    }
+    ASSERT_EQ(h.is_empty(), true);
+}
+
+
+TEST(SaveLoad, HeapCorrectnessTests) {
+    std::string path = testing::TempDir() + "heap_snapshot";
+    srand(141);
+    Heap<int> h;
+    h.optimize(1000, 100);
+    std::priority_queue<int> h2;
+    for (int i = 0; i < 100000; ++i) {
+        int x = rand();
+        h.insert(x);
+        h2.push(-x);
+    }
+    h.save(path);
+
+    // the same layout is loaded as it is, another one is heapified
+    Heap<int> loaded;
+    Heap<int, BlockedLayout<> > loaded_blocked;
+    loaded.insert(-1);
+    loaded.load(path);
+    loaded_blocked.load(path);
+    while (!h2.empty()) {
+        ASSERT_EQ(loaded.extract_min(), -h2.top());
+        ASSERT_EQ(loaded_blocked.extract_min(), -h2.top());
+        h2.pop();
+    }
+    ASSERT_EQ(loaded.is_empty(), true);
+    ASSERT_EQ(loaded_blocked.is_empty(), true);
+    remove(path.c_str());
+}
+
+
+TEST(Stats, HeapCorrectnessTests) {
+    // every key goes up to the root: index i is floor(log2(i + 1)) levels deep
+    size_t q = 1000;
+    Heap<int> h;
+    unsigned long long levels = 0;
+    for (size_t i = 0; i < q; ++i) {
+        h.insert(-(int)i);
+        levels += (unsigned long long)log2((double)(i + 1));
+    }
+    HeapStats stats = h.stats();
+    if (!HeapStats::enabled()) {
+        ASSERT_EQ(stats.allocations, 0u);
+        ASSERT_EQ(stats.comparisons, 0u);
+        return;
+    }
+    ASSERT_EQ(stats.allocations, q);
+    ASSERT_EQ(stats.swaps, levels);
+    // a sift which reaches the root stops without a comparison
+    ASSERT_EQ(stats.comparisons, levels);
+    unsigned long long sifts = 0;
+    for (int d = 0; d < HeapStats::DEPTHS; ++d) {
+        sifts += stats.sift_depths[d];
+    }
+    ASSERT_EQ(sifts, q);
+    ASSERT_EQ(stats.sift_depths[9], 1000u - 511u);
+
+    h.reset_stats();
+    ASSERT_EQ(h.stats().swaps, 0u);
+    // counted by all threads
+    std::vector<int> keys(10000, 1);
+    h.build_parallel(keys.begin(), keys.end(), 4);
+    ASSERT_EQ(h.stats().allocations, 10000u);
+    ASSERT_GE(h.stats().comparisons, 10000u);
+}
+
+
+TEST(MemoryUsage, HeapCorrectnessTests) {
+    // Vector made with a size which is not a power of two grows from it
+    Vector<int> v(5);
+    v.push_back(1);
+    ASSERT_EQ(v.capacity(), 10u);
+    ASSERT_EQ(v.memory_usage().live_bytes, 10 * sizeof(int));
+    ASSERT_EQ(v.memory_usage().slack_bytes, 4 * sizeof(int));
+
+    Heap<int> h;
+    ASSERT_EQ(h.memory_usage().bytes_per_element(), 0);
+    for (int i = 0; i < 1000; ++i) {
+        h.insert(i);
+    }
+    MemoryUsage usage = h.memory_usage();
+    ASSERT_EQ(usage.elements, 1000u);
+    ASSERT_EQ(usage.slack_bytes, 24 * sizeof(void*));
+    // a pointer in the array and a node with the key and its index
+    ASSERT_GE(usage.bytes_per_element(), 2 * sizeof(void*) + sizeof(int));
+    // nodes go away, the array doesn't shrink
+    size_t node_bytes = (usage.live_bytes - 1024 * sizeof(void*)) / 1000;
+    for (int i = 0; i < 900; ++i) {
+        h.extract_min();
+    }
+    ASSERT_EQ(h.memory_usage().elements, 100u);
+    ASSERT_EQ(h.memory_usage().slack_bytes, 924 * sizeof(void*));
+    ASSERT_EQ(h.memory_usage().live_bytes, 1024 * sizeof(void*) + 100 * node_bytes);
+    ASSERT_EQ(h.memory_usage().table_bytes, 0u);
+    // with SlotMapStorage slots of a destroyed heap stay in the table of every such Heap<int>
+    typedef Heap<int, LevelOrderLayout, BranchingSift, SlotMapStorage> SlottedHeap;
+    SlottedHeap slotted;
+    {
+        SlottedHeap big;
+        for (int i = 0; i < 100000; ++i) {
+            big.insert(i);
+        }
+    }
+    ASSERT_EQ(slotted.memory_usage().elements, 0u);
+    ASSERT_GE(slotted.memory_usage().table_bytes, 100000 * node_bytes);
+}
+
+
+TEST(ArityConstructor, HeapValidationTests) {
+    ASSERT_THROW(Heap<int>(1), std::invalid_argument);
+    Heap<int> h(5);
+    std::multiset<int> expected;
+    for (int i = 0; i < 1000; ++i) {
+        int key = rand() % 100;
+        h.insert(key);
+        expected.insert(key);
+    }
+    for (std::multiset<int>::iterator it = expected.begin(); it != expected.end(); ++it) {
+        ASSERT_EQ(h.extract_min(), *it);
+    }
+}
+
+
 TEST(GetMinOnEmptyHeap, HeapValidationTests) {
     Heap<int> h;
     ASSERT_THROW(h.get_min(), std::logic_error);
@@ -174,6 +565,45 @@ TEST(ExtractMinOnEmptyHeap, HeapValidationTests) {
 }
 
 
+TEST(LoadWrongSnapshot, HeapValidationTests) {
+    std::string path = testing::TempDir() + "heap_snapshot";
+    Heap<int> h;
+    ASSERT_THROW(h.load(path + "_missing"), std::runtime_error);
+    h.insert(1);
+    h.save(path);
+    Heap<long long> other_key;
+    ASSERT_THROW(other_key.load(path), std::runtime_error);
+    BinomialHeap<int> other_heap;
+    ASSERT_THROW(other_heap.load(path), std::runtime_error);
+    remove(path.c_str());
+}
+
+
+TEST(RemovedElementPointer, HeapValidationTests) {
+    typedef Heap<int, LevelOrderLayout, BranchingSift, SlotMapStorage> SlottedHeap;
+    SlottedHeap h;
+    SlottedHeap::Pointer extracted = h.insert(1);
+    SlottedHeap::Pointer erased = h.insert(2);
+    SlottedHeap::Pointer kept = h.insert(3);
+    ASSERT_EQ(h.extract_min(), 1);
+    h.erase(erased);
+    // the freed nodes are reused right away, the old pointers still know they are gone
+    SlottedHeap::Pointer reused = h.insert(4);
+    ASSERT_THROW(h.change(extracted, 0), std::invalid_argument);
+    ASSERT_THROW(h.erase(erased), std::invalid_argument);
+    ASSERT_THROW(extracted.getKey(), std::invalid_argument);
+    ASSERT_THROW(h.change(SlottedHeap::Pointer(), 0), std::invalid_argument);
+    // a default Pointer refers to nothing with any storage
+    Heap<int> plain;
+    ASSERT_THROW(plain.change(Heap<int>::Pointer(), 0), std::invalid_argument);
+    ASSERT_EQ(kept.getKey(), 3);
+    ASSERT_EQ(reused.getKey(), 4);
+    h.change(reused, 0);
+    ASSERT_EQ(h.extract_min(), 0);
+    ASSERT_EQ(h.extract_min(), 3);
+}
+
+
 TEST(InsertExtract, DISABLED_HeapTimeTests) {
     time_t t0 = clock();
 
@@ -214,3 +644,167 @@ TEST(Merge, DISABLED_HeapTimeTests) {
 
     reportTime("Heap 'merge' (5*10^6, 5*10^6)", res);
 }
+
+
+template <class HeapType>
+int bigHeapTime(HeapType &h, int q, int operations) {
+    // heap of q elements, then pairs of extract_min and insert on it
+    srand(30);
+    for (int i = 0; i < q; ++i) {
+        h.insert(rand());
+    }
+    clock_t t0 = clock();
+    for (int i = 0; i < operations; ++i) {
+        h.extract_min();
+        h.insert(rand());
+    }
+    return (int)((clock() - t0) * 1000 / CLOCKS_PER_SEC);
+}
+
+
+TEST(BigHeapLevelOrderLayout, DISABLED_HeapTimeTests) {
+    Heap<int> h;
+    int res = bigHeapTime(h, 100000000, 10000000);
+    reportTime("Heap level order layout, 10^7 extracts and inserts on 10^8 elements", res);
+}
+
+
+TEST(BigHeapBlockedLayout, DISABLED_HeapTimeTests) {
+    Heap<int, BlockedLayout<> > h;
+    int res = bigHeapTime(h, 100000000, 10000000);
+    reportTime("Heap blocked layout, 10^7 extracts and inserts on 10^8 elements", res);
+}
+
+
+template <class HeapType>
+void prefetchCounters(const char *name, int q, int k, int distance) {
+    // extract_min and insert pairs on a heap of q elements, with hardware counters
+    HeapType h(k);
+    h.set_prefetch_distance(distance);
+    srand(31);
+    for (int i = 0; i < q; ++i) {
+        h.insert(rand());
+    }
+
+    PerfCounters counters;
+    clock_t t0 = clock();
+    counters.start();
+    for (int i = 0; i < 5000000; ++i) {
+        h.extract_min();
+        h.insert(rand());
+    }
+    counters.stop();
+    int res = (int)((clock() - t0) * 1000 / CLOCKS_PER_SEC);
+
+    reportTime(name, res);
+    reportCounters(name, counters.get(PerfCounters::CYCLES), counters.get(PerfCounters::CACHE_MISSES),
+                   counters.get(PerfCounters::BRANCH_MISSES));
+}
+
+
+TEST(Prefetch10M, DISABLED_HeapTimeTests) {
+    prefetchCounters<Heap<int> >("Heap 10^7, k = 2, no prefetch", 10000000, 2, 0);
+    prefetchCounters<Heap<int> >("Heap 10^7, k = 2, prefetch distance 1", 10000000, 2, 1);
+    prefetchCounters<Heap<int> >("Heap 10^7, k = 2, prefetch distance 2", 10000000, 2, 2);
+    prefetchCounters<Heap<int> >("Heap 10^7, k = 4, no prefetch", 10000000, 4, 0);
+    prefetchCounters<Heap<int> >("Heap 10^7, k = 4, prefetch distance 1", 10000000, 4, 1);
+    prefetchCounters<Heap<int> >("Heap 10^7, k = 4, prefetch distance 2", 10000000, 4, 2);
+}
+
+
+TEST(Prefetch100M, DISABLED_HeapTimeTests) {
+    prefetchCounters<Heap<int> >("Heap 10^8, k = 2, no prefetch", 100000000, 2, 0);
+    prefetchCounters<Heap<int> >("Heap 10^8, k = 2, prefetch distance 2", 100000000, 2, 2);
+    prefetchCounters<Heap<int> >("Heap 10^8, k = 4, no prefetch", 100000000, 4, 0);
+    prefetchCounters<Heap<int> >("Heap 10^8, k = 4, prefetch distance 1", 100000000, 4, 1);
+}
+
+
+template <class HeapType>
+void siftCounters(const char *name, int q, int k) {
+    HeapType h(k);
+    srand(32);
+    for (int i = 0; i < q; ++i) {
+        h.insert(rand());
+    }
+
+    PerfCounters counters;
+    clock_t t0 = clock();
+    counters.start();
+    for (int i = 0; i < q; ++i) {
+        h.extract_min();
+    }
+    counters.stop();
+    int res = (int)((clock() - t0) * 1000 / CLOCKS_PER_SEC);
+
+    reportTime(name, res);
+    reportCounters(name, counters.get(PerfCounters::CYCLES), counters.get(PerfCounters::CACHE_MISSES),
+                   counters.get(PerfCounters::BRANCH_MISSES));
+}
+
+
+TEST(BranchlessSift, DISABLED_HeapTimeTests) {
+    siftCounters<Heap<int> >("Heap 10^6 extracts, k = 2, branching sift", 1000000, 2);
+    siftCounters<Heap<int, LevelOrderLayout, BranchlessSift> >("Heap 10^6 extracts, k = 2, branchless sift",
+                                                               1000000, 2);
+    siftCounters<Heap<int> >("Heap 10^6 extracts, k = 4, branching sift", 1000000, 4);
+    siftCounters<Heap<int, LevelOrderLayout, BranchlessSift> >("Heap 10^6 extracts, k = 4, branchless sift",
+                                                               1000000, 4);
+    siftCounters<Heap<int> >("Heap 10^6 extracts, k = 8, branching sift", 1000000, 8);
+    siftCounters<Heap<int, LevelOrderLayout, BranchlessSift> >("Heap 10^6 extracts, k = 8, branchless sift",
+                                                               1000000, 8);
+}
+
+
+template <class HeapType>
+void buildParallelTime(const char *name, size_t n, size_t threads) {
+    Vector<int> keys(n);
+    srand(500);
+    for (size_t i = 0; i < n; ++i) {
+        keys[i] = rand();
+    }
+    HeapType h;
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    h.build_parallel(&keys[0], &keys[0] + n, threads);
+    int res = (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t0).count();
+    reportTime((std::string(name) + ", " + std::to_string(threads) + " threads").c_str(), res);
+}
+
+
+TEST(BuildParallelScaling, DISABLED_HeapTimeTests) {
+    // wall time, as clock() sums all threads
+    size_t cores = std::max(std::thread::hardware_concurrency(), 1u);
+    for (size_t step = 1; ; step *= 2) {
+        size_t threads = std::min(step, cores);
+        buildParallelTime<Heap<int> >("Heap build_parallel 3 * 10^7", 30000000, threads);
+        buildParallelTime<Heap<int, BlockedLayout<> > >("Heap<BlockedLayout> build_parallel 3 * 10^7", 30000000,
+                                                         threads);
+        if (threads == cores) {
+            break;
+        }
+    }
+}
+
+
+TEST(SnapshotReload, DISABLED_HeapTimeTests) {
+    // restart of a service: replaying inserts against loading a snapshot
+    std::string path = testing::TempDir() + "heap_snapshot";
+    int q = 20000000;
+    {
+        Heap<long long> h;
+        srand(2024);
+        time_t t0 = clock();
+        for (int i = 0; i < q; ++i) {
+            h.insert(((long long)rand() << 31) ^ rand());
+        }
+        reportTime("Heap rebuild by 2 * 10^7 inserts", (clock() - t0) * 1000 / CLOCKS_PER_SEC);
+        t0 = clock();
+        h.save(path);
+        reportTime("Heap save 2 * 10^7 keys", (clock() - t0) * 1000 / CLOCKS_PER_SEC);
+    }
+    Heap<long long> loaded;
+    time_t t0 = clock();
+    loaded.load(path);
+    reportTime("Heap load 2 * 10^7 keys", (clock() - t0) * 1000 / CLOCKS_PER_SEC);
+    remove(path.c_str());
+}
@@ -0,0 +1,392 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "../HollowHeap.h"
+#include "TimeReport.h"
+#include <queue>
+#include <set>
+
+using testing::Eq;
+
+
+TEST(InsertExtract, HollowHeapCorrectnessTests) {
+    int q = 1000;
+    HollowHeap<int> h;
+
+    ASSERT_EQ(h.is_empty(), true);
+    for (int i = q - 1; i >= 0; --i) {
+        h.insert(i);
+    }
+    for (int i = 0; i < q; ++i) {
+        ASSERT_EQ(h.extract_min(), i);
+    }
+    ASSERT_EQ(h.is_empty(), true);
+}
+
+
+TEST(InsertExtractRandOrder, HollowHeapCorrectnessTests) {
+    int q = 1000;
+    HollowHeap<int> h;
+    std::priority_queue<int> h2;
+
+    srand(139);
+    for (int i = 0; i < q; ++i) {
+        if (rand() % 3) {
+            int x = rand() % 100;
+            h.insert(x);
+            h2.push(-x);
+        }
+        else if (!h.is_empty()) {
+            ASSERT_EQ(h.extract_min(), -h2.top());
+            h2.pop();
+        }
+    }
+}
+
+
+TEST(InsertEraseByPointer, HollowHeapCorrectnessTests) {
+    srand(1791791791);
+    int q = 1000;
+
+    HollowHeap<int> h;
+    Vector<HollowHeap<int>::Pointer> arr;
+    for (int i = 0; i < q; ++i) {
+        arr.push_back(h.insert(i));
+    }
+
+    Vector<bool> alive(arr.size(), true);
+    for (int i = 0; i < q - 1; ++i) {
+        int id = rand() % (q - i);
+        Vector<int> pos;
+        for (int j = 0; j < q; ++j) {
+            if (alive[j]) {
+                pos.push_back(j);
+            }
+        }
+        int index = pos[id];
+        h.erase(arr[index]);
+        alive[index] = false;
+
+        for (size_t j = id; j + 1 < pos.size(); ++j) {
+            pos[j] = pos[j + 1];
+        }
+        pos.pop_back();
+
+        ASSERT_EQ(arr[pos[0]].getKey(), h.get_min());
+        ASSERT_EQ(h.is_empty(), false);
+    }
+    h.extract_min();
+    ASSERT_EQ(h.is_empty(), true);
+}
+
+
+TEST(InsertEqualNumbers, HollowHeapCorrectnessTests) {
+    HollowHeap<int> h;
+    h.insert(1);
+    h.insert(1);
+    h.insert(2);
+    h.insert(1);
+    ASSERT_EQ(h.extract_min(), 1);
+    ASSERT_EQ(h.extract_min(), 1);
+    ASSERT_EQ(h.extract_min(), 1);
+    ASSERT_EQ(h.extract_min(), 2);
+    ASSERT_EQ(h.is_empty(), true);
+}
+
+
+TEST(MergeHeaps, HollowHeapCorrectnessTests) {
+    srand(34234);
+    Vector<int> qs;
+    qs.push_back(1);
+    qs.push_back(2);
+    qs.push_back(3);
+    qs.push_back(4);
+    qs.push_back(5);
+    qs.push_back(100);
+
+    for (size_t ic = 0; ic < qs.size(); ++ic) {
+        int q = qs[ic];
+        for (int j = 0; j < 10; ++j) {
+            HollowHeap<int> h1, h2;
+
+            for (int i = 0; i < q; ++i) {
+                if (rand() % 2) {
+                    h1.insert(i);
+                }
+                else {
+                    h2.insert(i);
+                }
+            }
+            h1.merge(h2);
+            ASSERT_EQ(h2.is_empty(), true);
+            for (int i = 0; i < q; ++i) {
+                ASSERT_EQ(h1.extract_min(), i);
+            }
+        }
+    }
+}
+
+
+TEST(GetDecreaseExtract, HollowHeapCorrectnessTests) {
+    HollowHeap<int> h;
+    h.insert(1);
+    HollowHeap<int>::Pointer ptr2 = h.insert(2);
+    HollowHeap<int>::Pointer ptr3 = h.insert(3);
+    ASSERT_EQ(h.get_min(), 1);
+    h.decrease(ptr2, 1);
+    ASSERT_EQ(h.get_min(), 1);
+    h.decrease(ptr3, -1);
+    ASSERT_EQ(h.get_min(), -1);
+    ASSERT_EQ(ptr3.getKey(), -1);
+    h.extract_min();
+    ASSERT_EQ(h.get_min(), 1);
+    h.extract_min();
+    ASSERT_EQ(h.get_min(), 1);
+    h.extract_min();
+    ASSERT_EQ(h.is_empty(), true);
+}
+
+
+TEST(RandomDecreaseEraseExtract, HollowHeapCorrectnessTests) {
+    // decreases leave hollow nodes with two parents all over the tree,
+    // so compare with std::multiset on a long random sequence
+    srand(2018);
+    int q = 20000;
+
+    HollowHeap<int> h;
+    std::multiset<int> s;
+    Vector<HollowHeap<int>::Pointer> pointers;
+    Vector<int> keys;
+    Vector<bool> alive;
+    for (int i = 0; i < q; ++i) {
+        int op = rand() % 4;
+        if (op == 0 || s.empty()) {
+            int x = rand() % 1000000;
+            pointers.push_back(h.insert(x));
+            keys.push_back(x);
+            alive.push_back(true);
+            s.insert(x);
+        }
+        else if (op == 1) {
+            int id = rand() % pointers.size();
+            if (alive[id]) {
+                int x = keys[id] - rand() % 1000;
+                s.erase(s.find(keys[id]));
+                s.insert(x);
+                h.decrease(pointers[id], x);
+                keys[id] = x;
+                ASSERT_EQ(pointers[id].getKey(), x);
+            }
+        }
+        else if (op == 2) {
+            int id = rand() % pointers.size();
+            if (alive[id]) {
+                s.erase(s.find(keys[id]));
+                h.erase(pointers[id]);
+                alive[id] = false;
+            }
+        }
+        else {
+            ASSERT_EQ(h.get_min(), *s.begin());
+            for (size_t j = 0; j < pointers.size(); ++j) {
+                if (alive[j] && keys[j] == *s.begin()) {
+                    h.erase(pointers[j]);
+                    alive[j] = false;
+                    break;
+                }
+            }
+            s.erase(s.begin());
+        }
+        ASSERT_EQ(h.is_empty(), s.empty());
+        if (!s.empty()) {
+            ASSERT_EQ(h.get_min(), *s.begin());
+        }
+    }
+}
+
+
+TEST(MemoryUsage, HollowHeapCorrectnessTests) {
+    HollowHeap<int> h;
+    Vector<HollowHeap<int>::Pointer> pointers;
+    for (int i = 0; i < 10; ++i) {
+        pointers.push_back(h.insert(i + 100));
+    }
+    ASSERT_EQ(h.memory_usage().slack_bytes, 0u);
+    // every decrease below the root leaves a hollow node
+    for (int i = 5; i < 10; ++i) {
+        h.decrease(pointers[i], i);
+    }
+    MemoryUsage usage = h.memory_usage();
+    ASSERT_EQ(usage.elements, 10u);
+    ASSERT_GT(usage.slack_bytes, 0u);
+    ASSERT_EQ(usage.slack_bytes % 5, 0u);
+    while (!h.is_empty()) {
+        h.extract_min();
+    }
+    ASSERT_EQ(h.memory_usage().live_bytes, 0u);
+}
+
+
+TEST(DestroyedHeapPointers, HollowHeapValidationTests) {
+    // items go with the heap, also those moved to new nodes by decrease
+    srand(26);
+    Vector<HollowHeap<int, SlotMapStorage>::Pointer> pointers;
+    {
+        HollowHeap<int, SlotMapStorage> h;
+        for (int i = 0; i < 1000; ++i) {
+            pointers.push_back(h.insert(rand() % 1000000));
+        }
+        for (int i = 0; i < 500; ++i) {
+            h.extract_min();
+            HollowHeap<int, SlotMapStorage>::Pointer ptr = pointers[rand() % pointers.size()];
+            try {
+                h.decrease(ptr, ptr.getKey() - rand() % 1000);
+            }
+            catch (std::invalid_argument&) {
+                // extracted already
+            }
+        }
+    }
+    for (size_t i = 0; i < pointers.size(); ++i) {
+        ASSERT_THROW(pointers[i].getKey(), std::invalid_argument);
+    }
+}
+
+
+TEST(GetMin, HollowHeapValidationTests) {
+    HollowHeap<int> h;
+    ASSERT_THROW(h.get_min(), std::logic_error);
+    h.insert(1);
+    ASSERT_NO_THROW(h.get_min());
+}
+
+
+TEST(ExtractMin, HollowHeapValidationTests) {
+    HollowHeap<int> h;
+    ASSERT_THROW(h.extract_min(), std::logic_error);
+    h.insert(1);
+    ASSERT_NO_THROW(h.extract_min());
+}
+
+
+TEST(Decrease, HollowHeapValidationTests) {
+    HollowHeap<int> h;
+    HollowHeap<int>::Pointer ptr = h.insert(1);
+    ASSERT_THROW(h.decrease(ptr, 2), std::invalid_argument);
+    ASSERT_NO_THROW(h.decrease(ptr, -10));
+}
+
+
+TEST(DISABLED_InsertExtract, HollowHeapTimeTests) {
+    time_t t0 = clock();
+
+    int q = 5000000;
+    HollowHeap<int> h;
+    for (int i = 0; i < q; ++i) {
+        if (!h.is_empty() && !(rand() % 3)) {
+            h.extract_min();
+        }
+        else {
+            h.insert(i);
+        }
+    }
+    int res = clock() - t0;
+
+    reportTime("HollowHeap inserts and extracts", res);
+}
+
+
+TEST(DISABLED_InsertDecreaseExtract, HollowHeapTimeTests) {
+    // Same workload as in FibonacciHeapTimeTests to compare the two heaps:
+    // decreases happen to positive numbers and extracts to negative
+    // in order to avoid decreasing on invalidated pointer
+
+    time_t t0 = clock();
+    srand(123);
+
+    int q = 50000000;
+    HollowHeap<long long> h;
+    Vector<HollowHeap<long long>::Pointer> pointers;
+    pointers.push_back(h.insert(1));
+    Vector<long long> vals;
+    vals.push_back(1ll);
+    for (int i = 0; i < q; ++i) {
+        if (h.is_empty()) {
+            pointers.push_back(h.insert(i));
+            vals.push_back(i);
+        }
+        else if (rand() % 2) {
+            pointers.push_back(h.insert(i));
+            vals.push_back(i);
+        }
+        else if (rand() % 2 && h.get_min() < 0) {
+            h.extract_min();
+        }
+        else {
+            int pointer_id = rand() % pointers.size();
+            if (vals[pointer_id] > 0) {
+                HollowHeap<long long>::Pointer ptr = pointers[pointer_id];
+                h.decrease(ptr, ptr.getKey() - i / 2);
+                vals[pointer_id] -= i / 2;
+            }
+        }
+    }
+    int res = clock() - t0;
+
+    reportTime("HollowHeap inserts, extracts and decreases", res);
+}
+
+
+TEST(DISABLED_InsertExtractDecreaseAtSameElements, HollowHeapTimeTests) {
+    time_t t0 = clock();
+    srand(123);
+
+    int q = 50000000;
+    HollowHeap<long long> h;
+    Vector<HollowHeap<long long>::Pointer> pointers;
+    pointers.push_back(h.insert(1));
+    Vector<long long> vals;
+    vals.push_back(1ll);
+    for (int i = 0; i < q; ++i) {
+        if (h.is_empty() || i < 100) {
+            pointers.push_back(h.insert(i));
+            vals.push_back(i);
+        }
+        else if (rand() % 2) {
+            pointers.push_back(h.insert(i));
+            vals.push_back(i);
+        }
+        else if (rand() % 2 && h.get_min() < 0) {
+            h.extract_min();
+        }
+        else {
+            int pointer_id = (rand() % (pointers.size() / 10)) * 10;
+            if (vals[pointer_id] > 0) {
+                HollowHeap<long long>::Pointer ptr = pointers[pointer_id];
+                h.decrease(ptr, ptr.getKey() - i / 2);
+                vals[pointer_id] -= i / 2;
+            }
+        }
+    }
+    int res = clock() - t0;
+
+    reportTime("HollowHeap inserts, extracts and decreases, decreases happen often to same elements", res);
+}
+
+
+TEST(Merge, DISABLED_HollowHeapTimeTests) {
+    int q = 5000000;
+    HollowHeap<int> h1, h2;
+    srand(239);
+    for (int i = 0; i < q; ++i) {
+        h1.insert(rand());
+    }
+    for (int i = 0; i < q; ++i) {
+        h2.insert(rand());
+    }
+
+    time_t t0 = clock();
+    h1.merge(h2);
+    int res = clock() - t0;
+
+    reportTime("HollowHeap merge (5*10^6, 5*10^6)", res);
+}
@@ -0,0 +1,199 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "../IndexedHeap.h"
+#include "../Heap.h"
+#include "../FibonacciHeap.h"
+#include "../PriorityQueue.h"
+#include "TimeReport.h"
+#include <set>
+#include <vector>
+#include <queue>
+#include <ctime>
+
+using testing::Eq;
+
+
+TEST(PushDecreasePopRandOrder, IndexedHeapCorrectnessTests) {
+    for (int arity = 2; arity <= 8; arity *= 2) {
+        int n = 5000;
+        IndexedHeap<int> h(n, arity);
+        std::set<std::pair<int, uint32_t> > h2;
+        std::vector<int> keys(n);
+
+        srand(144);
+        for (int i = 0; i < 100000; ++i) {
+            uint32_t id = rand() % n;
+            int op = rand() % 3;
+            if (op == 0 && !h.contains(id)) {
+                keys[id] = rand() % 100000;
+                h.push(id, keys[id]);
+                h2.insert(std::make_pair(keys[id], id));
+            }
+            else if (op == 1 && h.contains(id)) {
+                h2.erase(std::make_pair(keys[id], id));
+                keys[id] -= rand() % 1000;
+                h.decrease(id, keys[id]);
+                h2.insert(std::make_pair(keys[id], id));
+            }
+            else if (op == 2 && !h2.empty()) {
+                std::pair<uint32_t, int> top = h.pop();
+                // equal keys may come out with any of their ids
+                ASSERT_EQ(top.second, h2.begin()->first);
+                ASSERT_EQ(h2.count(std::make_pair(top.second, top.first)), (size_t)1);
+                h2.erase(std::make_pair(top.second, top.first));
+                ASSERT_EQ(h.contains(top.first), false);
+            }
+            ASSERT_EQ(h.size(), h2.size());
+        }
+        while (!h2.empty()) {
+            ASSERT_EQ(h.get_min(), h2.begin()->first);
+            ASSERT_EQ(h.get_key(h.top()), h.get_min());
+            std::pair<uint32_t, int> top = h.pop();
+            h2.erase(std::make_pair(top.second, top.first));
+        }
+        ASSERT_EQ(h.is_empty(), true);
+    }
+}
+
+
+TEST(BlockedLayoutPushDecrease, IndexedHeapCorrectnessTests) {
+    int n = 100000;
+    IndexedHeap<int, BlockedLayout<64> > h(n, 4);
+    for (int i = 0; i < n; ++i) {
+        h.push(i, (int)(((long long)i * 7919) % n) + n);
+    }
+    for (int i = 0; i < n; i += 2) {
+        h.decrease(i, h.get_key(i) - n);
+    }
+    std::vector<int> result;
+    while (!h.is_empty()) {
+        result.push_back(h.pop().second);
+    }
+    ASSERT_EQ(result.size(), (size_t)n);
+    for (int i = 1; i < n; ++i) {
+        ASSERT_LE(result[i - 1], result[i]);
+    }
+}
+
+
+TEST(WrongIds, IndexedHeapValidationTests) {
+    IndexedHeap<int> h(10);
+    ASSERT_THROW(h.pop(), std::logic_error);
+    ASSERT_THROW(h.top(), std::logic_error);
+    ASSERT_THROW(h.push(10, 1), std::out_of_range);
+    ASSERT_THROW(h.decrease(3, 1), std::logic_error);
+    h.push(3, 5);
+    ASSERT_THROW(h.push(3, 4), std::logic_error);
+    ASSERT_THROW(h.decrease(3, 6), std::invalid_argument);
+    ASSERT_EQ(h.pop(), std::make_pair((uint32_t)3, 5));
+    ASSERT_EQ(h.contains(3), false);
+}
+
+
+// random graph with m edges as adjacency arrays
+struct RandomGraph {
+    std::vector<int> first, to, weight;
+
+    RandomGraph(int n, int m, unsigned int seed) : first(n + 1, 0) {
+        srand(seed);
+        std::vector<int> from(m);
+        for (int i = 0; i < m; ++i) {
+            from[i] = rand() % n;
+            ++first[from[i] + 1];
+        }
+        for (int v = 0; v < n; ++v) {
+            first[v + 1] += first[v];
+        }
+        to.resize(m);
+        weight.resize(m);
+        std::vector<int> fill(first.begin(), first.end() - 1);
+        for (int i = 0; i < m; ++i) {
+            to[fill[from[i]]] = rand() % n;
+            weight[fill[from[i]]++] = rand() % 1000 + 1;
+        }
+    }
+};
+
+
+std::vector<long long> dijkstraIndexed(const RandomGraph &g, int n) {
+    std::vector<long long> dist(n, -1);
+    IndexedHeap<long long> h(n);
+    h.push(0, 0);
+    while (!h.is_empty()) {
+        std::pair<uint32_t, long long> top = h.pop();
+        dist[top.first] = top.second;
+        for (int e = g.first[top.first]; e < g.first[top.first + 1]; ++e) {
+            int u = g.to[e];
+            long long d = top.second + g.weight[e];
+            if (dist[u] != -1) {
+                continue;
+            }
+            if (!h.contains(u)) {
+                h.push(u, d);
+            }
+            else if (d < h.get_key(u)) {
+                h.decrease(u, d);
+            }
+        }
+    }
+    return dist;
+}
+
+
+template <class Engine>
+std::vector<long long> dijkstraWithPointers(const RandomGraph &g, int n) {
+    // the external vertex -> Handle array which IndexedHeap makes unnecessary
+    typedef PriorityQueue<std::pair<long long, int>, Engine> Queue;
+    std::vector<long long> dist(n, -1), tentative(n, -1);
+    std::vector<typename Queue::Handle> handles(n);
+    Queue h;
+    handles[0] = h.insert(std::make_pair(0ll, 0));
+    tentative[0] = 0;
+    while (!h.is_empty()) {
+        std::pair<long long, int> top = h.extract_min();
+        dist[top.second] = top.first;
+        for (int e = g.first[top.second]; e < g.first[top.second + 1]; ++e) {
+            int u = g.to[e];
+            long long d = top.first + g.weight[e];
+            if (dist[u] != -1) {
+                continue;
+            }
+            if (tentative[u] == -1) {
+                handles[u] = h.insert(std::make_pair(d, u));
+                tentative[u] = d;
+            }
+            else if (d < tentative[u]) {
+                h.decrease(handles[u], std::make_pair(d, u));
+                tentative[u] = d;
+            }
+        }
+    }
+    return dist;
+}
+
+
+TEST(DijkstraSameAsWithPointers, IndexedHeapCorrectnessTests) {
+    int n = 20000;
+    RandomGraph g(n, 8 * n, 145);
+    std::vector<long long> expected = dijkstraWithPointers<FibonacciHeap<std::pair<long long, int> > >(g, n);
+    ASSERT_EQ(dijkstraIndexed(g, n), expected);
+    std::vector<long long> with_heap = dijkstraWithPointers<Heap<std::pair<long long, int> > >(g, n);
+    ASSERT_EQ(with_heap, expected);
+}
+
+
+TEST(Dijkstra, DISABLED_IndexedHeapTimeTests) {
+    int n = 1000000;
+    RandomGraph g(n, 8 * n, 2024);
+    time_t t0 = clock();
+    dijkstraIndexed(g, n);
+    reportTime("IndexedHeap Dijkstra 10^6 vertices, 8 * 10^6 edges", (clock() - t0) * 1000 / CLOCKS_PER_SEC);
+    t0 = clock();
+    dijkstraWithPointers<Heap<std::pair<long long, int> > >(g, n);
+    reportTime("Heap with a Pointer array Dijkstra 10^6 vertices, 8 * 10^6 edges",
+               (clock() - t0) * 1000 / CLOCKS_PER_SEC);
+    t0 = clock();
+    dijkstraWithPointers<FibonacciHeap<std::pair<long long, int> > >(g, n);
+    reportTime("FibonacciHeap with a Pointer array Dijkstra 10^6 vertices, 8 * 10^6 edges",
+               (clock() - t0) * 1000 / CLOCKS_PER_SEC);
+}
@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "../KeyValue.h"
+#include "../Heap.h"
+#include "../BinomialHeap.h"
+#include "../FibonacciHeap.h"
+#include "TimeReport.h"
+#include <memory>
+#include <queue>
+#include <string>
+#include <ctime>
+
+using testing::Eq;
+
+
+// payload which counts its copies, moves are free
+class CountedPayload {
+public:
+    explicit CountedPayload(int id_ = 0) : id(id_) {}
+    CountedPayload(const CountedPayload &other) : id(other.id) {
+        ++copies();
+    }
+    CountedPayload(CountedPayload &&other) : id(other.id) {}
+    CountedPayload &operator=(const CountedPayload &other) {
+        id = other.id;
+        ++copies();
+        return *this;
+    }
+    CountedPayload &operator=(CountedPayload &&other) {
+        id = other.id;
+        return *this;
+    }
+
+    static int &copies() {
+        static int count = 0;
+        return count;
+    }
+
+    int id;
+};
+
+
+// the three heaps with the same interface for keys
+template <class Engine>
+class KeyValueTest : public testing::Test {};
+
+template <class Key>
+using BinaryHeap = Heap<Key>;
+
+template <class Key>
+using Binomial = BinomialHeap<Key>;
+
+template <class Key>
+using Fibonacci = FibonacciHeap<Key>;
+
+template <template <class> class EngineTemplate>
+struct EngineOf {
+    template <class Key>
+    using type = EngineTemplate<Key>;
+};
+
+typedef testing::Types<EngineOf<BinaryHeap>, EngineOf<Binomial>, EngineOf<Fibonacci> > Engines;
+TYPED_TEST_SUITE(KeyValueTest, Engines);
+
+
+TYPED_TEST(KeyValueTest, PayloadIsNeverCopied) {
+    typedef KeyValue<int, CountedPayload> Item;
+    typename TypeParam::template type<Item> h;
+    std::priority_queue<int> h2;
+    srand(143);
+    CountedPayload::copies() = 0;
+    for (int i = 0; i < 10000; ++i) {
+        int x = rand() % 1000;
+        if (i % 2) {
+            h.emplace(x, CountedPayload(x));
+        }
+        else {
+            h.insert(Item(x, CountedPayload(x)));
+        }
+        h2.push(-x);
+        if (i % 3 == 0) {
+            ASSERT_EQ(h.get_min().key, -h2.top());
+            Item item = h.extract_min();
+            ASSERT_EQ(item.key, -h2.top());
+            ASSERT_EQ(item.value.id, item.key);
+            h2.pop();
+        }
+    }
+    while (!h2.empty()) {
+        Item item = h.extract_min();
+        ASSERT_EQ(item.key, -h2.top());
+        ASSERT_EQ(item.value.id, item.key);
+        h2.pop();
+    }
+    ASSERT_EQ(CountedPayload::copies(), 0);
+}
+
+
+TYPED_TEST(KeyValueTest, MoveOnlyKeys) {
+    // unique_ptr can't be copied, KeyValue compares only the int
+    typedef KeyValue<int, std::unique_ptr<std::string> > Item;
+    typename TypeParam::template type<Item> h;
+    for (int i = 100; i > 0; --i) {
+        h.emplace(i, std::unique_ptr<std::string>(new std::string(std::to_string(i))));
+    }
+    ASSERT_EQ(*h.get_min().value, "1");
+    for (int i = 1; i <= 100; ++i) {
+        Item item = h.extract_min();
+        ASSERT_EQ(item.key, i);
+        ASSERT_EQ(*item.value, std::to_string(i));
+    }
+    ASSERT_EQ(h.is_empty(), true);
+}
+
+
+TYPED_TEST(KeyValueTest, PointerGivesReference) {
+    typedef KeyValue<int, std::string> Item;
+    typename TypeParam::template type<Item> h;
+    typename TypeParam::template type<Item>::Pointer ptr = h.emplace(5, "five");
+    h.emplace(7, "seven");
+    ASSERT_EQ(&ptr.getKey(), &h.get_min());
+    ASSERT_EQ(ptr.getKey().value, "five");
+}
+
+
+// 256-byte task descriptor, as in a scheduler queue
+struct Task {
+    long long priority;
+    char descriptor[248];
+
+    bool operator<(const Task &other) const {
+        return priority < other.priority;
+    }
+};
+
+
+TEST(TaskRoundTrip, DISABLED_KeyValueTimeTests) {
+    int q = 2000000;
+    Heap<Task> h;
+    srand(2024);
+    time_t t0 = clock();
+    for (int i = 0; i < q; ++i) {
+        Task task;
+        task.priority = rand();
+        h.insert(std::move(task));
+    }
+    for (int i = 0; i < q; ++i) {
+        Task task = h.extract_min();
+        (void)task;
+    }
+    reportTime("Heap 2 * 10^6 inserts and extracts of 256-byte tasks", (clock() - t0) * 1000 / CLOCKS_PER_SEC);
+}
@@ -0,0 +1,32 @@
+#ifndef HEAP_LOCKEDHEAP_H
+#define HEAP_LOCKEDHEAP_H
+
+
+#include <mutex>
+
+
+// Engine behind one mutex, the baseline for the concurrent queues
+template <class Key, class Engine>
+class LockedHeap {
+public:
+    void insert(Key key) {
+        std::lock_guard<std::mutex> guard(lock);
+        engine.insert(key);
+    }
+
+    bool try_extract_min(Key &result) {
+        std::lock_guard<std::mutex> guard(lock);
+        if (engine.is_empty()) {
+            return false;
+        }
+        result = engine.extract_min();
+        return true;
+    }
+
+private:
+    std::mutex lock;
+    Engine engine;
+};
+
+
+#endif //HEAP_LOCKEDHEAP_H
@@ -0,0 +1,233 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "../MinMaxHeap.h"
+#include "TimeReport.h"
+#include <queue>
+#include <set>
+
+using testing::Eq;
+
+
+TEST(InsertExtract, MinMaxHeapCorrectnessTests) {
+    int q = 1000;
+    MinMaxHeap<int> h;
+
+    ASSERT_EQ(h.is_empty(), true);
+    for (int i = q - 1; i >= 0; --i) {
+        h.insert(i);
+    }
+    for (int i = 0; i < q; ++i) {
+        ASSERT_EQ(h.extract_min(), i);
+    }
+    ASSERT_EQ(h.is_empty(), true);
+}
+
+
+TEST(InsertExtractMax, MinMaxHeapCorrectnessTests) {
+    int q = 1000;
+    MinMaxHeap<int> h;
+
+    for (int i = 0; i < q; ++i) {
+        h.insert(i);
+    }
+    for (int i = q - 1; i >= 0; --i) {
+        ASSERT_EQ(h.get_max(), i);
+        ASSERT_EQ(h.extract_max(), i);
+    }
+    ASSERT_EQ(h.is_empty(), true);
+}
+
+
+TEST(InsertExtractBothEndsRandOrder, MinMaxHeapCorrectnessTests) {
+    int q = 10000;
+    MinMaxHeap<int> h;
+    std::multiset<int> s;
+
+    srand(139);
+    for (int i = 0; i < q; ++i) {
+        int op = rand() % 3;
+        if (op == 0 || s.empty()) {
+            int x = rand() % 100;
+            h.insert(x);
+            s.insert(x);
+        }
+        else if (op == 1) {
+            ASSERT_EQ(h.extract_min(), *s.begin());
+            s.erase(s.begin());
+        }
+        else {
+            ASSERT_EQ(h.extract_max(), *s.rbegin());
+            s.erase(--s.end());
+        }
+        if (!s.empty()) {
+            ASSERT_EQ(h.get_min(), *s.begin());
+            ASSERT_EQ(h.get_max(), *s.rbegin());
+        }
+    }
+}
+
+
+TEST(InsertEraseByPointer, MinMaxHeapCorrectnessTests) {
+    srand(1791791791);
+    int q = 1000;
+
+    MinMaxHeap<int> h;
+    Vector<MinMaxHeap<int>::Pointer> arr;
+    for (int i = 0; i < q; ++i) {
+        arr.push_back(h.insert(i));
+    }
+
+    Vector<bool> alive(arr.size(), true);
+    for (int i = 0; i < q - 1; ++i) {
+        int id = rand() % (q - i);
+        Vector<int> pos;
+        for (int j = 0; j < q; ++j) {
+            if (alive[j]) {
+                pos.push_back(j);
+            }
+        }
+        int index = pos[id];
+        h.erase(arr[index]);
+        alive[index] = false;
+
+        for (size_t j = id; j + 1 < pos.size(); ++j) {
+            pos[j] = pos[j + 1];
+        }
+        pos.pop_back();
+
+        ASSERT_EQ(arr[pos[0]].getKey(), h.get_min());
+        ASSERT_EQ(arr[pos[pos.size() - 1]].getKey(), h.get_max());
+        ASSERT_EQ(h.is_empty(), false);
+    }
+    h.extract_max();
+    ASSERT_EQ(h.is_empty(), true);
+}
+
+
+TEST(RandomChangeErase, MinMaxHeapCorrectnessTests) {
+    srand(2018);
+    int q = 20000;
+
+    MinMaxHeap<int> h;
+    std::multiset<int> s;
+    Vector<MinMaxHeap<int>::Pointer> pointers;
+    Vector<int> keys;
+    Vector<bool> alive;
+    for (int i = 0; i < q; ++i) {
+        int op = rand() % 3;
+        if (op == 0 || s.empty()) {
+            int x = rand() % 100000;
+            pointers.push_back(h.insert(x));
+            keys.push_back(x);
+            alive.push_back(true);
+            s.insert(x);
+        }
+        else if (op == 1) {
+            int id = rand() % pointers.size();
+            if (alive[id]) {
+                int x = rand() % 100000;
+                s.erase(s.find(keys[id]));
+                s.insert(x);
+                h.change(pointers[id], x);
+                keys[id] = x;
+            }
+        }
+        else {
+            int id = rand() % pointers.size();
+            if (alive[id]) {
+                s.erase(s.find(keys[id]));
+                h.erase(pointers[id]);
+                alive[id] = false;
+            }
+        }
+        ASSERT_EQ(h.is_empty(), s.empty());
+        if (!s.empty()) {
+            ASSERT_EQ(h.get_min(), *s.begin());
+            ASSERT_EQ(h.get_max(), *s.rbegin());
+        }
+    }
+}
+
+
+TEST(ChangeMethod, MinMaxHeapCorrectnessTests) {
+    MinMaxHeap<int> h;
+    MinMaxHeap<int>::Pointer ptr = h.insert(1);
+    h.insert(2);
+    h.insert(3);
+    ASSERT_EQ(h.get_min(), 1);
+    ASSERT_EQ(h.get_max(), 3);
+    h.change(ptr, 4);
+    ASSERT_EQ(h.get_min(), 2);
+    ASSERT_EQ(h.get_max(), 4);
+    ASSERT_EQ(h.extract_max(), 4);
+    ASSERT_EQ(h.extract_max(), 3);
+    ASSERT_EQ(h.extract_max(), 2);
+    ASSERT_EQ(h.is_empty(), true);
+}
+
+
+TEST(GetMinMaxOnEmptyHeap, MinMaxHeapValidationTests) {
+    MinMaxHeap<int> h;
+    ASSERT_THROW(h.get_min(), std::logic_error);
+    ASSERT_THROW(h.get_max(), std::logic_error);
+    MinMaxHeap<int>::Pointer ptr = h.insert(1337);
+    ASSERT_NO_THROW(h.get_min());
+    ASSERT_NO_THROW(h.get_max());
+    h.erase(ptr);
+    ASSERT_THROW(h.get_max(), std::logic_error);
+}
+
+
+TEST(ExtractOnEmptyHeap, MinMaxHeapValidationTests) {
+    MinMaxHeap<int> h;
+    ASSERT_THROW(h.extract_min(), std::logic_error);
+    ASSERT_THROW(h.extract_max(), std::logic_error);
+    h.insert(1337);
+    ASSERT_NO_THROW(h.extract_max());
+    ASSERT_THROW(h.extract_min(), std::logic_error);
+}
+
+
+TEST(DestroyedHeapPointers, MinMaxHeapValidationTests) {
+    // nodes go with the heap, so their slots are reused by the next one
+    Vector<MinMaxHeap<int, SlotMapStorage>::Pointer> pointers;
+    size_t table_bytes = 0;
+    for (int round = 0; round < 3; ++round) {
+        MinMaxHeap<int, SlotMapStorage> h;
+        for (int i = 0; i < 100000; ++i) {
+            pointers.push_back(h.insert(i));
+        }
+        if (round == 0) {
+            table_bytes = h.memory_usage().table_bytes;
+        }
+        ASSERT_EQ(h.memory_usage().table_bytes, table_bytes);
+    }
+    for (size_t i = 0; i < pointers.size(); ++i) {
+        ASSERT_THROW(pointers[i].getKey(), std::invalid_argument);
+    }
+}
+
+
+TEST(InsertExtractBothEnds, DISABLED_MinMaxHeapTimeTests) {
+    time_t t0 = clock();
+
+    int q = 5000000;
+    MinMaxHeap<int> h;
+    srand(239);
+    for (int i = 0; i < q; ++i) {
+        int op = rand() % 4;
+        if (h.is_empty() || op < 2) {
+            h.insert(rand());
+        }
+        else if (op == 2) {
+            h.extract_min();
+        }
+        else {
+            h.extract_max();
+        }
+    }
+
+    int res = clock() - t0;
+
+    reportTime("MinMaxHeap inserts, extract_min and extract_max", res);
+}
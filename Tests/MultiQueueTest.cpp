@@ -0,0 +1,201 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "../MultiQueue.h"
+#include "../Heap.h"
+#include "TimeReport.h"
+#include "LockedHeap.h"
+#include <set>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <chrono>
+
+using testing::Eq;
+
+
+// how far from the true minimum extractions were, keys are tracked in a multiset
+class RankError {
+public:
+    RankError() : extractions(0), sum(0), worst(0) {}
+
+    void inserted(int key) {
+        keys.insert(key);
+    }
+
+    void extracted(int key) {
+        std::multiset<int>::iterator it = keys.find(key);
+        size_t rank = (size_t)std::distance(keys.begin(), it);
+        keys.erase(it);
+        ++extractions;
+        sum += rank;
+        worst = std::max(worst, rank);
+    }
+
+    double mean() const {
+        return extractions == 0 ? 0 : (double)sum / extractions;
+    }
+
+    size_t max() const {
+        return worst;
+    }
+
+private:
+    std::multiset<int> keys;
+    size_t extractions, sum, worst;
+};
+
+
+TEST(EveryKeyOnceSequential, MultiQueueCorrectnessTests) {
+    MultiQueue<int> h(4);
+    std::multiset<int> s;
+    srand(139);
+    for (int i = 0; i < 100000; ++i) {
+        if (rand() % 3) {
+            int x = rand() % 1000;
+            h.insert(x);
+            s.insert(x);
+        }
+        else if (!h.is_empty()) {
+            int x = h.extract_min();
+            ASSERT_NE(s.find(x), s.end());
+            s.erase(s.find(x));
+        }
+    }
+    ASSERT_EQ(h.size(), s.size());
+    int x;
+    while (h.try_extract_min(x)) {
+        ASSERT_NE(s.find(x), s.end());
+        s.erase(s.find(x));
+    }
+    ASSERT_EQ(s.empty(), true);
+    ASSERT_THROW(h.extract_min(), std::logic_error);
+}
+
+
+TEST(RankErrorIsSmall, MultiQueueCorrectnessTests) {
+    // with two choices expected rank error is O(number of shards)
+    MultiQueue<int> h(4);
+    RankError errors;
+    srand(2024);
+    for (int i = 0; i < 10000; ++i) {
+        int x = rand();
+        h.insert(x);
+        errors.inserted(x);
+    }
+    for (int i = 0; i < 20000; ++i) {
+        if (rand() % 2) {
+            int x = rand();
+            h.insert(x);
+            errors.inserted(x);
+        }
+        else {
+            errors.extracted(h.extract_min());
+        }
+    }
+    ASSERT_LT(errors.mean(), 2.0 * h.shards_count());
+}
+
+
+TEST(ParallelMixedEveryKeyOnce, MultiQueueCorrectnessTests) {
+    int threads = 8, per_thread = 50000;
+    MultiQueue<int> h(threads);
+    std::vector<std::atomic<int> > seen(threads * per_thread);
+    for (int i = 0; i < threads * per_thread; ++i) {
+        seen[i] = 0;
+    }
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.push_back(std::thread([&h, &seen, t, threads, per_thread]() {
+            int key;
+            for (int i = 0; i < per_thread; ++i) {
+                h.insert(i * threads + t);
+                if (i % 2 && h.try_extract_min(key)) {
+                    ++seen[key];
+                }
+            }
+        }));
+    }
+    for (int t = 0; t < threads; ++t) {
+        workers[t].join();
+    }
+    int key;
+    while (h.try_extract_min(key)) {
+        ++seen[key];
+    }
+    for (int i = 0; i < threads * per_thread; ++i) {
+        ASSERT_EQ(seen[i].load(), 1);
+    }
+}
+
+
+TEST(RankErrorByShards, DISABLED_MultiQueueTimeTests) {
+    // mean and max rank error for different numbers of shards, sequential
+    for (int threads = 1; threads <= 64; threads *= 4) {
+        MultiQueue<int> h(threads);
+        RankError errors;
+        srand(2024);
+        for (int i = 0; i < 100000; ++i) {
+            int x = rand();
+            h.insert(x);
+            errors.inserted(x);
+        }
+        for (int i = 0; i < 100000; ++i) {
+            if (rand() % 2) {
+                int x = rand();
+                h.insert(x);
+                errors.inserted(x);
+            }
+            else {
+                errors.extracted(h.extract_min());
+            }
+        }
+        std::string name = "MultiQueue " + std::to_string(h.shards_count()) + " shards rank error";
+        reportValue((name + " mean").c_str(), errors.mean());
+        reportValue((name + " max").c_str(), errors.max());
+    }
+}
+
+
+template <class Queue>
+int mixedOperationsTime(Queue &h, int threads, int per_thread) {
+    // every thread alternates inserts and extracts on a prefilled queue
+    for (int i = 0; i < 100000; ++i) {
+        h.insert(rand());
+    }
+    std::vector<std::thread> workers;
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; ++t) {
+        workers.push_back(std::thread([&h, t, per_thread]() {
+            unsigned int seed = t + 1;
+            int key;
+            for (int i = 0; i < per_thread; ++i) {
+                h.insert(rand_r(&seed));
+                h.try_extract_min(key);
+            }
+        }));
+    }
+    for (int t = 0; t < threads; ++t) {
+        workers[t].join();
+    }
+    return (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t0).count();
+}
+
+
+TEST(ThroughputByThreads, DISABLED_MultiQueueTimeTests) {
+    // the same number of operations for every thread count
+    int total = 4000000;
+    int cores = std::max((int)std::thread::hardware_concurrency(), 1);
+    for (int step = 1; ; step *= 2) {
+        // powers of two and all cores in the end
+        int threads = std::min(step, cores);
+        MultiQueue<int> multi(threads);
+        LockedHeap<int, Heap<int> > locked;
+        std::string name = std::to_string(threads) + " threads, inserts and extracts";
+        reportTime(("MultiQueue " + name).c_str(), mixedOperationsTime(multi, threads, total / threads));
+        reportTime(("Heap behind a mutex " + name).c_str(), mixedOperationsTime(locked, threads, total / threads));
+        if (threads == cores) {
+            break;
+        }
+    }
+}
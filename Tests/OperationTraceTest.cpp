@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "../OperationTrace.h"
+#include "../BinomialHeap.h"
+#include "../FibonacciHeap.h"
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+using testing::Eq;
+
+
+TEST(RecordAllOperations, OperationTraceCorrectnessTests) {
+    std::string path = testing::TempDir() + "heap_trace";
+    {
+        TraceWriter<int> writer(path);
+        RecordingQueue<int, BinomialHeap<int, SlotMapStorage> > first(writer), second(writer);
+        RecordingQueue<int, BinomialHeap<int, SlotMapStorage> >::Handle a = first.insert(5);
+        RecordingQueue<int, BinomialHeap<int, SlotMapStorage> >::Handle b = first.insert(7);
+        RecordingQueue<int, BinomialHeap<int, SlotMapStorage> >::Handle c = second.insert(3);
+        first.decrease(b, 1);
+        first.change(a, 9);
+        first.merge(second);
+        first.erase(c);
+        ASSERT_EQ(first.extract_min(), 1);
+        // failed operations are not written
+        ASSERT_THROW(first.erase(b), std::invalid_argument);
+        writer.close();
+    }
+
+    TraceReader<int> trace(path);
+    ASSERT_EQ(trace.queues(), 2u);
+    ASSERT_EQ(trace.handles(), 3u);
+    ASSERT_EQ(trace.size(), 8u);
+    int operations[] = {TRACE_INSERT, TRACE_INSERT, TRACE_INSERT, TRACE_DECREASE, TRACE_CHANGE,
+                        TRACE_MERGE, TRACE_ERASE, TRACE_EXTRACT_MIN};
+    uint32_t queues[] = {0, 0, 1, 0, 0, 0, 0, 0};
+    uint64_t handles[] = {0, 1, 2, 1, 0, 1, 2, 0};
+    int keys[] = {5, 7, 3, 1, 9, 0, 0, 1};
+    for (size_t i = 0; i < trace.size(); ++i) {
+        ASSERT_EQ(trace[i].operation, operations[i]);
+        ASSERT_EQ(trace[i].queue, queues[i]);
+        ASSERT_EQ(trace[i].handle, handles[i]);
+        ASSERT_EQ(trace[i].key, keys[i]);
+    }
+    remove(path.c_str());
+}
+
+
+TEST(ReplayReproducesRecording, OperationTraceCorrectnessTests) {
+    // what one engine recorded another one extracts in the same order
+    std::string path = testing::TempDir() + "heap_trace_replay";
+    srand(149);
+    {
+        TraceWriter<int> writer(path);
+        RecordingQueue<int, BinomialHeap<int> > queue(writer);
+        for (int i = 0; i < 10000; ++i) {
+            if (rand() % 3 || queue.is_empty()) {
+                queue.insert(rand() % 100000000);
+            }
+            else {
+                queue.extract_min();
+            }
+        }
+        writer.close();
+    }
+
+    TraceReader<int> trace(path);
+    FibonacciHeap<int> h;
+    for (size_t i = 0; i < trace.size(); ++i) {
+        if (trace[i].operation == TRACE_INSERT) {
+            h.insert(trace[i].key);
+        }
+        else {
+            ASSERT_EQ(trace[i].operation, TRACE_EXTRACT_MIN);
+            ASSERT_EQ(h.extract_min(), trace[i].key);
+        }
+    }
+    remove(path.c_str());
+}
+
+
+TEST(WrongKeySize, OperationTraceValidationTests) {
+    std::string path = testing::TempDir() + "heap_trace_key";
+    {
+        TraceWriter<int> writer(path);
+        RecordingQueue<int, BinomialHeap<int> > queue(writer);
+        queue.insert(1);
+        writer.close();
+    }
+    ASSERT_THROW(TraceReader<long long> trace(path), std::runtime_error);
+    remove(path.c_str());
+}
+
+
+TEST(CorruptedTrace, OperationTraceValidationTests) {
+    std::string path = testing::TempDir() + "heap_trace_corrupted";
+    {
+        TraceWriter<int> writer(path);
+        RecordingQueue<int, BinomialHeap<int> > queue(writer);
+        queue.insert(1);
+        queue.extract_min();
+        writer.close();
+    }
+    // the extraction is turned into an erase of an element which was never inserted
+    {
+        std::fstream file(path.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+        TraceRecord<int> record;
+        file.seekg(sizeof(SnapshotHeader) + sizeof(record));
+        file.read((char*)&record, sizeof(record));
+        record.operation = TRACE_ERASE;
+        record.handle = 5;
+        file.seekp(sizeof(SnapshotHeader) + sizeof(record));
+        file.write((const char*)&record, sizeof(record));
+    }
+    ASSERT_THROW(TraceReader<int> trace(path), std::runtime_error);
+    {
+        std::ofstream file(path.c_str(), std::ios::binary | std::ios::app);
+        file << "tail";
+    }
+    ASSERT_THROW(TraceReader<int> trace(path), std::runtime_error);
+    remove(path.c_str());
+}
@@ -0,0 +1,94 @@
+#ifndef HEAP_PERFCOUNTERS_H
+#define HEAP_PERFCOUNTERS_H
+
+
+#include <cstring>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+
+// Hardware counters of the calling thread through perf_event_open.
+// If the kernel doesn't allow it (perf_event_paranoid, containers) every value is -1.
+class PerfCounters {
+public:
+    enum Counter {
+        CYCLES,
+        CACHE_MISSES,
+        BRANCH_MISSES,
+        COUNTERS
+    };
+
+    PerfCounters();
+    ~PerfCounters();
+
+    void start();
+    void stop();
+    long long get(Counter) const;
+
+private:
+    int fds[COUNTERS];
+    long long values[COUNTERS];
+};
+
+
+
+inline PerfCounters::PerfCounters() {
+    unsigned long long configs[COUNTERS] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES
+    };
+    for (int i = 0; i < COUNTERS; ++i) {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = configs[i];
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fds[i] = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+        values[i] = -1;
+    }
+}
+
+
+inline PerfCounters::~PerfCounters() {
+    for (int i = 0; i < COUNTERS; ++i) {
+        if (fds[i] >= 0) {
+            close(fds[i]);
+        }
+    }
+}
+
+
+inline void PerfCounters::start() {
+    for (int i = 0; i < COUNTERS; ++i) {
+        if (fds[i] >= 0) {
+            ioctl(fds[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(fds[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+
+inline void PerfCounters::stop() {
+    for (int i = 0; i < COUNTERS; ++i) {
+        if (fds[i] >= 0) {
+            ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+            if (read(fds[i], &values[i], sizeof(values[i])) != sizeof(values[i])) {
+                values[i] = -1;
+            }
+        }
+    }
+}
+
+
+inline long long PerfCounters::get(Counter counter) const {
+    return values[counter];
+}
+
+
+#endif //HEAP_PERFCOUNTERS_H
@@ -0,0 +1,217 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "../PriorityQueue.h"
+#include "../Heap.h"
+#include "../BinomialHeap.h"
+#include "../FibonacciHeap.h"
+#include "../HollowHeap.h"
+#include "../WeakHeap.h"
+#include "../MinMaxHeap.h"
+#include "../BucketQueue.h"
+#include "../KeyValue.h"
+#include "TimeReport.h"
+#include <queue>
+#include <set>
+#include <memory>
+#include <string>
+
+using testing::Eq;
+
+
+static_assert(PriorityQueue<int, Heap<int> >::has_change, "Heap has change");
+static_assert(PriorityQueue<int, Heap<int> >::has_erase, "Heap has erase");
+static_assert(PriorityQueue<int, Heap<int> >::has_meld, "Heap has merge");
+static_assert(!EngineTraits<Heap<int>, int>::has_decrease, "Heap has no own decrease");
+static_assert(PriorityQueue<int, Heap<int> >::has_decrease, "Heap decreases through change");
+static_assert(PriorityQueue<int, FibonacciHeap<int> >::has_decrease, "FibonacciHeap has decrease");
+static_assert(!PriorityQueue<int, FibonacciHeap<int> >::has_erase, "FibonacciHeap has no erase");
+static_assert(!PriorityQueue<int, FibonacciHeap<int> >::has_change, "FibonacciHeap has no change");
+static_assert(PriorityQueue<int, FibonacciHeap<int> >::has_meld, "FibonacciHeap has merge");
+static_assert(PriorityQueue<int, HollowHeap<int> >::has_erase, "HollowHeap has erase");
+static_assert(!PriorityQueue<int, WeakHeap<int> >::has_meld, "WeakHeap has no merge");
+static_assert(!PriorityQueue<int, BucketQueue<int> >::has_meld, "BucketQueue has no merge");
+static_assert(EngineTraits<Heap<int>, int>::has_emplace, "Heap has emplace");
+static_assert(!EngineTraits<WeakHeap<int>, int>::has_emplace, "WeakHeap has no emplace");
+static_assert(std::is_same<PriorityQueue<int, Heap<int> >::MinResult, const int&>::value,
+              "Heap gives a reference to the minimum");
+static_assert(std::is_same<PriorityQueue<int, WeakHeap<int> >::KeyResult, int>::value, "WeakHeap gives copies");
+
+
+// every engine runs the same tests through PriorityQueue
+template <class Engine>
+class PriorityQueueTest : public testing::Test {
+public:
+    typedef PriorityQueue<int, Engine> Queue;
+};
+
+
+// BucketQueue needs its key range, all other engines are default constructed
+template <class Queue>
+struct QueueFactory {
+    static Queue *make() {
+        return new Queue();
+    }
+};
+
+template <>
+struct QueueFactory<PriorityQueue<int, BucketQueue<int> > > {
+    static PriorityQueue<int, BucketQueue<int> > *make() {
+        return new PriorityQueue<int, BucketQueue<int> >(100000);
+    }
+};
+
+
+typedef testing::Types<Heap<int>, Heap<int, BlockedLayout<>, BranchlessSift>, BinomialHeap<int>,
+                       FibonacciHeap<int>, HollowHeap<int>, WeakHeap<int>, MinMaxHeap<int>,
+                       BucketQueue<int> > Engines;
+TYPED_TEST_SUITE(PriorityQueueTest, Engines);
+
+
+TYPED_TEST(PriorityQueueTest, InsertExtractRandOrder) {
+    typedef typename TestFixture::Queue Queue;
+    Queue *h = QueueFactory<Queue>::make();
+    std::priority_queue<int> h2;
+
+    srand(139);
+    for (int i = 0; i < 10000; ++i) {
+        if (rand() % 3) {
+            int x = rand() % 100000;
+            h->insert(x);
+            h2.push(-x);
+        }
+        else if (!h->is_empty()) {
+            ASSERT_EQ(h->get_min(), -h2.top());
+            ASSERT_EQ(h->extract_min(), -h2.top());
+            h2.pop();
+        }
+    }
+    delete h;
+}
+
+
+TYPED_TEST(PriorityQueueTest, DecreaseThroughHandles) {
+    typedef typename TestFixture::Queue Queue;
+    Queue *h = QueueFactory<Queue>::make();
+    std::multiset<int> s;
+    Vector<typename Queue::Handle> handles;
+    Vector<int> keys;
+
+    srand(17);
+    for (int i = 0; i < 1000; ++i) {
+        int x = 50000 + rand() % 50000;
+        handles.push_back(h->insert(x));
+        keys.push_back(x);
+        s.insert(x);
+    }
+    for (int i = 0; i < 1000; ++i) {
+        int id = rand() % handles.size();
+        int x = keys[id] - rand() % 50;
+        s.erase(s.find(keys[id]));
+        s.insert(x);
+        h->decrease(handles[id], x);
+        keys[id] = x;
+        ASSERT_EQ(handles[id].getKey(), x);
+        ASSERT_EQ(h->get_min(), *s.begin());
+    }
+    ASSERT_THROW(h->decrease(handles[0], keys[0] + 1), std::invalid_argument);
+    for (std::multiset<int>::iterator it = s.begin(); it != s.end(); ++it) {
+        ASSERT_EQ(h->extract_min(), *it);
+    }
+    ASSERT_EQ(h->is_empty(), true);
+    delete h;
+}
+
+
+TEST(EraseAndChange, PriorityQueueCorrectnessTests) {
+    PriorityQueue<int, BinomialHeap<int> > h;
+    PriorityQueue<int, BinomialHeap<int> >::Handle a = h.insert(5);
+    h.insert(7);
+    PriorityQueue<int, BinomialHeap<int> >::Handle c = h.insert(3);
+    h.erase(c);
+    ASSERT_EQ(h.get_min(), 5);
+    h.change(a, 10);
+    ASSERT_EQ(h.extract_min(), 7);
+    ASSERT_EQ(h.extract_min(), 10);
+    ASSERT_EQ(h.is_empty(), true);
+}
+
+
+TEST(MergeQueues, PriorityQueueCorrectnessTests) {
+    PriorityQueue<int, FibonacciHeap<int> > h1, h2;
+    for (int i = 0; i < 100; ++i) {
+        if (i % 3) {
+            h1.insert(i);
+        }
+        else {
+            h2.insert(i);
+        }
+    }
+    h1.merge(h2);
+    ASSERT_EQ(h2.is_empty(), true);
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_EQ(h1.extract_min(), i);
+    }
+}
+
+
+TEST(EngineAccess, PriorityQueueCorrectnessTests) {
+    PriorityQueue<int, Heap<int> > h;
+    h.get_engine().optimize(10, 1);
+    for (int i = 100; i > 0; --i) {
+        h.insert(i);
+    }
+    for (int i = 1; i <= 100; ++i) {
+        ASSERT_EQ(h.extract_min(), i);
+    }
+}
+
+
+TEST(MoveOnlyKeys, PriorityQueueCorrectnessTests) {
+    // keys are moved through the facade and read in place
+    typedef KeyValue<int, std::unique_ptr<std::string> > Item;
+    typedef PriorityQueue<Item, BinomialHeap<Item> > Queue;
+    Queue h;
+    Queue::Handle five = h.emplace(5, std::unique_ptr<std::string>(new std::string("five")));
+    h.insert(Item(7, std::unique_ptr<std::string>(new std::string("seven"))));
+    ASSERT_EQ(&five.getKey(), &h.get_min());
+    ASSERT_EQ(*h.get_min().value, "five");
+    h.change(five, Item(9, std::unique_ptr<std::string>(new std::string("nine"))));
+    ASSERT_EQ(*h.extract_min().value, "seven");
+    ASSERT_EQ(*h.extract_min().value, "nine");
+    ASSERT_EQ(h.is_empty(), true);
+
+    PriorityQueue<std::string, WeakHeap<std::string> > strings;
+    strings.emplace(3, 'b');
+    strings.emplace(2, 'a');
+    ASSERT_EQ(strings.extract_min(), "aa");
+    ASSERT_EQ(strings.extract_min(), "bbb");
+}
+
+
+template <class Engine>
+int decreaseWorkloadTime() {
+    // Dijkstra-like mix of inserts and decreases, the engine is the only thing that changes
+    PriorityQueue<long long, Engine> h;
+    Vector<typename PriorityQueue<long long, Engine>::Handle> handles;
+    srand(123);
+    time_t t0 = clock();
+    for (int i = 0; i < 1000000; ++i) {
+        handles.push_back(h.insert(1000000000 + rand()));
+    }
+    for (int i = 0; i < 3000000; ++i) {
+        int id = rand() % handles.size();
+        h.decrease(handles[id], handles[id].getKey() - rand() % 1000);
+    }
+    while (!h.is_empty()) {
+        h.extract_min();
+    }
+    return clock() - t0;
+}
+
+
+TEST(DecreaseWorkload, DISABLED_PriorityQueueTimeTests) {
+    reportTime("PriorityQueue<Heap> decrease workload", decreaseWorkloadTime<Heap<long long> >());
+    reportTime("PriorityQueue<BinomialHeap> decrease workload", decreaseWorkloadTime<BinomialHeap<long long> >());
+    reportTime("PriorityQueue<FibonacciHeap> decrease workload", decreaseWorkloadTime<FibonacciHeap<long long> >());
+    reportTime("PriorityQueue<HollowHeap> decrease workload", decreaseWorkloadTime<HollowHeap<long long> >());
+}
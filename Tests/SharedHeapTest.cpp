@@ -0,0 +1,281 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "../SharedHeap.h"
+#include "../Heap.h"
+#include "TimeReport.h"
+#include <set>
+#include <vector>
+#include <string>
+#include <ctime>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/wait.h>
+
+using testing::Eq;
+
+
+// segments are global for the host, so every test process uses its own names
+std::string sharedName(const char *name) {
+    return std::string("/heap_test_") + name + "_" + std::to_string(getpid());
+}
+
+
+TEST(InsertEraseChangeRandOrder, SharedHeapCorrectnessTests) {
+    std::string name = sharedName("rand");
+    SharedHeap<int>::remove(name);
+    SharedHeap<int> h(name, 20000);
+    std::multiset<int> h2;
+    std::vector<SharedHeap<int>::Pointer> pointers;
+
+    srand(142);
+    for (int i = 0; i < 100000; ++i) {
+        int op = rand() % 6;
+        if (op < 3 && h.size() < h.capacity()) {
+            int x = rand() % 100000;
+            pointers.push_back(h.insert(x));
+            h2.insert(x);
+        }
+        else if (op == 3 && !pointers.empty()) {
+            // pointers of extracted elements are never used again, so only the last one is
+            // changed or erased when it is still there
+            int x = h.extract_min();
+            ASSERT_EQ(x, *h2.begin());
+            h2.erase(h2.begin());
+            pointers.clear();
+        }
+        else if (op == 4 && !pointers.empty()) {
+            int old_key = h.get_key(pointers.back()), x = rand() % 100000;
+            h.change(pointers.back(), x);
+            h2.erase(h2.find(old_key));
+            h2.insert(x);
+        }
+        else if (op == 5 && !pointers.empty()) {
+            h2.erase(h2.find(h.get_key(pointers.back())));
+            h.erase(pointers.back());
+            pointers.pop_back();
+        }
+        ASSERT_EQ(h.size(), h2.size());
+    }
+    while (!h2.empty()) {
+        ASSERT_EQ(h.extract_min(), *h2.begin());
+        h2.erase(h2.begin());
+    }
+    ASSERT_EQ(h.is_empty(), true);
+    SharedHeap<int>::remove(name);
+}
+
+
+TEST(ProcessesInsertAndExtract, SharedHeapCorrectnessTests) {
+    // producers and consumers are forked processes, consumers move keys into a second heap,
+    // so after all of them every key must be in exactly one of the two heaps
+    std::string name = sharedName("work"), done_name = sharedName("done");
+    SharedHeap<int>::remove(name);
+    SharedHeap<int>::remove(done_name);
+    int producers = 4, consumers = 2, per_producer = 20000, per_consumer = 15000;
+    SharedHeap<int> h(name, producers * per_producer);
+    SharedHeap<int> done(done_name, producers * per_producer);
+
+    std::vector<pid_t> children;
+    for (int p = 0; p < producers + consumers; ++p) {
+        pid_t pid = fork();
+        ASSERT_NE(pid, -1);
+        if (pid == 0) {
+            int status = 0;
+            try {
+                SharedHeap<int> child_h(name), child_done(done_name);
+                if (p < producers) {
+                    for (int i = 0; i < per_producer; ++i) {
+                        child_h.insert(i * producers + p);
+                    }
+                }
+                else {
+                    int key, got = 0;
+                    while (got < per_consumer) {
+                        if (child_h.try_extract_min(key)) {
+                            child_done.insert(key);
+                            ++got;
+                        }
+                    }
+                }
+            }
+            catch (...) {
+                status = 1;
+            }
+            _exit(status);
+        }
+        children.push_back(pid);
+    }
+    for (size_t i = 0; i < children.size(); ++i) {
+        int status;
+        waitpid(children[i], &status, 0);
+        ASSERT_EQ(WIFEXITED(status) && WEXITSTATUS(status) == 0, true);
+    }
+
+    ASSERT_EQ(done.size(), (size_t)(consumers * per_consumer));
+    ASSERT_EQ(h.size() + done.size(), (size_t)(producers * per_producer));
+    std::vector<int> seen(producers * per_producer, 0);
+    int key, last = -1;
+    while (h.try_extract_min(key)) {
+        ++seen[key];
+        ASSERT_LE(last, key);
+        last = key;
+    }
+    while (done.try_extract_min(key)) {
+        ++seen[key];
+    }
+    for (size_t i = 0; i < seen.size(); ++i) {
+        ASSERT_EQ(seen[i], 1);
+    }
+    SharedHeap<int>::remove(name);
+    SharedHeap<int>::remove(done_name);
+}
+
+
+TEST(KilledProcessLeavesValidHeap, SharedHeapCorrectnessTests) {
+    // the child is killed at a random moment, probably holding the robust mutex,
+    // then the heap must still give out distinct keys in order
+    std::string name = sharedName("killed");
+    SharedHeap<int>::remove(name);
+    int q = 1000000;
+    SharedHeap<int> h(name, q);
+    pid_t pid = fork();
+    ASSERT_NE(pid, -1);
+    if (pid == 0) {
+        SharedHeap<int> child_h(name);
+        for (int i = 0; i < q; ++i) {
+            child_h.insert(q - i);
+            if (i % 2) {
+                child_h.extract_min();
+            }
+        }
+        _exit(0);
+    }
+    usleep(20000);
+    kill(pid, SIGKILL);
+    waitpid(pid, nullptr, 0);
+
+    size_t size = h.size();
+    std::vector<int> seen(q + 1, 0);
+    int key, last = 0;
+    for (size_t i = 0; i < size; ++i) {
+        ASSERT_EQ(h.try_extract_min(key), true);
+        ASSERT_LE(last, key);
+        ASSERT_EQ(seen[key]++, 0);
+        last = key;
+    }
+    ASSERT_EQ(h.is_empty(), true);
+    h.insert(1);
+    ASSERT_EQ(h.extract_min(), 1);
+    SharedHeap<int>::remove(name);
+}
+
+
+struct IdKey {
+    int priority;
+    int id;
+};
+
+bool operator<(const IdKey &a, const IdKey &b) {
+    return a.priority < b.priority;
+}
+
+
+TEST(KilledDuringSwapsLosesNothing, SharedHeapCorrectnessTests) {
+    // the child only changes keys, so the heap is busy swapping when it is killed,
+    // and every element must survive the repair
+    std::string name = sharedName("swaps");
+    SharedHeap<IdKey>::remove(name);
+    int q = 1000;
+    SharedHeap<IdKey> h(name, q);
+    std::vector<SharedHeap<IdKey>::Pointer> pointers;
+    for (int i = 0; i < q; ++i) {
+        pointers.push_back(h.insert({rand(), i}));
+    }
+    for (int attempt = 0; attempt < 200; ++attempt) {
+        pid_t pid = fork();
+        ASSERT_NE(pid, -1);
+        if (pid == 0) {
+            SharedHeap<IdKey> child_h(name);
+            while (true) {
+                int i = rand() % q;
+                child_h.change(pointers[i], {rand(), i});
+            }
+        }
+        usleep(1000 + rand() % 2000);
+        kill(pid, SIGKILL);
+        waitpid(pid, nullptr, 0);
+        ASSERT_EQ(h.size(), (size_t)q);
+    }
+
+    std::vector<int> seen(q, 0);
+    IdKey key, last = {INT32_MIN, 0};
+    for (int i = 0; i < q; ++i) {
+        ASSERT_EQ(h.try_extract_min(key), true);
+        ASSERT_LE(last.priority, key.priority);
+        ASSERT_EQ(seen[key.id]++, 0);
+        last = key;
+    }
+    ASSERT_EQ(h.is_empty(), true);
+    SharedHeap<IdKey>::remove(name);
+}
+
+
+TEST(CreateAttachErrors, SharedHeapValidationTests) {
+    std::string name = sharedName("errors");
+    SharedHeap<int>::remove(name);
+    ASSERT_THROW(SharedHeap<int> h(name), std::runtime_error);
+    SharedHeap<int> h(name, 2);
+    ASSERT_THROW(SharedHeap<int> again(name, 2), std::runtime_error);
+    ASSERT_THROW(SharedHeap<long long> other_key(name), std::runtime_error);
+    SharedHeap<int> attached(name);
+    ASSERT_EQ(attached.capacity(), (size_t)2);
+    SharedHeap<int>::remove(name);
+}
+
+
+TEST(FullAndEmpty, SharedHeapValidationTests) {
+    std::string name = sharedName("full");
+    SharedHeap<int>::remove(name);
+    SharedHeap<int> h(name, 2);
+    ASSERT_THROW(h.extract_min(), std::logic_error);
+    ASSERT_THROW(h.get_min(), std::logic_error);
+    SharedHeap<int>::Pointer ptr = h.insert(1);
+    h.insert(2);
+    ASSERT_THROW(h.insert(3), std::logic_error);
+    h.erase(ptr);
+    ASSERT_THROW(h.erase(ptr), std::invalid_argument);
+    ASSERT_EQ(h.extract_min(), 2);
+    ASSERT_THROW(h.extract_min(), std::logic_error);
+    SharedHeap<int>::remove(name);
+}
+
+
+TEST(InsertExtract, DISABLED_SharedHeapTimeTests) {
+    // the price of the process-shared lock against Heap in one process
+    std::string name = sharedName("time");
+    SharedHeap<int>::remove(name);
+    int q = 5000000;
+    {
+        SharedHeap<int> h(name, q);
+        srand(2024);
+        time_t t0 = clock();
+        for (int i = 0; i < q; ++i) {
+            h.insert(rand());
+        }
+        for (int i = 0; i < q; ++i) {
+            h.extract_min();
+        }
+        reportTime("SharedHeap 5 * 10^6 inserts and extracts", (clock() - t0) * 1000 / CLOCKS_PER_SEC);
+    }
+    SharedHeap<int>::remove(name);
+    Heap<int> h;
+    srand(2024);
+    time_t t0 = clock();
+    for (int i = 0; i < q; ++i) {
+        h.insert(rand());
+    }
+    for (int i = 0; i < q; ++i) {
+        h.extract_min();
+    }
+    reportTime("Heap 5 * 10^6 inserts and extracts", (clock() - t0) * 1000 / CLOCKS_PER_SEC);
+}
@@ -0,0 +1,198 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "../SkipListPriorityQueue.h"
+#include "../Heap.h"
+#include "../FibonacciHeap.h"
+#include "TimeReport.h"
+#include "LockedHeap.h"
+#include <queue>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <chrono>
+
+using testing::Eq;
+
+
+TEST(InsertExtractRandOrder, SkipListPriorityQueueCorrectnessTests) {
+    for (int max_offset = 1; max_offset <= 64; max_offset *= 8) {
+        SkipListPriorityQueue<int> h(max_offset);
+        std::priority_queue<int> h2;
+
+        srand(139);
+        for (int i = 0; i < 100000; ++i) {
+            if (rand() % 3) {
+                int x = rand() % 1000;
+                h.insert(x);
+                h2.push(-x);
+            }
+            else if (!h2.empty()) {
+                ASSERT_EQ(h.extract_min(), -h2.top());
+                h2.pop();
+            }
+        }
+        while (!h2.empty()) {
+            ASSERT_EQ(h.is_empty(), false);
+            ASSERT_EQ(h.extract_min(), -h2.top());
+            h2.pop();
+        }
+        ASSERT_EQ(h.is_empty(), true);
+        ASSERT_THROW(h.extract_min(), std::logic_error);
+    }
+}
+
+
+TEST(ParallelDeletesAreMonotone, SkipListPriorityQueueCorrectnessTests) {
+    // without concurrent inserts every thread must see its keys in increasing order,
+    // and all threads together every key exactly once
+    int threads = 8, q = 200000;
+    SkipListPriorityQueue<int> h(4);
+    for (int i = 0; i < q; ++i) {
+        h.insert((int)(((long long)i * 7919) % q));
+    }
+    std::vector<std::atomic<int> > seen(q);
+    for (int i = 0; i < q; ++i) {
+        seen[i] = 0;
+    }
+    std::atomic<bool> order_broken(false);
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.push_back(std::thread([&]() {
+            int key, last = -1;
+            while (h.try_extract_min(key)) {
+                ++seen[key];
+                if (key < last) {
+                    order_broken = true;
+                }
+                last = key;
+            }
+        }));
+    }
+    for (int t = 0; t < threads; ++t) {
+        workers[t].join();
+    }
+    ASSERT_EQ(order_broken.load(), false);
+    for (int i = 0; i < q; ++i) {
+        ASSERT_EQ(seen[i].load(), 1);
+    }
+    ASSERT_EQ(h.is_empty(), true);
+}
+
+
+TEST(ParallelMixedEveryKeyOnce, SkipListPriorityQueueCorrectnessTests) {
+    int threads = 8, per_thread = 50000;
+    SkipListPriorityQueue<int> h(8);
+    std::vector<std::atomic<int> > seen(threads * per_thread);
+    for (int i = 0; i < threads * per_thread; ++i) {
+        seen[i] = 0;
+    }
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.push_back(std::thread([&h, &seen, t, threads, per_thread]() {
+            int key;
+            for (int i = 0; i < per_thread; ++i) {
+                h.insert(i * threads + t);
+                if (i % 2 && h.try_extract_min(key)) {
+                    ++seen[key];
+                }
+            }
+        }));
+    }
+    for (int t = 0; t < threads; ++t) {
+        workers[t].join();
+    }
+    int key;
+    while (h.try_extract_min(key)) {
+        ++seen[key];
+    }
+    for (int i = 0; i < threads * per_thread; ++i) {
+        ASSERT_EQ(seen[i].load(), 1);
+    }
+}
+
+
+TEST(RetiredNodesStayBounded, SkipListPriorityQueueCorrectnessTests) {
+    // a steady load removes far more nodes than may ever wait to be freed at once;
+    // a thread preempted inside an operation holds freeing back, so with few cores
+    // the peak depends on the scheduler and only a loose bound is checked
+    int threads = 4, per_thread = 200000;
+    SkipListPriorityQueue<int> h(8);
+    for (int i = 0; i < 1000; ++i) {
+        h.insert(i);
+    }
+    std::atomic<size_t> most_retired(0);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.push_back(std::thread([&h, &most_retired, t, per_thread]() {
+            unsigned int seed = t + 1;
+            int key;
+            for (int i = 0; i < per_thread; ++i) {
+                h.insert(rand_r(&seed) % 1000000);
+                h.try_extract_min(key);
+                size_t retired = h.retired_count();
+                size_t most = most_retired.load();
+                while (retired > most && !most_retired.compare_exchange_weak(most, retired)) {
+                }
+            }
+        }));
+    }
+    for (int t = 0; t < threads; ++t) {
+        workers[t].join();
+    }
+    ASSERT_LT(most_retired.load(), (size_t)threads * per_thread / 2);
+    // alone, a thread frees everything but the last few cuts
+    int key;
+    for (int i = 0; i < 1000; ++i) {
+        h.insert(i);
+        h.try_extract_min(key);
+    }
+    ASSERT_LT(h.retired_count(), 100u);
+}
+
+
+template <class Queue>
+int mixedOperationsTime(Queue &h, int threads, int per_thread) {
+    // every thread alternates inserts and extracts on a prefilled queue
+    for (int i = 0; i < 100000; ++i) {
+        h.insert(rand());
+    }
+    std::vector<std::thread> workers;
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; ++t) {
+        workers.push_back(std::thread([&h, t, per_thread]() {
+            unsigned int seed = t + 1;
+            int key;
+            for (int i = 0; i < per_thread; ++i) {
+                h.insert(rand_r(&seed));
+                h.try_extract_min(key);
+            }
+        }));
+    }
+    for (int t = 0; t < threads; ++t) {
+        workers[t].join();
+    }
+    return (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t0).count();
+}
+
+
+TEST(ThroughputByThreads, DISABLED_SkipListPriorityQueueTimeTests) {
+    // the same number of operations for every thread count
+    int total = 2000000;
+    int cores = std::max((int)std::thread::hardware_concurrency(), 1);
+    for (int step = 1; ; step *= 2) {
+        int threads = std::min(step, cores);
+        SkipListPriorityQueue<int> skip_list;
+        LockedHeap<int, Heap<int> > locked_heap;
+        LockedHeap<int, FibonacciHeap<int> > locked_fibonacci;
+        std::string name = std::to_string(threads) + " threads, inserts and extracts";
+        reportTime(("SkipListPriorityQueue " + name).c_str(), mixedOperationsTime(skip_list, threads, total / threads));
+        reportTime(("Heap behind a mutex " + name).c_str(), mixedOperationsTime(locked_heap, threads, total / threads));
+        reportTime(("FibonacciHeap behind a mutex " + name).c_str(),
+                   mixedOperationsTime(locked_fibonacci, threads, total / threads));
+        if (threads == cores) {
+            break;
+        }
+    }
+}
@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "../SlotMap.h"
+#include "TimeReport.h"
+#include <set>
+#include <thread>
+#include <vector>
+#include <ctime>
+
+using testing::Eq;
+
+
+struct Element {
+    int value;
+    static int alive;
+
+    explicit Element(int value_) : value(value_) {
+        ++alive;
+    }
+    ~Element() {
+        --alive;
+    }
+};
+
+int Element::alive = 0;
+
+
+struct ThrowingElement {
+    explicit ThrowingElement(bool fail) {
+        if (fail) {
+            throw std::runtime_error("constructor failed");
+        }
+    }
+};
+
+
+TEST(CreateGetDestroy, SlotMapCorrectnessTests) {
+    std::vector<Element*> elements;
+    std::vector<SlotMap<Element>::Handle> handles;
+    // more than the first chunk, so indices of several chunks are checked
+    int n = 5000;
+    for (int i = 0; i < n; ++i) {
+        elements.push_back(SlotMap<Element>::create(i));
+        handles.push_back(SlotMap<Element>::handle(elements[i]));
+    }
+    ASSERT_EQ(Element::alive, n);
+    for (int i = 0; i < n; ++i) {
+        ASSERT_EQ(SlotMap<Element>::get(handles[i]), elements[i]);
+        ASSERT_EQ(SlotMap<Element>::get(handles[i])->value, i);
+    }
+    for (int i = 0; i < n; i += 2) {
+        SlotMap<Element>::destroy(elements[i]);
+    }
+    ASSERT_EQ(Element::alive, n / 2);
+    for (int i = 0; i < n; ++i) {
+        if (i % 2 == 0) {
+            ASSERT_EQ(SlotMap<Element>::get(handles[i]), nullptr);
+        }
+        else {
+            ASSERT_EQ(SlotMap<Element>::get(handles[i])->value, i);
+        }
+    }
+    for (int i = 1; i < n; i += 2) {
+        SlotMap<Element>::destroy(elements[i]);
+    }
+    ASSERT_EQ(Element::alive, 0);
+    // chunks are kept
+    ASSERT_GE(SlotMap<Element>::table_bytes(), n * SlotMap<Element>::slot_bytes());
+}
+
+
+TEST(ReusedSlot, SlotMapCorrectnessTests) {
+    // the freed slot is the first one to be taken again by the same thread
+    Element *first = SlotMap<Element>::create(1);
+    SlotMap<Element>::Handle old_handle = SlotMap<Element>::handle(first);
+    SlotMap<Element>::destroy(first);
+    Element *second = SlotMap<Element>::create(2);
+    SlotMap<Element>::Handle new_handle = SlotMap<Element>::handle(second);
+    ASSERT_EQ(first, second);
+    ASSERT_EQ(SlotMap<Element>::get(old_handle), nullptr);
+    ASSERT_EQ(SlotMap<Element>::get(new_handle), second);
+    ASSERT_EQ(SlotMap<Element>::get(SlotMap<Element>::Handle()), nullptr);
+    SlotMap<Element>::destroy(second);
+    ASSERT_EQ(SlotMap<Element>::get(new_handle), nullptr);
+}
+
+
+TEST(ThrowingConstructor, SlotMapCorrectnessTests) {
+    ASSERT_THROW(SlotMap<ThrowingElement>::create(true), std::runtime_error);
+    ThrowingElement *element = SlotMap<ThrowingElement>::create(false);
+    SlotMap<ThrowingElement>::Handle handle = SlotMap<ThrowingElement>::handle(element);
+    ASSERT_EQ(SlotMap<ThrowingElement>::get(handle), element);
+    SlotMap<ThrowingElement>::destroy(element);
+}
+
+
+TEST(SeveralThreads, SlotMapCorrectnessTests) {
+    // every thread creates and destroys its own elements, slots migrate between threads
+    // through the common list, and no slot is ever taken twice at once
+    size_t threads = 4;
+    int n = 20000;
+    std::vector<std::vector<int*> > kept(threads);
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.push_back(std::thread([&kept, t, n]() {
+            std::vector<int*> alive;
+            for (int i = 0; i < n; ++i) {
+                if (!alive.empty() && rand() % 2 == 0) {
+                    SlotMap<int>::destroy(alive.back());
+                    alive.pop_back();
+                }
+                alive.push_back(SlotMap<int>::create((int)t));
+            }
+            kept[t] = alive;
+        }));
+    }
+    for (size_t t = 0; t < threads; ++t) {
+        workers[t].join();
+    }
+    std::set<int*> distinct;
+    for (size_t t = 0; t < threads; ++t) {
+        for (size_t i = 0; i < kept[t].size(); ++i) {
+            ASSERT_EQ(*kept[t][i], (int)t);
+            distinct.insert(kept[t][i]);
+            ASSERT_NE(SlotMap<int>::get(SlotMap<int>::handle(kept[t][i])), nullptr);
+        }
+    }
+    size_t total = 0;
+    for (size_t t = 0; t < threads; ++t) {
+        total += kept[t].size();
+        for (size_t i = 0; i < kept[t].size(); ++i) {
+            SlotMap<int>::destroy(kept[t][i]);
+        }
+    }
+    ASSERT_EQ(distinct.size(), total);
+}
+
+
+TEST(CreateDestroy, DISABLED_SlotMapTimeTests) {
+    int n = 1000000, rounds = 20;
+    std::vector<long long*> elements(n);
+
+    time_t t0 = clock();
+    for (int r = 0; r < rounds; ++r) {
+        for (int i = 0; i < n; ++i) {
+            elements[i] = new long long(i);
+        }
+        for (int i = 0; i < n; ++i) {
+            delete elements[i];
+        }
+    }
+    reportTime("NewDelete", (int)((clock() - t0) * 1000 / CLOCKS_PER_SEC));
+
+    t0 = clock();
+    for (int r = 0; r < rounds; ++r) {
+        for (int i = 0; i < n; ++i) {
+            elements[i] = SlotMap<long long>::create(i);
+        }
+        for (int i = 0; i < n; ++i) {
+            SlotMap<long long>::destroy(elements[i]);
+        }
+    }
+    reportTime("SlotMapCreateDestroy", (int)((clock() - t0) * 1000 / CLOCKS_PER_SEC));
+}
@@ -2,15 +2,41 @@
 #define HEAP_TIMEREPORT_H
 
 
+#include <cstdlib>
 #include <fstream>
 
+
+// results of DISABLED_*TimeTests are appended to the file named by HEAP_TIME_RESULTS,
+// or to time_results.txt in the working directory; Benchmarks/ has the proper harness
+inline const char *timeResultsPath() {
+    const char *path = getenv("HEAP_TIME_RESULTS");
+    return path != nullptr ? path : "time_results.txt";
+}
+
+
 inline void reportTime(const char *name, int res) {
-    // deal with CLion bug with relative paths
-    std::ofstream fout("C:\\Users\\M\\alg\\labs\\heap\\time_results.txt", std::ios::app);
+    std::ofstream fout(timeResultsPath(), std::ios::app);
     fout << name << ": " << res << " ms" << std::endl;
     fout.close();
 }
 
 
+inline void reportCounters(const char *name, long long cycles, long long cache_misses, long long branch_misses) {
+    // -1 means the counter is not available
+    std::ofstream fout(timeResultsPath(), std::ios::app);
+    fout << name << ": " << cycles << " cycles, " << cache_misses << " cache misses, "
+         << branch_misses << " branch misses" << std::endl;
+    fout.close();
+}
+
+
+inline void reportValue(const char *name, double value) {
+    // for results which are not times
+    std::ofstream fout(timeResultsPath(), std::ios::app);
+    fout << name << ": " << value << std::endl;
+    fout.close();
+}
+
+
 
 #endif //HEAP_TIMEREPORT_H
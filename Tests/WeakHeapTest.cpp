@@ -0,0 +1,318 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "../WeakHeap.h"
+#include "../Heap.h"
+#include "TimeReport.h"
+#include <queue>
+#include <set>
+#include <string>
+#include <cmath>
+
+using testing::Eq;
+
+
+// key which counts its comparisons, to measure engines that don't count them themselves
+struct CountingKey {
+    static size_t comparisons;
+    int value;
+
+    CountingKey(int value_ = 0) : value(value_) {}
+
+    bool operator<(const CountingKey &other) const {
+        ++comparisons;
+        return value < other.value;
+    }
+};
+
+size_t CountingKey::comparisons = 0;
+
+
+TEST(InsertExtract, WeakHeapCorrectnessTests) {
+    int q = 1000;
+    WeakHeap<int> h;
+
+    ASSERT_EQ(h.is_empty(), true);
+    for (int i = q - 1; i >= 0; --i) {
+        h.insert(i);
+    }
+    for (int i = 0; i < q; ++i) {
+        ASSERT_EQ(h.extract_min(), i);
+    }
+    ASSERT_EQ(h.is_empty(), true);
+}
+
+
+TEST(InsertExtractRandOrder, WeakHeapCorrectnessTests) {
+    int q = 1000;
+    WeakHeap<int> h;
+    std::priority_queue<int> h2;
+
+    srand(139);
+    for (int i = 0; i < q; ++i) {
+        if (rand() % 3) {
+            int x = rand() % 100;
+            h.insert(x);
+            h2.push(-x);
+        }
+        else if (!h.is_empty()) {
+            ASSERT_EQ(h.extract_min(), -h2.top());
+            h2.pop();
+        }
+    }
+}
+
+
+TEST(InsertEraseByPointer, WeakHeapCorrectnessTests) {
+    srand(1791791791);
+    int q = 1000;
+
+    WeakHeap<int> h;
+    Vector<WeakHeap<int>::Pointer> arr;
+    for (int i = 0; i < q; ++i) {
+        arr.push_back(h.insert(i));
+    }
+
+    Vector<bool> alive(arr.size(), true);
+    for (int i = 0; i < q - 1; ++i) {
+        int id = rand() % (q - i);
+        Vector<int> pos;
+        for (int j = 0; j < q; ++j) {
+            if (alive[j]) {
+                pos.push_back(j);
+            }
+        }
+        int index = pos[id];
+        h.erase(arr[index]);
+        alive[index] = false;
+
+        for (size_t j = id; j + 1 < pos.size(); ++j) {
+            pos[j] = pos[j + 1];
+        }
+        pos.pop_back();
+
+        ASSERT_EQ(arr[pos[0]].getKey(), h.get_min());
+        ASSERT_EQ(h.is_empty(), false);
+    }
+    h.extract_min();
+    ASSERT_EQ(h.is_empty(), true);
+}
+
+
+TEST(ChangeMethod, WeakHeapCorrectnessTests) {
+    WeakHeap<int> h;
+    WeakHeap<int>::Pointer ptr = h.insert(1);
+    h.insert(2);
+    WeakHeap<int>::Pointer ptr3 = h.insert(3);
+    ASSERT_EQ(h.get_min(), 1);
+    h.change(ptr, 4);
+    ASSERT_EQ(h.get_min(), 2);
+    h.change(ptr3, 0);
+    ASSERT_EQ(h.extract_min(), 0);
+    ASSERT_EQ(h.extract_min(), 2);
+    ASSERT_EQ(h.extract_min(), 4);
+    ASSERT_EQ(h.is_empty(), true);
+}
+
+
+TEST(RandomChangeErase, WeakHeapCorrectnessTests) {
+    srand(2018);
+    int q = 20000;
+
+    WeakHeap<int> h;
+    std::multiset<int> s;
+    Vector<WeakHeap<int>::Pointer> pointers;
+    Vector<int> keys;
+    Vector<bool> alive;
+    for (int i = 0; i < q; ++i) {
+        int op = rand() % 4;
+        if (op == 0 || s.empty()) {
+            int x = rand() % 100000;
+            pointers.push_back(h.insert(x));
+            keys.push_back(x);
+            alive.push_back(true);
+            s.insert(x);
+        }
+        else if (op == 1) {
+            int id = rand() % pointers.size();
+            if (alive[id]) {
+                int x = rand() % 100000;
+                s.erase(s.find(keys[id]));
+                s.insert(x);
+                h.change(pointers[id], x);
+                keys[id] = x;
+            }
+        }
+        else if (op == 2) {
+            int id = rand() % pointers.size();
+            if (alive[id]) {
+                s.erase(s.find(keys[id]));
+                h.erase(pointers[id]);
+                alive[id] = false;
+            }
+        }
+        else {
+            int x = h.get_min();
+            ASSERT_EQ(x, *s.begin());
+            for (size_t j = 0; j < pointers.size(); ++j) {
+                if (alive[j] && keys[j] == x) {
+                    h.erase(pointers[j]);
+                    alive[j] = false;
+                    break;
+                }
+            }
+            s.erase(s.begin());
+        }
+        ASSERT_EQ(h.is_empty(), s.empty());
+        if (!s.empty()) {
+            ASSERT_EQ(h.get_min(), *s.begin());
+        }
+    }
+}
+
+
+TEST(IteratorConstructor, WeakHeapCorrectnessTests) {
+    int q = 1000;
+    int *a = new int[q];
+    srand(42);
+    for (int i = 0; i < q; ++i) {
+        a[i] = rand() % 100;
+    }
+    std::multiset<int> s(a, a + q);
+    WeakHeap<int> h(a, a + q);
+    ASSERT_EQ(h.comparisons(), (size_t)q - 1);
+    for (std::multiset<int>::iterator it = s.begin(); it != s.end(); ++it) {
+        ASSERT_EQ(h.extract_min(), *it);
+    }
+    ASSERT_EQ(h.is_empty(), true);
+    delete[] a;
+}
+
+
+TEST(StringKeys, WeakHeapCorrectnessTests) {
+    WeakHeap<std::string> h;
+    h.insert("pear");
+    h.insert("apple");
+    h.insert("plum");
+    h.insert("fig");
+    ASSERT_EQ(h.extract_min(), "apple");
+    ASSERT_EQ(h.extract_min(), "fig");
+    ASSERT_EQ(h.extract_min(), "pear");
+    ASSERT_EQ(h.extract_min(), "plum");
+}
+
+
+TEST(SortComparisons, WeakHeapCorrectnessTests) {
+    // building and draining n keys is n log n + O(n) comparisons
+    int q = 1 << 14;
+    Vector<int> a;
+    srand(7);
+    for (int i = 0; i < q; ++i) {
+        a.push_back(rand());
+    }
+    WeakHeap<int> h(&a[0], &a[0] + q);
+    for (int i = 0; i < q; ++i) {
+        h.extract_min();
+    }
+    ASSERT_LE(h.comparisons(), (size_t)q * 14 + 2 * (size_t)q);
+}
+
+
+TEST(ComparisonsAgainstHeap, WeakHeapCorrectnessTests) {
+    int q = 1 << 14;
+    Vector<int> a;
+    srand(8);
+    for (int i = 0; i < q; ++i) {
+        a.push_back(rand());
+    }
+
+    WeakHeap<CountingKey> weak;
+    Heap<CountingKey> heap;
+    for (int i = 0; i < q; ++i) {
+        weak.insert(a[i]);
+        heap.insert(a[i]);
+    }
+
+    CountingKey::comparisons = 0;
+    size_t weak_before = weak.comparisons();
+    for (int i = 0; i < q; ++i) {
+        ASSERT_EQ(weak.extract_min().value, heap.extract_min().value);
+    }
+    size_t weak_count = weak.comparisons() - weak_before;
+    // both engines go through CountingKey, weak heap counts its own part exactly
+    size_t heap_count = CountingKey::comparisons - weak_count;
+
+    ASSERT_LT(weak_count, heap_count);
+    ASSERT_LE(weak_count, (size_t)q * 14);
+}
+
+
+TEST(GetMin, WeakHeapValidationTests) {
+    WeakHeap<int> h;
+    ASSERT_THROW(h.get_min(), std::logic_error);
+    h.insert(1);
+    ASSERT_NO_THROW(h.get_min());
+}
+
+
+TEST(ExtractMin, WeakHeapValidationTests) {
+    WeakHeap<int> h;
+    ASSERT_THROW(h.extract_min(), std::logic_error);
+    h.insert(1);
+    ASSERT_NO_THROW(h.extract_min());
+}
+
+
+TEST(DestroyedHeapPointers, WeakHeapValidationTests) {
+    Vector<WeakHeap<int, SlotMapStorage>::Pointer> pointers;
+    {
+        WeakHeap<int, SlotMapStorage> h;
+        for (int i = 0; i < 1000; ++i) {
+            pointers.push_back(h.insert(i));
+        }
+        h.extract_min();
+    }
+    for (size_t i = 0; i < pointers.size(); ++i) {
+        ASSERT_THROW(pointers[i].getKey(), std::invalid_argument);
+    }
+}
+
+
+TEST(InsertExtractStrings, DISABLED_WeakHeapTimeTests) {
+    time_t t0 = clock();
+
+    int q = 2000000;
+    WeakHeap<std::string> h;
+    srand(239);
+    for (int i = 0; i < q; ++i) {
+        if (!h.is_empty() && !(rand() % 3)) {
+            h.extract_min();
+        }
+        else {
+            h.insert("key-" + std::to_string(rand()));
+        }
+    }
+    int res = clock() - t0;
+
+    reportTime("WeakHeap inserts and extracts, string keys", res);
+}
+
+
+TEST(HeapInsertExtractStrings, DISABLED_WeakHeapTimeTests) {
+    // the same workload on Heap<std::string> for comparison
+    time_t t0 = clock();
+
+    int q = 2000000;
+    Heap<std::string> h;
+    srand(239);
+    for (int i = 0; i < q; ++i) {
+        if (!h.is_empty() && !(rand() % 3)) {
+            h.extract_min();
+        }
+        else {
+            h.insert("key-" + std::to_string(rand()));
+        }
+    }
+    int res = clock() - t0;
+
+    reportTime("Heap inserts and extracts, string keys", res);
+}
@@ -0,0 +1,249 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "../WorkStealingQueues.h"
+#include "../FibonacciHeap.h"
+#include "../BinomialHeap.h"
+#include "../Heap.h"
+#include "TimeReport.h"
+#include "LockedHeap.h"
+#include <queue>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <chrono>
+
+using testing::Eq;
+
+
+TEST(SingleWorkerGetsEverything, WorkStealingQueuesCorrectnessTests) {
+    // published elements come back to the owner when its local engine is empty
+    WorkStealingQueues<int> h(1, 4);
+    std::priority_queue<int> h2;
+    srand(139);
+    for (int i = 0; i < 100000; ++i) {
+        if (rand() % 3) {
+            int x = rand() % 1000;
+            h.push(0, x);
+            h2.push(-x);
+        }
+        else if (!h2.empty()) {
+            int x;
+            ASSERT_EQ(h.try_pop(0, x), true);
+            h2.pop();
+        }
+    }
+    int x, count = 0;
+    while (h.try_pop(0, x)) {
+        ++count;
+    }
+    ASSERT_EQ(count, h2.size());
+}
+
+
+TEST(IdleWorkerSteals, WorkStealingQueuesCorrectnessTests) {
+    WorkStealingQueues<int, BinomialHeap<int> > h(2, 8);
+    for (int i = 0; i < 100; ++i) {
+        h.push(0, i);
+    }
+    int x;
+    ASSERT_EQ(h.try_pop(1, x), true);
+    ASSERT_EQ(h.steals(), 1);
+    // the batch is every other one of the smallest elements
+    ASSERT_EQ(x, 0);
+    ASSERT_EQ(h.try_pop(1, x), true);
+    ASSERT_EQ(x, 2);
+    ASSERT_EQ(h.try_pop(0, x), true);
+    ASSERT_EQ(x, 1);
+}
+
+
+TEST(ParallelEveryKeyOnce, WorkStealingQueuesCorrectnessTests) {
+    // only worker 0 produces, the others live on stolen work
+    int threads = 4, q = 200000;
+    WorkStealingQueues<int> h(threads, 16);
+    std::vector<std::atomic<int> > seen(q);
+    for (int i = 0; i < q; ++i) {
+        seen[i] = 0;
+    }
+    std::atomic<int> popped(0);
+    std::atomic<bool> produced(false);
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.push_back(std::thread([&, t]() {
+            int key;
+            if (t == 0) {
+                for (int i = 0; i < q; ++i) {
+                    h.push(0, i);
+                    if (i % 3 == 0 && h.try_pop(0, key)) {
+                        ++seen[key];
+                        ++popped;
+                    }
+                }
+                produced = true;
+            }
+            while (!produced.load() || popped.load() < q) {
+                if (h.try_pop(t, key)) {
+                    ++seen[key];
+                    ++popped;
+                }
+                else if (produced.load() && t != 0) {
+                    // the rest may be only in the local engine of worker 0
+                    break;
+                }
+            }
+        }));
+    }
+    for (int t = 0; t < threads; ++t) {
+        workers[t].join();
+    }
+    for (int i = 0; i < q; ++i) {
+        ASSERT_EQ(seen[i].load(), 1);
+    }
+}
+
+
+// grid graph with random weights for the best-first search
+class Grid {
+public:
+    Grid(int side_, int seed) : side(side_), weights(side_ * side_ * 4) {
+        srand(seed);
+        for (int i = 0; i < side * side * 4; ++i) {
+            weights[i] = 1 + rand() % 100;
+        }
+    }
+
+    int size() const {
+        return side * side;
+    }
+
+    // returns number of neighbours written to to[] and w[]
+    int neighbours(int v, int *to, int *w) const {
+        int x = v % side, y = v / side, cnt = 0;
+        int dx[4] = {1, -1, 0, 0}, dy[4] = {0, 0, 1, -1};
+        for (int d = 0; d < 4; ++d) {
+            int nx = x + dx[d], ny = y + dy[d];
+            if (0 <= nx && nx < side && 0 <= ny && ny < side) {
+                to[cnt] = ny * side + nx;
+                w[cnt] = weights[v * 4 + d];
+                ++cnt;
+            }
+        }
+        return cnt;
+    }
+
+private:
+    int side;
+    Vector<int> weights;
+};
+
+
+// shortest paths from vertex 0 with label-correcting best-first search,
+// queue elements are distance << 32 | vertex
+template <class PopFunction, class PushFunction>
+void searchWorker(const Grid &g, std::vector<std::atomic<long long> > &dist, std::atomic<long long> &pending,
+                  PopFunction pop, PushFunction push) {
+    long long item;
+    int to[4], w[4];
+    while (pending.load() > 0) {
+        if (!pop(item)) {
+            continue;
+        }
+        long long d = item >> 32;
+        int v = (int)(item & 0xffffffffLL);
+        if (d <= dist[v].load()) {
+            int cnt = g.neighbours(v, to, w);
+            for (int i = 0; i < cnt; ++i) {
+                long long nd = d + w[i], old = dist[to[i]].load();
+                while (nd < old && !dist[to[i]].compare_exchange_weak(old, nd)) {}
+                if (nd < old) {
+                    ++pending;
+                    push((nd << 32) | to[i]);
+                }
+            }
+        }
+        --pending;
+    }
+}
+
+
+template <class Engine>
+int stealingSearch(const Grid &g, int threads, std::vector<std::atomic<long long> > &dist) {
+    WorkStealingQueues<long long, Engine> h(threads);
+    std::atomic<long long> pending(1);
+    for (int v = 0; v < g.size(); ++v) {
+        dist[v] = (1LL << 60);
+    }
+    dist[0] = 0;
+    h.push(0, 0);
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.push_back(std::thread([&, t]() {
+            searchWorker(g, dist, pending,
+                         [&h, t](long long &item) { return h.try_pop(t, item); },
+                         [&h, t](long long item) { h.push(t, item); });
+        }));
+    }
+    for (int t = 0; t < threads; ++t) {
+        workers[t].join();
+    }
+    return (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t0).count();
+}
+
+
+int lockedSearch(const Grid &g, int threads, std::vector<std::atomic<long long> > &dist) {
+    LockedHeap<long long, FibonacciHeap<long long> > h;
+    std::atomic<long long> pending(1);
+    for (int v = 0; v < g.size(); ++v) {
+        dist[v] = (1LL << 60);
+    }
+    dist[0] = 0;
+    h.insert(0);
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.push_back(std::thread([&]() {
+            searchWorker(g, dist, pending,
+                         [&h](long long &item) { return h.try_extract_min(item); },
+                         [&h](long long item) { h.insert(item); });
+        }));
+    }
+    for (int t = 0; t < threads; ++t) {
+        workers[t].join();
+    }
+    return (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t0).count();
+}
+
+
+TEST(ParallelSearchDistances, WorkStealingQueuesCorrectnessTests) {
+    Grid g(60, 7);
+    std::vector<std::atomic<long long> > expected(g.size()), dist(g.size());
+    lockedSearch(g, 1, expected);
+    stealingSearch<FibonacciHeap<long long> >(g, 4, dist);
+    for (int v = 0; v < g.size(); ++v) {
+        ASSERT_EQ(dist[v].load(), expected[v].load());
+    }
+    stealingSearch<BinomialHeap<long long> >(g, 3, dist);
+    for (int v = 0; v < g.size(); ++v) {
+        ASSERT_EQ(dist[v].load(), expected[v].load());
+    }
+}
+
+
+TEST(ParallelBestFirstSearch, DISABLED_WorkStealingQueuesTimeTests) {
+    Grid g(1000, 7);
+    std::vector<std::atomic<long long> > dist(g.size());
+    int cores = std::max((int)std::thread::hardware_concurrency(), 1);
+    for (int step = 1; ; step *= 2) {
+        int threads = std::min(step, cores);
+        std::string name = std::to_string(threads) + " threads, best-first search on 1000x1000 grid";
+        reportTime(("WorkStealingQueues<FibonacciHeap> " + name).c_str(),
+                   stealingSearch<FibonacciHeap<long long> >(g, threads, dist));
+        reportTime(("WorkStealingQueues<Heap> " + name).c_str(), stealingSearch<Heap<long long> >(g, threads, dist));
+        reportTime(("FibonacciHeap behind a mutex " + name).c_str(), lockedSearch(g, threads, dist));
+        if (threads == cores) {
+            break;
+        }
+    }
+}
@@ -0,0 +1,22 @@
+#ifndef HEAP_THREADRANDOM_H
+#define HEAP_THREADRANDOM_H
+
+
+#include <cstdint>
+
+
+// xorshift with one generator per thread, for the random choices of the concurrent queues:
+// rand() is not thread-safe. The state is seeded from its own address, so threads differ.
+inline uint64_t thread_random() {
+    static thread_local uint64_t state = 0;
+    if (state == 0) {
+        state = (uint64_t)(uintptr_t)&state * 0x9E3779B97F4A7C15ull | 1;
+    }
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+
+#endif //HEAP_THREADRANDOM_H
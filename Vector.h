@@ -1,6 +1,7 @@
 #ifndef HEAP_VECTOR_H
 #define HEAP_VECTOR_H
 
+#include "MemoryUsage.h"
 #include <cstdlib>
 #include <stdexcept>
 
@@ -12,6 +13,8 @@ public:
     ~Vector();
 
     size_t size() const;
+    // elements which fit without reallocation
+    size_t capacity() const;
     bool is_empty() const;
     Key &operator[](size_t i) const;
 
@@ -19,9 +22,11 @@ public:
     void pop_back();
     void reverse();
     void clear();
+    MemoryUsage memory_usage() const;
 private:
     Key *ptr;
     size_t len;
+    size_t cap;
 
 };
 
@@ -54,13 +59,15 @@ bool Vector<Key>::is_empty() const {
 template<class Key>
 Vector<Key>::Vector(size_t len) {
     this->len = len;
-    ptr = new Key[max(len, (size_t)1)];
+    cap = max(len, (size_t)1);
+    ptr = new Key[cap];
 }
 
 template<class Key>
 Vector<Key>::Vector(size_t len, Key key) {
     this->len = len;
-    ptr = new Key[max(len, (size_t)1)];
+    cap = max(len, (size_t)1);
+    ptr = new Key[cap];
     for (size_t i = 0; i < len; ++i) {
         ptr[i] = key;
     }
@@ -76,6 +83,11 @@ size_t Vector<Key>::size() const {
     return len;
 }
 
+template <class Key>
+size_t Vector<Key>::capacity() const {
+    return cap;
+}
+
 template<class Key>
 Key &Vector<Key>::operator[](size_t index) const {
     if (!(0 <= index && index < len)) {
@@ -87,8 +99,9 @@ Key &Vector<Key>::operator[](size_t index) const {
 
 template<class Key>
 void Vector<Key>::push_back(Key elem) {
-    if (__builtin_popcount(len) == 1) {
-        Key *ptr2 = new Key[len * 2];
+    if (len == cap) {
+        cap *= 2;
+        Key *ptr2 = new Key[cap];
         for (size_t i = 0; i < len; ++i) {
             ptr2[i] = ptr[i];
         }
@@ -122,4 +135,10 @@ void Vector<Key>::clear() {
 }
 
 
+template <class Key>
+MemoryUsage Vector<Key>::memory_usage() const {
+    return MemoryUsage(cap * sizeof(Key), (cap - len) * sizeof(Key), len);
+}
+
+
 #endif //HEAP_VECTOR_H
@@ -0,0 +1,310 @@
+#ifndef HEAP_WEAKHEAP_H
+#define HEAP_WEAKHEAP_H
+
+
+#include "Vector.h"
+#include "NodeStorage.h"
+#include <cstdlib>
+#include <stdexcept>
+
+
+// Weak heap (Dutton, Edelkamp): every node is not greater than the nodes of
+// its right subtree, left subtrees are unordered. Children of node i are
+// 2i + reverse[i] (left) and 2i + 1 - reverse[i] (right), root has only the right child 1.
+// Needs about log n comparisons per extract_min and n - 1 for building from a range,
+// comparisons() counts all key comparisons made by the instance.
+template <class Key, class Storage = NewDeleteStorage>
+class WeakHeap {
+private:
+    class Node;
+    typedef typename Storage::template Pool<Node> NodePool;
+
+public:
+    // with SlotMapStorage it stays checkable when its element is removed: using it then throws invalid_argument
+    class Pointer {
+        friend WeakHeap<Key, Storage>;
+    private:
+        typename NodePool::Handle handle;
+        explicit Pointer(Node *ptr_);
+        Node *node() const;
+    public:
+        Pointer();
+        Key getKey();
+    };
+
+    WeakHeap();
+
+    template <class Iterator>
+    WeakHeap(Iterator begin, Iterator end);
+
+    ~WeakHeap();
+    WeakHeap(const WeakHeap&) = delete;
+    WeakHeap &operator=(const WeakHeap&) = delete;
+
+    bool is_empty() const;
+    Pointer insert(Key);
+    void erase(Pointer);
+    Key extract_min();
+    void change(Pointer, Key);
+    Key get_min() const;
+    size_t comparisons() const;
+    // the arrays of node pointers and reverse bits with their spare capacity, and the nodes
+    MemoryUsage memory_usage() const;
+
+private:
+    class Node {
+        friend WeakHeap<Key, Storage>;
+        friend NodePool;
+    private:
+        Key key;
+        size_t index;
+        Node(Key key_, size_t index_ = 0);
+    };
+
+    Vector<Node*> nodes;
+    Vector<bool> reverse;
+    size_t comparisons_count;
+
+    void swap_nodes(size_t i, size_t j);
+    size_t d_ancestor(size_t j) const;
+    bool join(size_t i, size_t j);
+    void push_node(Node*);
+    void siftUp(size_t index);
+    void siftDown();
+    Node *detach(size_t index);
+};
+
+
+
+template <class Key, class Storage>
+WeakHeap<Key, Storage>::Pointer::Pointer() {}
+
+
+template <class Key, class Storage>
+WeakHeap<Key, Storage>::Pointer::Pointer(Node *ptr_) : handle(NodePool::handle(ptr_)) {}
+
+
+template <class Key, class Storage>
+typename WeakHeap<Key, Storage>::Node *WeakHeap<Key, Storage>::Pointer::node() const {
+    Node *ptr = NodePool::get(handle);
+    if (ptr == nullptr) {
+        throw std::invalid_argument("Pointer to a removed element");
+    }
+    return ptr;
+}
+
+
+template <class Key, class Storage>
+Key WeakHeap<Key, Storage>::Pointer::getKey() {
+    return node()->key;
+}
+
+
+template <class Key, class Storage>
+WeakHeap<Key, Storage>::WeakHeap() {
+    comparisons_count = 0;
+}
+
+
+template <class Key, class Storage>
+template <class Iterator>
+WeakHeap<Key, Storage>::WeakHeap(Iterator begin, Iterator end) {
+    comparisons_count = 0;
+    while (begin != end) {
+        nodes.push_back(NodePool::create(*begin, nodes.size()));
+        reverse.push_back(false);
+        ++begin;
+    }
+    // bottom-up construction, one join per non-root node
+    for (size_t j = nodes.size(); j-- > 1; ) {
+        join(d_ancestor(j), j);
+    }
+}
+
+
+template <class Key, class Storage>
+WeakHeap<Key, Storage>::~WeakHeap() {
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        NodePool::destroy(nodes[i]);
+    }
+}
+
+
+template <class Key, class Storage>
+bool WeakHeap<Key, Storage>::is_empty() const {
+    return nodes.is_empty();
+}
+
+
+template <class Key, class Storage>
+typename WeakHeap<Key, Storage>::Pointer WeakHeap<Key, Storage>::insert(Key key) {
+    Node *nw = NodePool::create(key);
+    push_node(nw);
+    return Pointer(nw);
+}
+
+
+template <class Key, class Storage>
+void WeakHeap<Key, Storage>::erase(Pointer ptr) {
+    NodePool::destroy(detach(ptr.node()->index));
+}
+
+
+template <class Key, class Storage>
+Key WeakHeap<Key, Storage>::extract_min() {
+    if (is_empty()) {
+        throw std::logic_error("WeakHeap instance is empty");
+    }
+    Node *node = detach(0);
+    Key ret = node->key;
+    NodePool::destroy(node);
+    return ret;
+}
+
+
+template <class Key, class Storage>
+void WeakHeap<Key, Storage>::change(Pointer ptr, Key key) {
+    Node *node = ptr.node();
+    if (key < node->key) {
+        node->key = key;
+        siftUp(node->index);
+    }
+    else {
+        detach(node->index);
+        node->key = key;
+        push_node(node);
+    }
+}
+
+
+template <class Key, class Storage>
+Key WeakHeap<Key, Storage>::get_min() const {
+    if (is_empty()) {
+        throw std::logic_error("WeakHeap instance is empty");
+    }
+    return nodes[0]->key;
+}
+
+
+template <class Key, class Storage>
+size_t WeakHeap<Key, Storage>::comparisons() const {
+    return comparisons_count;
+}
+
+
+template <class Key, class Storage>
+MemoryUsage WeakHeap<Key, Storage>::memory_usage() const {
+    MemoryUsage usage = nodes.memory_usage();
+    usage.add_bytes(reverse.memory_usage());
+    usage.live_bytes += nodes.size() * NodePool::slot_bytes();
+    usage.table_bytes = NodePool::table_bytes();
+    return usage;
+}
+
+
+
+template <class Key, class Storage>
+WeakHeap<Key, Storage>::Node::Node(Key key_, size_t index_) {
+    key = key_;
+    index = index_;
+}
+
+
+template <class Key, class Storage>
+void WeakHeap<Key, Storage>::swap_nodes(size_t i, size_t j) {
+    nodes[i]->index = j;
+    nodes[j]->index = i;
+    swap(nodes[i], nodes[j]);
+}
+
+
+template <class Key, class Storage>
+size_t WeakHeap<Key, Storage>::d_ancestor(size_t j) const {
+    // distinguished ancestor is the parent of the first right child on the way up
+    while ((j & 1) == (size_t)reverse[j >> 1]) {
+        j >>= 1;
+    }
+    return j >> 1;
+}
+
+
+template <class Key, class Storage>
+bool WeakHeap<Key, Storage>::join(size_t i, size_t j) {
+    // i is the distinguished ancestor of j,
+    // returns true if they were already in order
+    ++comparisons_count;
+    if (nodes[j]->key < nodes[i]->key) {
+        swap_nodes(i, j);
+        reverse[j] = !reverse[j];
+        return false;
+    }
+    return true;
+}
+
+
+template <class Key, class Storage>
+void WeakHeap<Key, Storage>::push_node(Node *node) {
+    size_t n = nodes.size();
+    node->index = n;
+    nodes.push_back(node);
+    reverse.push_back(false);
+    if (n > 0 && (n & 1) == 0) {
+        // new node is the first child of its parent, make it the left one
+        reverse[n >> 1] = false;
+    }
+    siftUp(n);
+}
+
+
+template <class Key, class Storage>
+void WeakHeap<Key, Storage>::siftUp(size_t index) {
+    while (index != 0) {
+        size_t ancestor = d_ancestor(index);
+        if (join(ancestor, index)) {
+            break;
+        }
+        index = ancestor;
+    }
+}
+
+
+template <class Key, class Storage>
+void WeakHeap<Key, Storage>::siftDown() {
+    // go down the left spine of the right subtree of the root,
+    // then join the root with every node on the way back
+    size_t n = nodes.size();
+    if (n <= 1) {
+        return;
+    }
+    size_t index = 1;
+    while (2 * index + reverse[index] < n) {
+        index = 2 * index + reverse[index];
+    }
+    while (index != 0) {
+        join(0, index);
+        index >>= 1;
+    }
+}
+
+
+template <class Key, class Storage>
+typename WeakHeap<Key, Storage>::Node *WeakHeap<Key, Storage>::detach(size_t index) {
+    // moves the node to the root as if its key was minus infinity,
+    // then replaces the root with the last node
+    while (index != 0) {
+        size_t ancestor = d_ancestor(index);
+        swap_nodes(ancestor, index);
+        reverse[index] = !reverse[index];
+        index = ancestor;
+    }
+
+    Node *node = nodes[0];
+    swap_nodes(0, nodes.size() - 1);
+    nodes.pop_back();
+    reverse.pop_back();
+    siftDown();
+    return node;
+}
+
+
+#endif //HEAP_WEAKHEAP_H
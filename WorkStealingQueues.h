@@ -0,0 +1,168 @@
+#ifndef HEAP_WORKSTEALINGQUEUES_H
+#define HEAP_WORKSTEALINGQUEUES_H
+
+
+#include "Vector.h"
+#include "FibonacciHeap.h"
+#include "ThreadRandom.h"
+#include <cstdlib>
+#include <atomic>
+#include <mutex>
+
+
+// One priority queue per worker thread. Worker w calls push(w, ...) and try_pop(w, ...)
+// only from its own thread: they work with its local engine without any locks.
+// Besides the local engine every worker has a shared one behind a mutex: when it is empty
+// and the local engine has enough elements, the owner publishes a batch of its best
+// elements there (every other one of the 2 * batch smallest, so the owner keeps good work too).
+// A worker with nothing to do takes the whole shared engine of a victim with one
+// Engine::merge, which is O(1) for the default FibonacciHeap.
+template <class Key, class Engine = FibonacciHeap<Key> >
+class WorkStealingQueues {
+public:
+    explicit WorkStealingQueues(size_t workers, size_t batch = 32);
+
+    size_t workers_count() const;
+    void push(size_t worker, Key);
+    // local elements first, then own published ones, then stolen;
+    // returns false if nothing was found
+    bool try_pop(size_t worker, Key &result);
+    // number of successful steals by all workers
+    size_t steals() const;
+
+private:
+    class Worker {
+        friend WorkStealingQueues<Key, Engine>;
+    private:
+        // owner only
+        Engine local;
+        size_t local_size;
+
+        std::mutex lock;
+        Engine shared;
+        std::atomic<size_t> shared_size;
+
+        // keeps shared parts of neighbour workers in different cache lines
+        char padding[64];
+    public:
+        // Vector creates workers
+        Worker();
+    };
+
+    Vector<Worker> workers;
+    size_t batch;
+    std::atomic<size_t> steals_count;
+
+    void publish(Worker&);
+    bool take_shared(Worker &thief, Worker &victim);
+    size_t random_worker();
+};
+
+
+
+template <class Key, class Engine>
+WorkStealingQueues<Key, Engine>::WorkStealingQueues(size_t workers_, size_t batch_)
+        : workers(workers_), steals_count(0) {
+    batch = batch_;
+}
+
+
+template <class Key, class Engine>
+size_t WorkStealingQueues<Key, Engine>::workers_count() const {
+    return workers.size();
+}
+
+
+template <class Key, class Engine>
+void WorkStealingQueues<Key, Engine>::push(size_t worker, Key key) {
+    Worker &owner = workers[worker];
+    owner.local.insert(key);
+    ++owner.local_size;
+    if (owner.local_size >= 4 * batch && owner.shared_size.load(std::memory_order_relaxed) == 0) {
+        publish(owner);
+    }
+}
+
+
+template <class Key, class Engine>
+bool WorkStealingQueues<Key, Engine>::try_pop(size_t worker, Key &result) {
+    Worker &owner = workers[worker];
+    if (owner.local_size == 0 && !take_shared(owner, owner)) {
+        // one round over all other workers from a random one
+        size_t start = random_worker();
+        for (size_t attempt = 0; attempt < workers.size(); ++attempt) {
+            size_t victim = (start + attempt) % workers.size();
+            if (victim != worker && take_shared(owner, workers[victim])) {
+                ++steals_count;
+                break;
+            }
+        }
+    }
+    if (owner.local_size == 0) {
+        return false;
+    }
+    result = owner.local.extract_min();
+    --owner.local_size;
+    return true;
+}
+
+
+template <class Key, class Engine>
+size_t WorkStealingQueues<Key, Engine>::steals() const {
+    return steals_count.load();
+}
+
+
+
+template <class Key, class Engine>
+WorkStealingQueues<Key, Engine>::Worker::Worker() : local_size(0), shared_size(0) {}
+
+
+template <class Key, class Engine>
+void WorkStealingQueues<Key, Engine>::publish(Worker &owner) {
+    Engine published;
+    Vector<Key> kept;
+    for (size_t i = 0; i < 2 * batch; ++i) {
+        Key key = owner.local.extract_min();
+        if (i % 2 == 0) {
+            published.insert(key);
+        }
+        else {
+            kept.push_back(key);
+        }
+    }
+    for (size_t i = 0; i < kept.size(); ++i) {
+        owner.local.insert(kept[i]);
+    }
+    owner.local_size -= batch;
+
+    std::lock_guard<std::mutex> guard(owner.lock);
+    owner.shared.merge(published);
+    owner.shared_size.store(owner.shared_size.load(std::memory_order_relaxed) + batch);
+}
+
+
+template <class Key, class Engine>
+bool WorkStealingQueues<Key, Engine>::take_shared(Worker &thief, Worker &victim) {
+    if (victim.shared_size.load() == 0) {
+        return false;
+    }
+    std::lock_guard<std::mutex> guard(victim.lock);
+    size_t taken = victim.shared_size.load(std::memory_order_relaxed);
+    if (taken == 0) {
+        return false;
+    }
+    thief.local.merge(victim.shared);
+    thief.local_size += taken;
+    victim.shared_size.store(0);
+    return true;
+}
+
+
+template <class Key, class Engine>
+size_t WorkStealingQueues<Key, Engine>::random_worker() {
+    return (size_t)(thread_random() % workers.size());
+}
+
+
+#endif //HEAP_WORKSTEALINGQUEUES_H